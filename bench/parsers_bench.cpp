@@ -0,0 +1,192 @@
+// Benchmarks of the text parsers on the startup path, run against the inputs
+// of a BeagleBone Black in bench/data and against large synthetic inputs:
+//
+//   cmake -DBEAGLE_CONFIG_BENCH=ON .. && make bb-config-bench
+//   ./bb-config-bench --benchmark_filter=uenv
+//
+// Besides the time per iteration, each benchmark reports:
+//   lines      The number of lines of the input.
+//   time/line  The time to parse a line, in seconds with an SI prefix.
+//   allocs     The heap allocations per iteration.
+
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include "connman/connman.hpp"
+#include "hw/gpio.hpp"
+#include "hw/pinmux.hpp"
+#include "uenv/uenv.hpp"
+
+namespace {
+std::atomic<size_t> allocations{0};
+}  // namespace
+
+// Count every allocation of the process. The benchmarks report the difference
+// over their iterations. The operators are not inlined, for GCC would then
+// warn about free() on memory from new.
+__attribute__((noinline)) void* operator new(std::size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* memory = std::malloc(size ? size : 1))
+    return memory;
+  throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void* memory) noexcept {
+  std::free(memory);
+}
+
+__attribute__((noinline)) void operator delete(void* memory,
+                                                std::size_t) noexcept {
+  std::free(memory);
+}
+
+namespace {
+
+std::string ReadFile(const std::string& path) {
+  std::ifstream file(std::string(BEAGLE_CONFIG_SOURCE_DIR) + "/" + path);
+  if (!file) {
+    std::cerr << "bb-config-bench: can't read " << path << "\n";
+    std::exit(1);
+  }
+  std::stringstream content;
+  content << file.rdbuf();
+  return content.str();
+}
+
+// Run |parse| over |input| as the benchmark |name|.
+template <typename Parse>
+void Register(const std::string& name, std::string input, Parse parse) {
+  benchmark::RegisterBenchmark(
+      name.c_str(), [input, parse](benchmark::State& state) {
+        double lines = std::count(input.begin(), input.end(), '\n');
+        size_t before = allocations.load(std::memory_order_relaxed);
+        for (auto _ : state)
+          benchmark::DoNotOptimize(parse(input));
+        size_t count = allocations.load(std::memory_order_relaxed) - before;
+
+        state.SetBytesProcessed(state.iterations() * input.size());
+        state.counters["lines"] = lines;
+        state.counters["time/line"] = benchmark::Counter(
+            lines, benchmark::Counter::kIsIterationInvariantRate |
+                       benchmark::Counter::kInvert);
+        state.counters["allocs"] =
+            benchmark::Counter(count, benchmark::Counter::kAvgIterations);
+      });
+}
+
+// |chips| chips of 32 lines, every other one on a header.
+std::string SyntheticGpioinfo(int chips) {
+  std::string output;
+  for (int chip = 0; chip < chips; ++chip) {
+    output += "gpiochip" + std::to_string(chip) + " - 32 lines:\n";
+    for (int line = 0; line < 32; ++line) {
+      std::string name = "\"NC\"";
+      if (line % 2) {
+        name = "\"P" + std::to_string(8 + chip % 2) + "_" +
+               std::to_string(line + 10) + " [gpio" + std::to_string(chip) +
+               "_" + std::to_string(line) + "]\"";
+      }
+      output += "\tline " + std::to_string(line) + ": " + name +
+                " unused input active-high\n";
+    }
+  }
+  return output;
+}
+
+std::string Repeat(const std::string& input, int copies) {
+  std::string output;
+  output.reserve(input.size() * copies);
+  for (int i = 0; i < copies; ++i)
+    output += input;
+  return output;
+}
+
+// An overlay block of |sections| sections of 8 options.
+std::string SyntheticUEnv(int sections) {
+  std::string output = "uname_r=5.10.168-ti-r71\n\n###U-Boot Overlays###\n";
+  for (int section = 0; section < sections; ++section) {
+    output += "###Section " + std::to_string(section) + "\n";
+    for (int option = 0; option < 8; ++option) {
+      output += (option % 2 ? "#" : "") + std::string("uboot_option_") +
+                std::to_string(section) + "_" + std::to_string(option) +
+                "=1\n";
+    }
+    output += "###\n";
+  }
+  return output + "###U-Boot Overlays###\n";
+}
+
+// |services| wifi networks around a wired connection.
+std::string SyntheticServices(int services) {
+  std::string output = "*AO Wired ethernet_c8a030a4b5f2_cable\n";
+  for (int service = 0; service < services; ++service) {
+    output += service == services / 2 ? "*AR " : "    ";
+    output += "Network " + std::to_string(service) +
+              "            wifi_c8a030a4b5f2_4e6574776f726b" +
+              std::to_string(service) + "_managed_psk\n";
+  }
+  return output;
+}
+
+const std::map<int, int> ChipToBase = {{0, 0}, {1, 32}, {2, 64}, {3, 96}};
+
+auto ParseGpioinfo = [](const std::string& input) {
+  return hw::gpio::ParseGpioinfo(input, ChipToBase);
+};
+
+auto ParsePinInfo = [](const std::string& input) {
+  std::istringstream in(input);
+  return hw::pinmux::ParsePinInfo(in, "P8");
+};
+
+auto ParseUEnv = [](const std::string& input) {
+  std::istringstream in(input);
+  return uenv::Parse(in);
+};
+
+auto ParseServices = [](const std::string& input) {
+  std::unordered_map<std::string, std::string> services;
+  std::string active;
+  connman::ParseServices(input, "wifi_c8a030a4b5f2", &services, &active);
+  return services;
+};
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    return 1;
+
+  Register("gpioinfo/recorded", ReadFile("bench/data/gpioinfo.txt"),
+           ParseGpioinfo);
+  Register("gpioinfo/synthetic/64", SyntheticGpioinfo(64), ParseGpioinfo);
+  Register("gpioinfo/synthetic/1024", SyntheticGpioinfo(1024), ParseGpioinfo);
+
+  std::string pin_info = ReadFile("src/ui/panel/pinmux/pin_info");
+  Register("pin_info/recorded", pin_info, ParsePinInfo);
+  Register("pin_info/synthetic/16", Repeat(pin_info, 16), ParsePinInfo);
+  Register("pin_info/synthetic/256", Repeat(pin_info, 256), ParsePinInfo);
+
+  Register("uenv/recorded", ReadFile("bench/data/uEnv.txt"), ParseUEnv);
+  Register("uenv/synthetic/64", SyntheticUEnv(64), ParseUEnv);
+  Register("uenv/synthetic/1024", SyntheticUEnv(1024), ParseUEnv);
+
+  Register("connmanctl/recorded",
+           ReadFile("bench/data/connmanctl_services.txt"), ParseServices);
+  Register("connmanctl/synthetic/256", SyntheticServices(256), ParseServices);
+  Register("connmanctl/synthetic/4096", SyntheticServices(4096),
+           ParseServices);
+
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
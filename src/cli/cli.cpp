@@ -0,0 +1,346 @@
+#include "cli/cli.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "hw/gpio.hpp"
+#include "hw/gpio_bench.hpp"
+#include "hw/led.hpp"
+#include "hw/pinmux.hpp"
+#include "hw/pwm.hpp"
+#include "profile/apply.hpp"
+
+namespace cli {
+
+namespace {
+
+using Args = std::vector<std::string>;
+
+int Fail(const std::string& message) {
+  std::cerr << "bb-config: " << message << "\n";
+  return 1;
+}
+
+int Usage() {
+  PrintUsage(std::cerr);
+  return 1;
+}
+
+// Parse the "--name=value" or "--name value" option at |*i| following the
+// positional arguments, advancing |*i| past the value of the second form.
+bool ParseOption(const Args& args,
+                 size_t* i,
+                 const char* name,
+                 std::string* value) {
+  const std::string& arg = args[*i];
+  std::string option = std::string("--") + name;
+  if (arg == option && *i + 1 < args.size()) {
+    *value = args[++*i];
+    return true;
+  }
+  std::string prefix = option + "=";
+  if (arg.compare(0, prefix.size(), prefix))
+    return false;
+  *value = arg.substr(prefix.size());
+  return true;
+}
+
+// eg. "12.3 us"
+std::string FormatLatency(int64_t ns) {
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "%.1f us", ns / 1e3);
+  return buffer;
+}
+
+int GpioBench(const Args& args) {
+  if (args.size() < 3)
+    return Usage();
+
+  int output = 0, input = 0;
+  if (!hw::gpio::Resolve(args[1], &output))
+    return Fail("unknown GPIO " + args[1]);
+  if (!hw::gpio::Resolve(args[2], &input))
+    return Fail("unknown GPIO " + args[2]);
+
+  std::string method_arg = "all", iterations_arg = "10000", json_path;
+  for (size_t i = 3; i < args.size(); ++i) {
+    if (!ParseOption(args, &i, "method", &method_arg) &&
+        !ParseOption(args, &i, "iterations", &iterations_arg) &&
+        !ParseOption(args, &i, "json", &json_path)) {
+      return Fail("unknown option " + args[i]);
+    }
+  }
+
+  std::vector<hw::gpio::Method> methods = {
+      hw::gpio::Method::Sysfs,
+      hw::gpio::Method::SysfsFd,
+      hw::gpio::Method::Chardev,
+      hw::gpio::Method::Mmio,
+  };
+  hw::gpio::Method only;
+  if (hw::gpio::ParseMethod(method_arg, &only))
+    methods = {only};
+  else if (method_arg != "all")
+    return Fail("--method must be sysfs, sysfs-fd, chardev, mmio or all");
+  int iterations = std::atoi(iterations_arg.c_str());
+  if (iterations <= 0)
+    return Fail("--iterations must be a positive number");
+
+  std::vector<hw::gpio::BenchResult> results;
+  char row[128];
+  snprintf(row, sizeof(row), "%-9s %10s %10s %10s %10s %10s %8s\n", "method",
+           "toggles/s", "min", "p50", "p99", "max", "timeouts");
+  std::cout << row;
+  for (auto method : methods) {
+    results.push_back(hw::gpio::Benchmark(method, output, input, iterations));
+    const auto& result = results.back();
+    if (!result.error.empty() && !result.samples) {
+      std::cout << hw::gpio::MethodName(method) << ": " << result.error
+                << "\n";
+      continue;
+    }
+    snprintf(row, sizeof(row), "%-9s %10.0f %10s %10s %10s %10s %8llu\n",
+             hw::gpio::MethodName(method), result.toggles_per_second,
+             FormatLatency(result.min_ns).c_str(),
+             FormatLatency(result.p50_ns).c_str(),
+             FormatLatency(result.p99_ns).c_str(),
+             FormatLatency(result.max_ns).c_str(),
+             static_cast<unsigned long long>(result.timeouts));
+    std::cout << row;
+  }
+
+  if (!json_path.empty()) {
+    std::ofstream file(json_path);
+    hw::gpio::WriteBenchJson(file, output, input, iterations, results);
+    if (!file)
+      return Fail("cannot write " + json_path);
+  }
+  return 0;
+}
+
+int Gpio(const Args& args) {
+  if (!args.empty() && args[0] == "bench")
+    return GpioBench(args);
+  if (args.size() < 2)
+    return Usage();
+
+  const std::string& action = args[0];
+  int number = 0;
+  if (!hw::gpio::Resolve(args[1], &number))
+    return Fail("unknown GPIO " + args[1]);
+  if (!hw::gpio::Export(number))
+    return Fail("cannot export GPIO " + std::to_string(number));
+
+  if (action == "get" && args.size() == 2) {
+    auto state = hw::gpio::Read(number);
+    std::cout << state.value << "\n";
+    return 0;
+  }
+
+  if (action == "set" && args.size() == 3) {
+    if (args[2] != "0" && args[2] != "1")
+      return Fail("value must be 0 or 1");
+    // An output with its initial value, not low until the value is written.
+    if (!hw::gpio::SetDirection(number, args[2] == "1" ? "high" : "low"))
+      return Fail("cannot set GPIO " + std::to_string(number));
+    return 0;
+  }
+
+  if (action == "direction" && args.size() == 3) {
+    if (args[2] != "in" && args[2] != "out")
+      return Fail("direction must be in or out");
+    if (!hw::gpio::SetDirection(number, args[2]))
+      return Fail("cannot set the direction of GPIO " + std::to_string(number));
+    return 0;
+  }
+
+  return Usage();
+}
+
+int Pwm(const Args& args) {
+  if (args.size() == 1 && args[0] == "list") {
+    for (const auto& name : hw::pwm::FindPWMs())
+      std::cout << name << "\n";
+    return 0;
+  }
+
+  if (args.size() < 2 || args[0] != "set")
+    return Usage();
+
+  const std::string& name = args[1];
+  std::string period_arg, duty_arg, polarity = "normal";
+  bool disable = false;
+  for (size_t i = 2; i < args.size(); ++i) {
+    if (ParseOption(args, &i, "period", &period_arg) ||
+        ParseOption(args, &i, "duty", &duty_arg) ||
+        ParseOption(args, &i, "polarity", &polarity)) {
+      continue;
+    }
+    if (args[i] == "--disable") {
+      disable = true;
+      continue;
+    }
+    return Fail("unknown option " + args[i]);
+  }
+
+  if (disable) {
+    if (!hw::pwm::Enable(name, false))
+      return Fail("cannot disable " + name);
+    return 0;
+  }
+
+  long long period = 0;
+  if (!hw::pwm::ParseTime(period_arg, &period))
+    return Fail("--period must be a duration, eg. 1ms");
+
+  long long duty = 0;
+  if (!hw::pwm::ParseDuty(duty_arg, period, &duty))
+    return Fail("--duty must be a duration or a percentage, eg. 25%");
+  if (duty > period)
+    return Fail("--duty must not exceed --period");
+  if (polarity != "normal" && polarity != "inversed")
+    return Fail("--polarity must be normal or inversed");
+
+  if (!hw::pwm::Configure(name, period, duty, polarity) ||
+      !hw::pwm::Enable(name, true)) {
+    return Fail("cannot configure " + name);
+  }
+  return 0;
+}
+
+int Pinmux(const Args& args) {
+  if (args.size() < 2)
+    return Usage();
+
+  hw::pinmux::PinDetail pin;
+  auto headers = hw::pinmux::LoadPins(hw::pinmux::BoardModel());
+  if (!hw::pinmux::FindPin(headers, args[1], &pin))
+    return Fail("unknown pin " + args[1]);
+
+  if (args[0] == "get" && args.size() == 2) {
+    std::string state;
+    if (!hw::pinmux::GetState(pin.header, &state))
+      return Fail("cannot read " + hw::pinmux::StatePath(pin.header));
+    std::cout << state << "\n";
+    return 0;
+  }
+
+  if (args[0] == "set" && args.size() == 3) {
+    if (!hw::pinmux::SetState(pin.header, args[2]))
+      return Fail("cannot set " + pin.header + " to " + args[2] +
+                  ", available: " + pin.pinmux);
+    return 0;
+  }
+
+  return Usage();
+}
+
+int Led(const Args& args) {
+  if (args.size() == 1 && args[0] == "list") {
+    for (const auto& name : hw::led::FindLEDs())
+      std::cout << name << "\n";
+    return 0;
+  }
+
+  if (args.size() != 3)
+    return Usage();
+
+  std::string led;
+  if (!hw::led::Resolve(args[1], &led))
+    return Fail("unknown LED " + args[1]);
+
+  if (args[0] == "trigger") {
+    if (!hw::led::SetTrigger(led, args[2]))
+      return Fail("cannot set the trigger of " + led + " to " + args[2]);
+    return 0;
+  }
+
+  if (args[0] == "set") {
+    if (args[2] != "0" && args[2] != "1")
+      return Fail("value must be 0 or 1");
+    if (!hw::led::SetTrigger(led, "none") ||
+        !hw::led::SetBrightness(led, args[2] == "1")) {
+      return Fail("cannot set " + led);
+    }
+    return 0;
+  }
+
+  return Usage();
+}
+
+int Apply(const Args& args) {
+  if (args.size() != 1)
+    return Usage();
+
+  std::string error;
+  profile::Value profile;
+  if (!profile::Load(args[0], &profile, &error))
+    return Fail(error);
+  if (!profile::Apply(profile, std::cout, &error))
+    return error.empty() ? 1 : Fail(error);
+  return 0;
+}
+
+struct Command {
+  const char* name;
+  int (*run)(const Args& args);
+};
+
+const Command Commands[] = {
+    {"gpio", Gpio},
+    {"pwm", Pwm},
+    {"pinmux", Pinmux},
+    {"led", Led},
+    {"apply", Apply},
+};
+
+}  // namespace
+
+bool IsCommand(const char* arg) {
+  for (const auto& command : Commands) {
+    if (!std::strcmp(arg, command.name))
+      return true;
+  }
+  return false;
+}
+
+int Run(int argc, char** argv) {
+  // The settings of a command must outlive it, which the character devices
+  // don't guarantee once their lines are released.
+  hw::gpio::PreferBackend(hw::gpio::Backend::Sysfs);
+
+  Args args(argv + 1, argv + argc);
+  for (const auto& command : Commands) {
+    if (!std::strcmp(argv[0], command.name))
+      return command.run(args);
+  }
+  return Usage();
+}
+
+void PrintUsage(std::ostream& out) {
+  out << "Commands:\n"
+      << "  gpio get <gpio>                 Print the value of a GPIO\n"
+      << "  gpio set <gpio> <0|1>           Drive a GPIO as an output\n"
+      << "  gpio direction <gpio> <in|out>  Set the direction of a GPIO\n"
+      << "  gpio bench <output> <input>     Measure the toggle rate and the\n"
+      << "          [--method=<method>]     latency from output to input\n"
+      << "          [--iterations=N] [--json=<file>]\n"
+      << "  pwm list                        List the PWM channels\n"
+      << "  pwm set <pwm> --period=<time> --duty=<time|N%>\n"
+      << "          [--polarity=normal|inversed] | --disable\n"
+      << "  pinmux get <pin>                Print the mode of a pin\n"
+      << "  pinmux set <pin> <mode>         Set the mode of a pin\n"
+      << "  led list                        List the LEDs\n"
+      << "  led set <led> <0|1>             Turn a LED on or off\n"
+      << "  led trigger <led> <trigger>     Set the trigger of a LED\n"
+      << "  apply <profile.toml|json>       Apply a board profile\n"
+      << "Options take their value after = or a space (--period 20ms).\n"
+      << "GPIOs are numbers (60) or header pins (P9_12). Times accept the\n"
+      << "s, ms, us and ns suffixes, and default to ns. The bench methods are\n"
+      << "sysfs, sysfs-fd, chardev, mmio (AM335x only) or all.\n";
+}
+
+}  // namespace cli
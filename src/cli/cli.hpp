@@ -0,0 +1,22 @@
+#ifndef BEAGLE_CONFIG_CLI_HPP
+#define BEAGLE_CONFIG_CLI_HPP
+
+#include <ostream>
+
+// Headless subcommands, for scripts and boards without a terminal, eg.
+//   bb-config gpio set P9_12 1
+//   bb-config pwm set pwm-4:0 --period=1ms --duty=25%
+namespace cli {
+
+// Whether |arg| names a subcommand rather than an option of the UI.
+bool IsCommand(const char* arg);
+
+// Run the subcommand in argv[0] with its arguments. Returns the exit status.
+int Run(int argc, char** argv);
+
+// Print the list of subcommands.
+void PrintUsage(std::ostream& out);
+
+}  // namespace cli
+
+#endif /* end of include guard: BEAGLE_CONFIG_CLI_HPP */
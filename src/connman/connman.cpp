@@ -0,0 +1,38 @@
+#include "connman/connman.hpp"
+#include "trace.hpp"
+#include "utils.hpp"
+
+namespace connman {
+
+void ParseServices(const std::string& output,
+                   const std::string& prefix,
+                   std::unordered_map<std::string, std::string>* services,
+                   std::string* active) {
+  TRACE_SCOPE("connman::ParseServices");
+  // A trailing line without a newline is incomplete, and ignored.
+  size_t begin = 0;
+  for (size_t end = output.find('\n'); end != std::string::npos;
+       begin = end + 1, end = output.find('\n', begin)) {
+    auto line = reduce(output.substr(begin, end - begin));
+
+    auto pos = line.find(prefix);
+    if (pos == std::string::npos)
+      continue;
+
+    // Hidden networks have no name.
+    if (pos == 0) {
+      (*services)["hidden - " + line.substr(0, 10)] = line;
+      continue;
+    }
+
+    auto name = reduce(line.substr(0, pos));
+    auto active_pos = name.find("*A");
+    if (active_pos != std::string::npos) {
+      name.erase(active_pos, active_pos + name.find_first_of(" ") + 1);
+      *active = name;
+    }
+    (*services)[name] = line.substr(pos);
+  }
+}
+
+}  // namespace connman
@@ -0,0 +1,26 @@
+#ifndef BEAGLE_CONFIG_CONNMAN_HPP
+#define BEAGLE_CONFIG_CONNMAN_HPP
+
+#include <string>
+#include <unordered_map>
+
+// Parsing of the connmanctl command line client output.
+namespace connman {
+
+// Parse the output of `connmanctl services`, eg.
+//
+//   *AR BeagleBone-5F2A  wifi_c8a030a4b5f2_426561676c65_managed_psk
+//       HomeNetwork      wifi_c8a030a4b5f2_486f6d654e6574_managed_psk
+//
+// into |services|, mapping the names to the service identifiers starting with
+// |prefix|, eg. wifi_c8a030a4b5f2. Hidden networks are named after their
+// identifier. The name of the service marked active, if any, is stored in
+// |active|. Lines of other services are ignored.
+void ParseServices(const std::string& output,
+                   const std::string& prefix,
+                   std::unordered_map<std::string, std::string>* services,
+                   std::string* active);
+
+}  // namespace connman
+
+#endif /* end of include guard: BEAGLE_CONFIG_CONNMAN_HPP */
@@ -0,0 +1,281 @@
+#include "dsp/fft.hpp"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include "trace.hpp"
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+namespace dsp {
+
+namespace {
+
+const double Pi = 3.14159265358979323846;
+
+// 4 floats at a time, with the vector unit the build targets: NEON on ARM,
+// SSE on x86, where it is always there.
+#if defined(__ARM_NEON)
+#define BEAGLE_CONFIG_FFT_VECTOR "neon"
+using Vector = float32x4_t;
+inline Vector Load(const float* p) {
+  return vld1q_f32(p);
+}
+inline void Store(float* p, Vector v) {
+  vst1q_f32(p, v);
+}
+inline Vector Add(Vector a, Vector b) {
+  return vaddq_f32(a, b);
+}
+inline Vector Sub(Vector a, Vector b) {
+  return vsubq_f32(a, b);
+}
+inline Vector Mul(Vector a, Vector b) {
+  return vmulq_f32(a, b);
+}
+#elif defined(__SSE__)
+#define BEAGLE_CONFIG_FFT_VECTOR "sse"
+using Vector = __m128;
+inline Vector Load(const float* p) {
+  return _mm_loadu_ps(p);
+}
+inline void Store(float* p, Vector v) {
+  _mm_storeu_ps(p, v);
+}
+inline Vector Add(Vector a, Vector b) {
+  return _mm_add_ps(a, b);
+}
+inline Vector Sub(Vector a, Vector b) {
+  return _mm_sub_ps(a, b);
+}
+inline Vector Mul(Vector a, Vector b) {
+  return _mm_mul_ps(a, b);
+}
+#endif
+
+// The bins on each side of a bin in the main lobe of a window.
+int LobeWidth(Window window) {
+  return window == Window::Hann ? 2 : 3;
+}
+
+}  // namespace
+
+Fft::Fft(size_t size) : size_(std::max<size_t>(size, 4)), half_(size_ / 2) {
+  int bits = 0;
+  while ((size_t(1) << bits) < half_)
+    bits++;
+  reverse_.resize(half_);
+  for (size_t i = 0; i < half_; ++i) {
+    uint32_t reversed = 0;
+    for (int bit = 0; bit < bits; ++bit)
+      reversed |= ((i >> bit) & 1) << (bits - 1 - bit);
+    reverse_[i] = reversed;
+  }
+
+  for (size_t span = 1; span < half_; span *= 2) {
+    for (size_t k = 0; k < span; ++k) {
+      double angle = -Pi * k / span;
+      twiddle_real_.push_back(std::cos(angle));
+      twiddle_imaginary_.push_back(std::sin(angle));
+    }
+  }
+
+  for (size_t k = 0; k <= half_; ++k) {
+    double angle = -2 * Pi * k / size_;
+    split_real_.push_back(std::cos(angle));
+    split_imaginary_.push_back(std::sin(angle));
+  }
+}
+
+void Fft::Butterflies(float* real, float* imaginary) const {
+  for (size_t span = 1; span < half_; span *= 2) {
+    const float* wr = twiddle_real_.data() + span - 1;
+    const float* wi = twiddle_imaginary_.data() + span - 1;
+    for (size_t group = 0; group < half_; group += 2 * span) {
+      float* ar = real + group;
+      float* ai = imaginary + group;
+      float* br = ar + span;
+      float* bi = ai + span;
+      size_t k = 0;
+#if defined(BEAGLE_CONFIG_FFT_VECTOR)
+      for (; k + 4 <= span; k += 4) {
+        Vector twiddle_real = Load(wr + k);
+        Vector twiddle_imaginary = Load(wi + k);
+        Vector b_real = Load(br + k);
+        Vector b_imaginary = Load(bi + k);
+        Vector t_real = Sub(Mul(b_real, twiddle_real),
+                            Mul(b_imaginary, twiddle_imaginary));
+        Vector t_imaginary = Add(Mul(b_real, twiddle_imaginary),
+                                 Mul(b_imaginary, twiddle_real));
+        Vector a_real = Load(ar + k);
+        Vector a_imaginary = Load(ai + k);
+        Store(br + k, Sub(a_real, t_real));
+        Store(bi + k, Sub(a_imaginary, t_imaginary));
+        Store(ar + k, Add(a_real, t_real));
+        Store(ai + k, Add(a_imaginary, t_imaginary));
+      }
+#endif
+      // The first stages, with spans narrower than a vector.
+      for (; k < span; ++k) {
+        float t_real = br[k] * wr[k] - bi[k] * wi[k];
+        float t_imaginary = br[k] * wi[k] + bi[k] * wr[k];
+        br[k] = ar[k] - t_real;
+        bi[k] = ai[k] - t_imaginary;
+        ar[k] += t_real;
+        ai[k] += t_imaginary;
+      }
+    }
+  }
+}
+
+void Fft::Forward(const float* samples,
+                  float* real,
+                  float* imaginary,
+                  std::vector<float>* work) const {
+  TRACE_SCOPE("Fft::Forward");
+  // The even samples as the real part, the odd ones as the imaginary part.
+  work->resize(size_);
+  float* z_real = work->data();
+  float* z_imaginary = z_real + half_;
+  for (size_t i = 0; i < half_; ++i) {
+    z_real[reverse_[i]] = samples[2 * i];
+    z_imaginary[reverse_[i]] = samples[2 * i + 1];
+  }
+  Butterflies(z_real, z_imaginary);
+
+  // X[k] = E[k] + W^k O[k], with the FFTs of the even and odd samples
+  // E[k] = (Z[k] + Z*[M - k]) / 2 and O[k] = -i (Z[k] - Z*[M - k]) / 2.
+  for (size_t k = 0; k <= half_; ++k) {
+    size_t i = k == half_ ? 0 : k;
+    size_t j = k == 0 ? 0 : half_ - k;
+    float a_real = z_real[i], a_imaginary = z_imaginary[i];
+    float b_real = z_real[j], b_imaginary = -z_imaginary[j];
+    float even_real = (a_real + b_real) / 2;
+    float even_imaginary = (a_imaginary + b_imaginary) / 2;
+    float odd_real = (a_imaginary - b_imaginary) / 2;
+    float odd_imaginary = -(a_real - b_real) / 2;
+    real[k] = even_real + split_real_[k] * odd_real -
+              split_imaginary_[k] * odd_imaginary;
+    imaginary[k] = even_imaginary + split_real_[k] * odd_imaginary +
+                   split_imaginary_[k] * odd_real;
+  }
+}
+
+std::shared_ptr<const Fft> FftPlan(size_t size) {
+  static std::mutex mutex;
+  static std::map<size_t, std::shared_ptr<const Fft>> plans;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto& plan = plans[size];
+  if (!plan)
+    plan = std::make_shared<const Fft>(size);
+  return plan;
+}
+
+const char* FftKernel() {
+#if defined(BEAGLE_CONFIG_FFT_VECTOR)
+  return BEAGLE_CONFIG_FFT_VECTOR;
+#else
+  return "scalar";
+#endif
+}
+
+Spectrum::Spectrum(size_t size, Window window)
+    : fft_(FftPlan(std::max<size_t>(size, 16))), window_(window) {
+  size_t n = fft_->size();
+  coefficients_.resize(n);
+  double gain = 0;
+  for (size_t i = 0; i < n; ++i) {
+    // Periodic, for the bins to fall on the zeros of the window.
+    double phase = 2 * Pi * i / n;
+    double coefficient = window == Window::Hann
+                             ? 0.5 - 0.5 * std::cos(phase)
+                             : 0.42 - 0.5 * std::cos(phase) +
+                                   0.08 * std::cos(2 * phase);
+    coefficients_[i] = coefficient;
+    gain += coefficient;
+  }
+  gain_ = gain;
+  windowed_.resize(n);
+  real_.resize(n / 2 + 1);
+  imaginary_.resize(n / 2 + 1);
+  amplitudes_.assign(n / 2 + 1, 0);
+}
+
+void Spectrum::Compute(const float* samples) {
+  TRACE_SCOPE("Spectrum::Compute");
+  size_t n = fft_->size();
+  double sum = 0;
+  for (size_t i = 0; i < n; ++i)
+    sum += samples[i];
+  float mean = sum / n;
+  for (size_t i = 0; i < n; ++i)
+    windowed_[i] = (samples[i] - mean) * coefficients_[i];
+
+  fft_->Forward(windowed_.data(), real_.data(), imaginary_.data(), &work_);
+
+  // The bins but DC and Nyquist hold half of the amplitude, the other half
+  // being in the negative frequencies.
+  float scale = 2 / gain_;
+  for (size_t k = 0; k < amplitudes_.size(); ++k) {
+    float bin_scale = k == 0 || k == n / 2 ? scale / 2 : scale;
+    amplitudes_[k] =
+        bin_scale *
+        std::sqrt(real_[k] * real_[k] + imaginary_[k] * imaginary_[k]);
+  }
+}
+
+double Spectrum::Peak() const {
+  size_t last = amplitudes_.size() - 1;
+  size_t peak = 1;
+  for (size_t k = 2; k < last; ++k) {
+    if (amplitudes_[k] > amplitudes_[peak])
+      peak = k;
+  }
+  float left = amplitudes_[peak - 1];
+  float center = amplitudes_[peak];
+  float right = amplitudes_[peak + 1];
+  if (left <= 0 || center <= 0 || right <= 0)
+    return peak;
+  // The top of the parabola through the logarithms of the 3 bins, close to
+  // the shape of the main lobe.
+  double a = std::log(left), b = std::log(center), c = std::log(right);
+  double denominator = a - 2 * b + c;
+  if (denominator >= 0)
+    return peak;
+  return peak + 0.5 * (a - c) / denominator;
+}
+
+double Spectrum::LobePower(double bin) const {
+  int width = LobeWidth(window_);
+  long center = std::lround(bin);
+  long first = std::max(center - width, 1l);
+  long last = std::min<long>(center + width, amplitudes_.size() - 1);
+  double power = 0;
+  for (long k = first; k <= last; ++k)
+    power += double(amplitudes_[k]) * amplitudes_[k];
+  return power;
+}
+
+double Spectrum::Thd(double peak, int harmonics) const {
+  // The lobes of the harmonics would overlap.
+  int width = LobeWidth(window_);
+  if (peak <= 2 * width)
+    return 0;
+  double fundamental = LobePower(peak);
+  if (fundamental <= 0)
+    return 0;
+  double distortion = 0;
+  for (int harmonic = 2; harmonic <= harmonics; ++harmonic) {
+    double bin = harmonic * peak;
+    if (bin + width >= amplitudes_.size() - 1)
+      break;
+    distortion += LobePower(bin);
+  }
+  return std::sqrt(distortion / fundamental);
+}
+
+}  // namespace dsp
@@ -0,0 +1,101 @@
+#ifndef BEAGLE_CONFIG_DSP_FFT_HPP
+#define BEAGLE_CONFIG_DSP_FFT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace dsp {
+
+// The FFT of real samples, of a power of two of them: a complex FFT of half
+// the size over the even and odd samples, then split into the bins of the real
+// input. The tables are computed once, and shared between the transforms of a
+// size, see FftPlan().
+class Fft {
+ public:
+  // |size| a power of two, from 4.
+  explicit Fft(size_t size);
+
+  size_t size() const { return size_; }
+
+  // The bins 0 to size() / 2 of |samples|, to |real| and |imaginary|.
+  // |work| is reused between calls.
+  void Forward(const float* samples,
+               float* real,
+               float* imaginary,
+               std::vector<float>* work) const;
+
+ private:
+  void Butterflies(float* real, float* imaginary) const;
+
+  size_t size_;
+  size_t half_;                    // The complex FFT.
+  std::vector<uint32_t> reverse_;  // The bit reversed indices of half_.
+  // The twiddles of the stages, from the butterflies of span 1: the span |h|
+  // from h - 1, contiguous for the butterflies to load them as a vector.
+  std::vector<float> twiddle_real_;
+  std::vector<float> twiddle_imaginary_;
+  // The twiddles splitting the complex FFT into the real one.
+  std::vector<float> split_real_;
+  std::vector<float> split_imaginary_;
+};
+
+// The plan of the FFTs of |size|, computed at the first call for it.
+// Thread safe.
+std::shared_ptr<const Fft> FftPlan(size_t size);
+
+// The name of the vector unit of the butterflies, eg. "neon".
+const char* FftKernel();
+
+enum class Window {
+  Hann,
+  Blackman,
+};
+
+// The amplitude spectrum of the latest samples of a signal, windowed, with
+// the readouts of its dominant frequency and distortion.
+class Spectrum {
+ public:
+  // |size| a power of two, from 16.
+  Spectrum(size_t size, Window window);
+
+  size_t size() const { return fft_->size(); }
+  Window window() const { return window_; }
+
+  // Compute the spectrum of size() samples, oldest first. Their mean is
+  // removed, for the DC not to leak over the low frequencies.
+  void Compute(const float* samples);
+
+  // The amplitude of the bins 0 to size() / 2, in the unit of the samples:
+  // a sine of amplitude A at the frequency of a bin reads A.
+  const std::vector<float>& amplitudes() const { return amplitudes_; }
+
+  // The bin of the highest amplitude, interpolated between its neighbours,
+  // eg. 8.2. The frequency is bin * rate / size().
+  double Peak() const;
+
+  // The total harmonic distortion: the RMS of the harmonics 2 to
+  // |harmonics| of the fundamental at |peak| over the fundamental, eg. 0.01,
+  // from the power over the main lobe of the window around each harmonic
+  // below the Nyquist frequency.
+  double Thd(double peak, int harmonics = 5) const;
+
+ private:
+  // The power of the bins of the main lobe around |bin|.
+  double LobePower(double bin) const;
+
+  std::shared_ptr<const Fft> fft_;
+  Window window_;
+  std::vector<float> coefficients_;  // Of the window.
+  float gain_;                       // Of the window, on a sine.
+  std::vector<float> windowed_;
+  std::vector<float> real_;
+  std::vector<float> imaginary_;
+  std::vector<float> work_;
+  std::vector<float> amplitudes_;
+};
+
+}  // namespace dsp
+
+#endif /* end of include guard: BEAGLE_CONFIG_DSP_FFT_HPP */
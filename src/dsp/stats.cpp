@@ -0,0 +1,239 @@
+#include "dsp/stats.hpp"
+#include <algorithm>
+#include <cmath>
+#include "trace.hpp"
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BEAGLE_CONFIG_X86_KERNELS
+#endif
+
+namespace dsp {
+
+namespace {
+
+Moments ReduceScalar(const int32_t* samples, size_t count) {
+  Moments moments = {samples[0], samples[0], 0, 0};
+  for (size_t i = 0; i < count; ++i) {
+    int64_t sample = samples[i];
+    moments.min = std::min<int32_t>(moments.min, sample);
+    moments.max = std::max<int32_t>(moments.max, sample);
+    moments.sum += sample;
+    moments.sum_squares += sample * sample;
+  }
+  return moments;
+}
+
+// The samples left over by a vector loop.
+void ReduceTail(const int32_t* samples, size_t count, Moments* moments) {
+  if (!count)
+    return;
+  Moments tail = ReduceScalar(samples, count);
+  moments->min = std::min(moments->min, tail.min);
+  moments->max = std::max(moments->max, tail.max);
+  moments->sum += tail.sum;
+  moments->sum_squares += tail.sum_squares;
+}
+
+#if defined(__ARM_NEON)
+
+Moments ReduceNeon(const int32_t* samples, size_t count) {
+  int32x4_t min = vdupq_n_s32(samples[0]);
+  int32x4_t max = min;
+  int64x2_t sum = vdupq_n_s64(0);
+  int64x2_t sum_squares = vdupq_n_s64(0);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    int32x4_t block = vld1q_s32(samples + i);
+    min = vminq_s32(min, block);
+    max = vmaxq_s32(max, block);
+    sum = vpadalq_s32(sum, block);
+    int32x2_t low = vget_low_s32(block);
+    int32x2_t high = vget_high_s32(block);
+    sum_squares = vmlal_s32(sum_squares, low, low);
+    sum_squares = vmlal_s32(sum_squares, high, high);
+  }
+
+  int32_t mins[4], maxs[4];
+  int64_t sums[2], squares[2];
+  vst1q_s32(mins, min);
+  vst1q_s32(maxs, max);
+  vst1q_s64(sums, sum);
+  vst1q_s64(squares, sum_squares);
+  Moments moments = {*std::min_element(mins, mins + 4),
+                     *std::max_element(maxs, maxs + 4), sums[0] + sums[1],
+                     squares[0] + squares[1]};
+  ReduceTail(samples + i, count - i, &moments);
+  return moments;
+}
+
+#elif defined(BEAGLE_CONFIG_X86_KERNELS)
+
+// The vector kernels are built for their instruction set only, and called
+// after checking that the CPU has it.
+__attribute__((target("sse4.1"))) Moments ReduceSse41(const int32_t* samples,
+                                                       size_t count) {
+  __m128i min = _mm_set1_epi32(samples[0]);
+  __m128i max = min;
+  __m128i sum = _mm_setzero_si128();
+  __m128i sum_squares = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i block =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i));
+    min = _mm_min_epi32(min, block);
+    max = _mm_max_epi32(max, block);
+    sum = _mm_add_epi64(sum, _mm_cvtepi32_epi64(block));
+    sum = _mm_add_epi64(sum, _mm_cvtepi32_epi64(_mm_srli_si128(block, 8)));
+    // The products of the even, then the odd samples.
+    sum_squares = _mm_add_epi64(sum_squares, _mm_mul_epi32(block, block));
+    __m128i odd = _mm_srli_epi64(block, 32);
+    sum_squares = _mm_add_epi64(sum_squares, _mm_mul_epi32(odd, odd));
+  }
+
+  alignas(16) int32_t mins[4], maxs[4];
+  alignas(16) int64_t sums[2], squares[2];
+  _mm_store_si128(reinterpret_cast<__m128i*>(mins), min);
+  _mm_store_si128(reinterpret_cast<__m128i*>(maxs), max);
+  _mm_store_si128(reinterpret_cast<__m128i*>(sums), sum);
+  _mm_store_si128(reinterpret_cast<__m128i*>(squares), sum_squares);
+  Moments moments = {*std::min_element(mins, mins + 4),
+                     *std::max_element(maxs, maxs + 4), sums[0] + sums[1],
+                     squares[0] + squares[1]};
+  ReduceTail(samples + i, count - i, &moments);
+  return moments;
+}
+
+__attribute__((target("avx2"))) Moments ReduceAvx2(const int32_t* samples,
+                                                    size_t count) {
+  __m256i min = _mm256_set1_epi32(samples[0]);
+  __m256i max = min;
+  __m256i sum = _mm256_setzero_si256();
+  __m256i sum_squares = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256i block =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(samples + i));
+    min = _mm256_min_epi32(min, block);
+    max = _mm256_max_epi32(max, block);
+    sum = _mm256_add_epi64(
+        sum, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(block)));
+    sum = _mm256_add_epi64(
+        sum, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(block, 1)));
+    sum_squares =
+        _mm256_add_epi64(sum_squares, _mm256_mul_epi32(block, block));
+    __m256i odd = _mm256_srli_epi64(block, 32);
+    sum_squares = _mm256_add_epi64(sum_squares, _mm256_mul_epi32(odd, odd));
+  }
+
+  alignas(32) int32_t mins[8], maxs[8];
+  alignas(32) int64_t sums[4], squares[4];
+  _mm256_store_si256(reinterpret_cast<__m256i*>(mins), min);
+  _mm256_store_si256(reinterpret_cast<__m256i*>(maxs), max);
+  _mm256_store_si256(reinterpret_cast<__m256i*>(sums), sum);
+  _mm256_store_si256(reinterpret_cast<__m256i*>(squares), sum_squares);
+  Moments moments = {*std::min_element(mins, mins + 8),
+                     *std::max_element(maxs, maxs + 8),
+                     sums[0] + sums[1] + sums[2] + sums[3],
+                     squares[0] + squares[1] + squares[2] + squares[3]};
+  ReduceTail(samples + i, count - i, &moments);
+  return moments;
+}
+
+#endif
+
+using Kernel = Moments (*)(const int32_t*, size_t);
+
+struct Implementation {
+  Kernel kernel;
+  const char* name;
+};
+
+Implementation Select() {
+#if defined(__ARM_NEON)
+  return {ReduceNeon, "neon"};
+#elif defined(BEAGLE_CONFIG_X86_KERNELS)
+  if (__builtin_cpu_supports("avx2"))
+    return {ReduceAvx2, "avx2"};
+  if (__builtin_cpu_supports("sse4.1"))
+    return {ReduceSse41, "sse4.1"};
+  return {ReduceScalar, "scalar"};
+#else
+  return {ReduceScalar, "scalar"};
+#endif
+}
+
+const Implementation& Selected() {
+  static const Implementation implementation = Select();
+  return implementation;
+}
+
+}  // namespace
+
+Moments Reduce(const int32_t* samples, size_t count) {
+  return Selected().kernel(samples, count);
+}
+
+const char* ReduceKernel() {
+  return Selected().name;
+}
+
+Stats::Stats(int32_t max_value, int bins) : max_value_(std::max(max_value, 1)) {
+  int range_bits = 0;
+  while ((1 << range_bits) <= max_value_)
+    range_bits++;
+  int bin_bits = 0;
+  while ((1 << bin_bits) < bins && bin_bits < range_bits)
+    bin_bits++;
+  shift_ = range_bits - bin_bits;
+  histogram_.resize((max_value_ >> shift_) + 1);
+}
+
+void Stats::Add(const int32_t* samples, size_t count) {
+  if (!count)
+    return;
+  TRACE_SCOPE("Stats::Add");
+  Moments moments = Reduce(samples, count);
+  if (!count_ || moments.min < min_)
+    min_ = moments.min;
+  if (!count_ || moments.max > max_)
+    max_ = moments.max;
+  count_ += count;
+  sum_ += moments.sum;
+  sum_squares_ += moments.sum_squares;
+
+  // A gather and scatter per sample does not vectorize, but the shift keeps
+  // it to a few instructions.
+  uint64_t* histogram = histogram_.data();
+  for (size_t i = 0; i < count; ++i) {
+    int32_t value = std::clamp(samples[i], 0, max_value_);
+    histogram[value >> shift_]++;
+  }
+}
+
+void Stats::Reset() {
+  count_ = 0;
+  min_ = max_ = 0;
+  sum_ = 0;
+  sum_squares_ = 0;
+  std::fill(histogram_.begin(), histogram_.end(), 0);
+}
+
+double Stats::mean() const {
+  return count_ ? double(sum_) / count_ : 0;
+}
+
+double Stats::rms() const {
+  return count_ ? std::sqrt(sum_squares_ / count_) : 0;
+}
+
+double Stats::stddev() const {
+  if (!count_)
+    return 0;
+  double mean = this->mean();
+  return std::sqrt(std::max(sum_squares_ / count_ - mean * mean, 0.0));
+}
+
+}  // namespace dsp
@@ -0,0 +1,63 @@
+#ifndef BEAGLE_CONFIG_DSP_STATS_HPP
+#define BEAGLE_CONFIG_DSP_STATS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Signal processing on blocks of samples, eg. from the ADC.
+namespace dsp {
+
+// The aggregates of a block of samples.
+struct Moments {
+  int32_t min;
+  int32_t max;
+  int64_t sum;
+  int64_t sum_squares;
+};
+
+// Reduce |count| samples, not empty, of up to 16 bits, with the widest vector
+// unit available: NEON on ARM, AVX2 or SSE4.1 on x86 once checked at run
+// time, or scalar code otherwise.
+Moments Reduce(const int32_t* samples, size_t count);
+
+// The name of the implementation of Reduce(), eg. "avx2".
+const char* ReduceKernel();
+
+// Running statistics of samples from 0 to |max_value|, updated a block at a
+// time: mean, min, max, RMS, standard deviation and a histogram.
+class Stats {
+ public:
+  // |bins| is rounded up to a power of two, and at most the values.
+  explicit Stats(int32_t max_value = 4095, int bins = 64);
+
+  void Add(const int32_t* samples, size_t count);
+  void Reset();
+
+  uint64_t count() const { return count_; }
+  int32_t min() const { return min_; }
+  int32_t max() const { return max_; }
+  double mean() const;
+  double rms() const;
+  double stddev() const;
+
+  // The samples by ranges of values, from 0. Values out of range go to the
+  // first or last bin.
+  const std::vector<uint64_t>& histogram() const { return histogram_; }
+  // The values per bin.
+  int32_t bin_width() const { return 1 << shift_; }
+
+ private:
+  int32_t max_value_;
+  int shift_ = 0;  // From a value to its bin.
+  uint64_t count_ = 0;
+  int32_t min_ = 0;
+  int32_t max_ = 0;
+  int64_t sum_ = 0;
+  double sum_squares_ = 0;
+  std::vector<uint64_t> histogram_;
+};
+
+}  // namespace dsp
+
+#endif /* end of include guard: BEAGLE_CONFIG_DSP_STATS_HPP */
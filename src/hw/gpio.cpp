@@ -0,0 +1,616 @@
+#include "hw/gpio.hpp"
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include "hw/gpio_cache.hpp"
+#include "hw/gpiochip.hpp"
+#include "hw/pinmux.hpp"
+#include "hw/root.hpp"
+#include "hw/sysfs.hpp"
+#include "log.hpp"
+#include "trace.hpp"
+
+namespace hw {
+namespace gpio {
+
+namespace {
+
+std::string GpioPath() {
+  return Rooted("/sys/class/gpio");
+}
+
+std::mutex g_backend_mutex;
+Backend g_preferred_backend = Backend::Chardev;
+bool g_backend_found = false;
+Backend g_backend = Backend::Sysfs;
+
+// The lines exported by bb-config, to unexport them.
+std::mutex g_exported_mutex;
+std::set<int> g_exported;
+
+// The attributes of a line udev gives to the gpio group, and how long it may
+// take to.
+const char* const UdevAttributes[] = {"direction", "value", "edge",
+                                      "active_low"};
+constexpr std::chrono::seconds UdevTimeout(1);
+
+// The UdevAttributes of a line read by ReadAll() with sysfs, kept open.
+struct Attributes {
+  std::array<int, 4> fds = {-1, -1, -1, -1};
+};
+std::mutex g_attributes_mutex;
+std::map<int, Attributes> g_attributes;
+
+bool IsAvailable(Backend backend) {
+  if (backend == Backend::Chardev)
+    return !gpiochip::FindChips().empty();
+  return std::filesystem::exists(GpioPath() + "/export");
+}
+
+bool IsChardev() {
+  return CurrentBackend() == Backend::Chardev;
+}
+
+// Read an attribute kept open from its start, without the trailing newline.
+bool ReadAttribute(int fd, std::string* value) {
+  char buffer[32];
+  ssize_t size = pread(fd, buffer, sizeof(buffer), 0);
+  if (size <= 0)
+    return false;
+  value->assign(buffer, size);
+  while (!value->empty() && std::isspace(value->back()))
+    value->pop_back();
+  return true;
+}
+
+void CloseFds(Attributes* attributes) {
+  for (int& fd : attributes->fds) {
+    if (fd >= 0)
+      close(fd);
+    fd = -1;
+  }
+}
+
+void CloseAttributes() {
+  std::lock_guard<std::mutex> lock(g_attributes_mutex);
+  for (auto& it : g_attributes)
+    CloseFds(&it.second);
+  g_attributes.clear();
+}
+
+// Close the attributes of |numbers|, whose directories were just created:
+// those kept open belong to a previous export.
+void CloseAttributes(const std::vector<int>& numbers) {
+  std::lock_guard<std::mutex> lock(g_attributes_mutex);
+  for (int number : numbers) {
+    auto it = g_attributes.find(number);
+    if (it == g_attributes.end())
+      continue;
+    CloseFds(&it->second);
+    g_attributes.erase(it);
+  }
+}
+
+// Execute a shell command and get its output.
+std::string exec(const char* cmd) {
+  TRACE_SCOPE("popen", trace::Enabled() ? trace::Intern(cmd) : nullptr);
+  std::array<char, 128> buffer;
+  std::string result;
+  std::unique_ptr<FILE, int (*)(FILE*)> pipe(popen(cmd, "r"), pclose);
+  if (!pipe) {
+    return "";
+  }
+  while (fgets(buffer.data(), buffer.size(), pipe.get()) != nullptr) {
+    result += buffer.data();
+  }
+  return result;
+}
+
+// Find the name of the header pin in a line of gpioinfo, eg. P9_12.
+std::string FindPinName(const std::string& line) {
+  // First check in quotes.
+  size_t quote_start = line.find('\"');
+  if (quote_start != std::string::npos) {
+    size_t quote_end = line.find('\"', quote_start + 1);
+    if (quote_end != std::string::npos) {
+      std::string quoted =
+          line.substr(quote_start + 1, quote_end - quote_start - 1);
+      if (quoted.size() >= 2 && (quoted[0] == 'P' || quoted[0] == 'p') &&
+          isdigit(quoted[1])) {
+        return quoted;
+      }
+    }
+  }
+
+  // Otherwise, search the entire line for P followed by a digit.
+  for (size_t i = 0; i + 1 < line.size(); i++) {
+    if ((line[i] != 'P' && line[i] != 'p') || !isdigit(line[i + 1]))
+      continue;
+
+    size_t end = i + 1;
+    while (end < line.size() && (isdigit(line[end]) || line[end] == '.' ||
+                                 line[end] == '_' || line[end] == '(')) {
+      end++;
+    }
+
+    std::string pin_name = line.substr(i, end - i);
+    // Clean up trailing special characters.
+    while (!pin_name.empty() &&
+           (pin_name.back() == '(' || pin_name.back() == ' ' ||
+            pin_name.back() == '\t')) {
+      pin_name.pop_back();
+    }
+    return pin_name;
+  }
+  return "";
+}
+
+// Name the lines of the chips with the header pins of pin_info. Used when
+// gpioinfo is not available, or would describe another tree than the root.
+std::vector<Pin> FindPinInfoPins() {
+  std::vector<std::pair<long long, long long>> chips;  // base, ngpio
+  if (IsChardev()) {
+    for (const auto& chip : gpiochip::FindChips())
+      chips.emplace_back(chip.base, chip.lines);
+  } else if (std::filesystem::exists(GpioPath())) {
+    for (const auto& it : std::filesystem::directory_iterator(GpioPath())) {
+      long long base = 0, ngpio = 0;
+      if (ReadInt(it.path().string() + "/base", &base) &&
+          ReadInt(it.path().string() + "/ngpio", &ngpio)) {
+        chips.emplace_back(base, ngpio);
+      }
+    }
+  }
+
+  std::vector<Pin> pins;
+  auto headers = pinmux::LoadPins(pinmux::BoardModel());
+  for (const auto* header : {&headers.p1_p8, &headers.p2_p9}) {
+    for (const auto& pin : *header) {
+      if (pin.gpio.empty())
+        continue;
+      int number = std::atoi(pin.gpio.c_str());
+      for (const auto& chip : chips) {
+        if (number >= chip.first && number < chip.first + chip.second) {
+          pins.push_back({number, pin.header});
+          break;
+        }
+      }
+    }
+  }
+  return pins;
+}
+
+// Alternative method if gpioinfo doesn't work.
+std::vector<Pin> FindExportedPins() {
+  std::vector<Pin> pins;
+  if (!std::filesystem::exists(GpioPath()))
+    return pins;
+
+  for (const auto& it : std::filesystem::directory_iterator(GpioPath())) {
+    std::string name = it.path().filename();
+    if (name.size() <= 4 || name.compare(0, 4, "gpio") ||
+        !std::all_of(name.begin() + 4, name.end(), ::isdigit)) {
+      continue;
+    }
+    pins.push_back({std::stoi(name.substr(4)), "GPIO" + name.substr(4)});
+  }
+  std::sort(pins.begin(), pins.end(),
+            [](const auto& a, const auto& b) { return a.number < b.number; });
+  return pins;
+}
+
+bool SetAttribute(int number,
+                  const char* attribute,
+                  const std::string& value) {
+  return Write(Path(number) + "/" + attribute, value);
+}
+
+bool IsWritable(int number) {
+  for (const char* attribute : UdevAttributes) {
+    if (access((Path(number) + "/" + attribute).c_str(), W_OK))
+      return false;
+  }
+  return true;
+}
+
+// Wait until the attributes of the newly exported |numbers| are writable,
+// woken up by inotify as udev changes their mode. Root doesn't wait.
+void WaitWritable(std::vector<int> numbers) {
+  TRACE_SCOPE("gpio::WaitWritable");
+  auto writable = [](int number) { return IsWritable(number); };
+  numbers.erase(std::remove_if(numbers.begin(), numbers.end(), writable),
+                numbers.end());
+  if (numbers.empty())
+    return;
+
+  int fd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+  if (fd < 0)
+    return;
+  for (int number : numbers) {
+    for (const char* attribute : UdevAttributes) {
+      std::string path = Path(number) + "/" + attribute;
+      inotify_add_watch(fd, path.c_str(), IN_ATTRIB);
+    }
+  }
+
+  auto deadline = std::chrono::steady_clock::now() + UdevTimeout;
+  while (true) {
+    // Check again once watched, in case udev was faster.
+    numbers.erase(std::remove_if(numbers.begin(), numbers.end(), writable),
+                  numbers.end());
+    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+        deadline - std::chrono::steady_clock::now());
+    if (numbers.empty() || left.count() <= 0)
+      break;
+
+    pollfd events = {fd, POLLIN, 0};
+    if (poll(&events, 1, left.count()) <= 0)
+      break;
+    char buffer[4096];
+    while (read(fd, buffer, sizeof(buffer)) > 0) {
+    }
+  }
+  close(fd);
+}
+
+// Parse "0" or "1", as written to sysfs.
+bool ParseBit(const std::string& value, int* bit) {
+  if (value != "0" && value != "1")
+    return false;
+  *bit = value == "1";
+  return true;
+}
+
+// Name the lines after the header pins in the names given by the kernel, eg.
+// "P9_12 [gpio1_28]".
+std::vector<Pin> FindChardevPins() {
+  std::vector<Pin> pins;
+  for (const auto& chip : gpiochip::FindChips()) {
+    for (const auto& line : gpiochip::ReadLines(chip)) {
+      std::string pin_name = FindPinName(line.name);
+      if (!pin_name.empty())
+        pins.push_back({line.number, pin_name});
+    }
+  }
+  return pins;
+}
+
+std::vector<Pin> FindGpioinfoPins() {
+  // First try with sudo, then without.
+  std::string output;
+  if (!HasRoot()) {
+    output = exec("sudo gpioinfo 2>/dev/null");
+    if (output.empty()) {
+      output = exec("gpioinfo 2>/dev/null");
+    }
+  }
+
+  if (output.empty() && !HasRoot()) {
+    LOG_ERROR << "gpioinfo failed or returned an empty output";
+  }
+
+  // Collect the chip base numbers from sysfs.
+  std::map<int, int> chip_to_base;
+  for (int chip_num = 0; chip_num < 10; chip_num++) {
+    long long base = 0;
+    if (ReadInt(GpioPath() + "/gpiochip" + std::to_string(chip_num) + "/base",
+                &base)) {
+      chip_to_base[chip_num] = base;
+      LOG_DEBUG << "Chip " << chip_num << " base = " << base;
+    }
+  }
+
+  std::vector<Pin> pins = ParseGpioinfo(output, chip_to_base);
+  for (const auto& pin : pins) {
+    LOG_DEBUG << "Found P pin - GPIO " << pin.number
+              << ", Name: " << pin.label;
+  }
+  return pins;
+}
+
+}  // namespace
+
+void PreferBackend(Backend backend) {
+  std::lock_guard<std::mutex> lock(g_backend_mutex);
+  g_preferred_backend = backend;
+  g_backend_found = false;
+}
+
+Backend CurrentBackend() {
+  std::lock_guard<std::mutex> lock(g_backend_mutex);
+  if (!g_backend_found) {
+    g_backend_found = true;
+    Backend other = g_preferred_backend == Backend::Chardev ? Backend::Sysfs
+                                                            : Backend::Chardev;
+    if (IsAvailable(g_preferred_backend))
+      g_backend = g_preferred_backend;
+    else if (IsAvailable(other))
+      g_backend = other;
+    else
+      g_backend = Backend::Sysfs;
+  }
+  return g_backend;
+}
+
+std::vector<Pin> FindPins() {
+  TRACE_SCOPE("gpio::FindPins");
+  std::string key = PinCacheKey();
+  std::vector<Pin> pins;
+  if (LoadPins(key, &pins))
+    return pins;
+
+  pins = IsChardev() ? FindChardevPins() : FindGpioinfoPins();
+  LOG_INFO << "Total P pins found: " << pins.size();
+  // Only the lines of the chips are cached: the fallbacks are partial, and
+  // would stand for the board until the key changes.
+  if (!pins.empty()) {
+    StorePins(key, pins);
+    return pins;
+  }
+
+  LOG_WARNING << "No P pins found with gpioinfo, trying fallback";
+  pins = FindPinInfoPins();
+  if (pins.empty())
+    pins = FindExportedPins();
+  return pins;
+}
+
+std::vector<Pin> ParseGpioinfo(const std::string& output,
+                               const std::map<int, int>& chip_to_base) {
+  TRACE_SCOPE("gpio::ParseGpioinfo");
+  std::vector<Pin> pins;
+  int current_chip = -1;
+  bool reading_chip = false;
+
+  std::istringstream iss(output);
+  std::string line;
+  while (std::getline(iss, line)) {
+    // Trim leading/trailing whitespace.
+    line.erase(0, line.find_first_not_of(" \t"));
+    line.erase(line.find_last_not_of(" \t") + 1);
+
+    // Check for chip header: "gpiochipX"
+    if (line.find("gpiochip") == 0) {
+      std::string chip_str = line.substr(8);
+      size_t space_pos = chip_str.find_first_of(" :");
+      if (space_pos != std::string::npos) {
+        chip_str = chip_str.substr(0, space_pos);
+      }
+
+      try {
+        current_chip = std::stoi(chip_str);
+        reading_chip = true;
+      } catch (...) {
+        current_chip = -1;
+        reading_chip = false;
+      }
+      continue;
+    }
+
+    // Parse line: "line   X:"
+    size_t line_pos = line.find("line");
+    if (!reading_chip || line_pos == std::string::npos) {
+      continue;
+    }
+
+    size_t num_start = line_pos + 4;
+    while (num_start < line.size() &&
+           (line[num_start] == ' ' || line[num_start] == '\t')) {
+      num_start++;
+    }
+
+    size_t num_end = num_start;
+    while (num_end < line.size() && isdigit(line[num_end])) {
+      num_end++;
+    }
+
+    if (num_end == num_start)
+      continue;
+
+    int line_num = std::stoi(line.substr(num_start, num_end - num_start));
+    std::string pin_name = FindPinName(line);
+    if (pin_name.empty())
+      continue;
+
+    int gpio_num = -1;
+    auto base = chip_to_base.find(current_chip);
+    if (base != chip_to_base.end()) {
+      gpio_num = base->second + line_num;
+    } else {
+      // Estimate: assume chips are numbered sequentially with 32 lines each.
+      gpio_num = current_chip * 32 + line_num;
+    }
+
+    pins.push_back({gpio_num, pin_name});
+  }
+
+  // Sort by GPIO number and remove duplicates.
+  std::sort(pins.begin(), pins.end(),
+            [](const auto& a, const auto& b) { return a.number < b.number; });
+  pins.erase(std::unique(pins.begin(), pins.end(),
+                         [](const auto& a, const auto& b) {
+                           return a.number == b.number;
+                         }),
+             pins.end());
+  return pins;
+}
+
+bool Resolve(const std::string& name, int* number) {
+  if (!name.empty() &&
+      name.find_first_not_of("0123456789") == std::string::npos) {
+    *number = std::atoi(name.c_str());
+    return true;
+  }
+
+  pinmux::PinDetail pin;
+  auto headers = pinmux::LoadPins(pinmux::BoardModel());
+  if (!pinmux::FindPin(headers, name, &pin) || pin.gpio.empty())
+    return false;
+  *number = std::atoi(pin.gpio.c_str());
+  return true;
+}
+
+std::string Path(int number) {
+  return GpioPath() + "/gpio" + std::to_string(number);
+}
+
+bool Export(int number) {
+  return Export(std::vector<int>{number});
+}
+
+bool Export(const std::vector<int>& numbers) {
+  TRACE_SCOPE("gpio::Export");
+  if (IsChardev())
+    return gpiochip::Request(numbers);
+
+  // The directory of a line appears as it is exported, but udev changes the
+  // mode of its attributes afterwards.
+  bool all = true;
+  std::vector<int> exported;
+  for (int number : numbers) {
+    if (std::filesystem::exists(Path(number)))
+      continue;
+    if (Write(GpioPath() + "/export", std::to_string(number)) &&
+        std::filesystem::exists(Path(number))) {
+      exported.push_back(number);
+    } else {
+      all = false;
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lock(g_exported_mutex);
+    g_exported.insert(exported.begin(), exported.end());
+  }
+  CloseAttributes(exported);
+
+  WaitWritable(exported);
+  return all;
+}
+
+void UnexportAll() {
+  TRACE_SCOPE("gpio::UnexportAll");
+  gpiochip::ReleaseAll();
+  CloseAttributes();
+
+  std::lock_guard<std::mutex> lock(g_exported_mutex);
+  for (int number : g_exported)
+    Write(GpioPath() + "/unexport", std::to_string(number));
+  g_exported.clear();
+}
+
+State Read(int number) {
+  TRACE_SCOPE("gpio::Read");
+  State state;
+  if (IsChardev()) {
+    gpiochip::Line line;
+    int value = 0;
+    if (gpiochip::ReadLine(number, &line)) {
+      state.direction = line.output ? "out" : "in";
+      state.edge = line.edge;
+      state.active_low = line.active_low ? "1" : "0";
+    }
+    if (gpiochip::GetValue(number, &value))
+      state.value = std::to_string(value);
+    return state;
+  }
+
+  std::string path = Path(number);
+  ReadLine(path + "/direction", &state.direction);
+  ReadLine(path + "/edge", &state.edge);
+  ReadLine(path + "/value", &state.value);
+  ReadLine(path + "/active_low", &state.active_low);
+  return state;
+}
+
+std::vector<State> ReadAll(const std::vector<int>& numbers) {
+  TRACE_SCOPE("gpio::ReadAll");
+  std::vector<State> states(numbers.size());
+  if (IsChardev()) {
+    std::map<int, gpiochip::LineState> lines;
+    for (auto& line : gpiochip::Snapshot(numbers))
+      lines[line.number] = line;
+    for (size_t i = 0; i < numbers.size(); ++i) {
+      auto it = lines.find(numbers[i]);
+      if (it == lines.end())
+        continue;
+      const gpiochip::LineState& line = it->second;
+      states[i].direction = line.output ? "out" : "in";
+      states[i].edge = line.edge;
+      states[i].value = std::to_string(line.value);
+      states[i].active_low = line.active_low ? "1" : "0";
+    }
+    return states;
+  }
+
+  // sysfs has no bulk read, but its attributes can be read again from their
+  // start without being reopened.
+  std::lock_guard<std::mutex> lock(g_attributes_mutex);
+  for (size_t i = 0; i < numbers.size(); ++i) {
+    auto& fds = g_attributes[numbers[i]].fds;
+    std::string* values[] = {&states[i].direction, &states[i].value,
+                             &states[i].edge, &states[i].active_low};
+    for (size_t j = 0; j < fds.size(); ++j) {
+      if (fds[j] >= 0 && ReadAttribute(fds[j], values[j]))
+        continue;
+      // Not open yet, or the line was unexported since, eg. by another
+      // process: the attribute is another file, if any.
+      if (fds[j] >= 0)
+        close(fds[j]);
+      std::string path = Path(numbers[i]) + "/" + UdevAttributes[j];
+      fds[j] = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+      if (fds[j] >= 0)
+        ReadAttribute(fds[j], values[j]);
+    }
+  }
+  return states;
+}
+
+bool SetDirection(int number, const std::string& direction) {
+  if (!IsChardev())
+    return SetAttribute(number, "direction", direction);
+
+  // "high" and "low" set an output with its initial value, as in sysfs.
+  if (direction == "in")
+    return gpiochip::SetDirection(number, false, 0);
+  if (direction == "out" || direction == "low")
+    return gpiochip::SetDirection(number, true, 0);
+  if (direction == "high")
+    return gpiochip::SetDirection(number, true, 1);
+  return false;
+}
+
+bool SetEdge(int number, const std::string& edge) {
+  if (IsChardev())
+    return gpiochip::SetEdge(number, edge);
+  return SetAttribute(number, "edge", edge);
+}
+
+bool SetValue(int number, const std::string& value) {
+  if (!IsChardev())
+    return SetAttribute(number, "value", value);
+  int bit = 0;
+  return ParseBit(value, &bit) && gpiochip::SetValue(number, bit);
+}
+
+bool SetActiveLow(int number, const std::string& active_low) {
+  if (!IsChardev())
+    return SetAttribute(number, "active_low", active_low);
+  int bit = 0;
+  return ParseBit(active_low, &bit) && gpiochip::SetActiveLow(number, bit);
+}
+
+}  // namespace gpio
+}  // namespace hw
@@ -0,0 +1,86 @@
+#ifndef BEAGLE_CONFIG_HW_GPIO_HPP
+#define BEAGLE_CONFIG_HW_GPIO_HPP
+
+#include <map>
+#include <string>
+#include <vector>
+
+// GPIO lines, through the character devices or /sys/class/gpio.
+namespace hw {
+namespace gpio {
+
+// The character devices (see hw/gpiochip.hpp) need neither gpioinfo nor
+// CONFIG_GPIO_SYSFS, but release the lines when bb-config exits, while the
+// settings made through sysfs outlive it.
+enum class Backend {
+  Chardev,
+  Sysfs,
+};
+
+// Use |backend| when the kernel provides it, the other one otherwise. The
+// default is the character devices.
+void PreferBackend(Backend backend);
+
+Backend CurrentBackend();
+
+struct Pin {
+  int number;         // Global GPIO number, eg. 60.
+  std::string label;  // Header name, eg. P9_12.
+};
+
+// The state of an exported line, as the strings used by sysfs.
+struct State {
+  std::string direction = "in";  // "in" or "out".
+  std::string edge = "none";     // "none", "rising", "falling" or "both".
+  std::string value = "0";
+  std::string active_low = "0";
+};
+
+// List the lines of the expansion headers, from the names of the lines of the
+// character devices, or from gpioinfo with sysfs. Falls back to the lines of
+// pin_info, then to the lines already exported. The lines found are cached
+// across runs (see hw/gpio_cache.hpp).
+std::vector<Pin> FindPins();
+
+// Parse the output of gpioinfo into the lines named after a header pin, sorted
+// by number. |chip_to_base| maps the chip indices to their first GPIO number;
+// chips missing from it are assumed to have 32 lines each.
+std::vector<Pin> ParseGpioinfo(const std::string& output,
+                               const std::map<int, int>& chip_to_base);
+
+// Resolve a line given by number, eg. "60", or by header pin, eg. "P9_12",
+// using the pin_info of the board.
+bool Resolve(const std::string& name, int* number);
+
+// Returns eg. /sys/class/gpio/gpio60
+std::string Path(int number);
+
+// Export |number| unless it already is, or request it from its character
+// device. Returns whether it is exported.
+bool Export(int number);
+
+// Export all of |numbers|. The character device requests them together, with
+// a single request per chip. Returns whether all of them are exported.
+bool Export(const std::vector<int>& numbers);
+
+// Unexport the lines exported by bb-config, and release the lines requested
+// from the character devices.
+void UnexportAll();
+
+// Read the state of an exported line. Missing attributes keep their default.
+State Read(int number);
+
+// Read the state of the exported |numbers|, in the same order, as efficiently
+// as the backend allows: a single read of the values per chip with the
+// character devices, and attributes kept open with sysfs.
+std::vector<State> ReadAll(const std::vector<int>& numbers);
+
+bool SetDirection(int number, const std::string& direction);
+bool SetEdge(int number, const std::string& edge);
+bool SetValue(int number, const std::string& value);
+bool SetActiveLow(int number, const std::string& active_low);
+
+}  // namespace gpio
+}  // namespace hw
+
+#endif /* end of include guard: BEAGLE_CONFIG_HW_GPIO_HPP */
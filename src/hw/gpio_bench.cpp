@@ -0,0 +1,367 @@
+#include "hw/gpio_bench.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+#include <ctime>
+#include <memory>
+#include "hw/gpio.hpp"
+#include "hw/gpiochip.hpp"
+#include "hw/root.hpp"
+#include "hw/sysfs.hpp"
+#include "trace.hpp"
+
+namespace hw {
+namespace gpio {
+
+namespace {
+
+constexpr int64_t TimeoutNs = 10000000;
+
+const std::pair<Method, const char*> methodNames[] = {
+    {Method::Sysfs, "sysfs"},
+    {Method::SysfsFd, "sysfs-fd"},
+    {Method::Chardev, "chardev"},
+    {Method::Mmio, "mmio"},
+};
+
+int64_t MonotonicNs() {
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000000000ll + now.tv_nsec;
+}
+
+// Write the output and read the input through a method.
+class Access {
+ public:
+  virtual ~Access() = default;
+  virtual bool Write(int value) = 0;
+  virtual bool Read(int* value) = 0;
+};
+
+class SysfsAccess : public Access {
+ public:
+  SysfsAccess(int output, int input)
+      : output_(Path(output) + "/value"), input_(Path(input) + "/value") {}
+
+  bool Write(int value) override {
+    return hw::Write(output_, value ? "1" : "0");
+  }
+
+  bool Read(int* value) override {
+    std::string line;
+    if (!ReadLine(input_, &line))
+      return false;
+    *value = line == "1";
+    return true;
+  }
+
+ private:
+  std::string output_;
+  std::string input_;
+};
+
+class SysfsFdAccess : public Access {
+ public:
+  SysfsFdAccess(int output, int input) {
+    output_ = open((Path(output) + "/value").c_str(), O_WRONLY | O_CLOEXEC);
+    input_ = open((Path(input) + "/value").c_str(), O_RDONLY | O_CLOEXEC);
+  }
+
+  ~SysfsFdAccess() override {
+    if (output_ >= 0)
+      close(output_);
+    if (input_ >= 0)
+      close(input_);
+  }
+
+  bool Write(int value) override {
+    return pwrite(output_, value ? "1" : "0", 1, 0) == 1;
+  }
+
+  bool Read(int* value) override {
+    char buffer = 0;
+    if (pread(input_, &buffer, 1, 0) != 1)
+      return false;
+    *value = buffer == '1';
+    return true;
+  }
+
+ private:
+  int output_ = -1;
+  int input_ = -1;
+};
+
+class ChardevAccess : public Access {
+ public:
+  ChardevAccess(int output, int input)
+      : writer_(std::vector<int>{output}), reader_(std::vector<int>{input}) {}
+
+  bool Write(int value) override { return writer_.Write(1, value); }
+
+  bool Read(int* value) override {
+    uint64_t bits = 0;
+    if (!reader_.Read(&bits))
+      return false;
+    *value = bits & 1;
+    return true;
+  }
+
+ private:
+  gpiochip::ValueWriter writer_;
+  gpiochip::ValueReader reader_;
+};
+
+// The GPIO modules of the AM335x: the lines 32 * i to 32 * i + 31 are those
+// of the module i. The directions are left to the kernel.
+class MmioAccess : public Access {
+ public:
+  MmioAccess(int output, int input) : output_(output), input_(input) {
+    fd_ = open("/dev/mem", O_RDWR | O_SYNC | O_CLOEXEC);
+    if (fd_ < 0)
+      return;
+    output_bank_ = Map(output / 32);
+    input_bank_ = Map(input / 32);
+  }
+
+  ~MmioAccess() override {
+    if (output_bank_)
+      munmap(const_cast<uint32_t*>(output_bank_), kSize);
+    if (input_bank_ && input_bank_ != output_bank_)
+      munmap(const_cast<uint32_t*>(input_bank_), kSize);
+    if (fd_ >= 0)
+      close(fd_);
+  }
+
+  static bool Supported() {
+    std::string compatible;
+    ReadLine(Rooted("/proc/device-tree/compatible"), &compatible);
+    return compatible.find("ti,am33xx") != std::string::npos;
+  }
+
+  bool mapped() const { return output_bank_ && input_bank_; }
+
+  bool Write(int value) override {
+    uint32_t bit = 1u << (output_ % 32);
+    output_bank_[(value ? kSetDataOut : kClearDataOut) / 4] = bit;
+    return true;
+  }
+
+  bool Read(int* value) override {
+    *value = (input_bank_[kDataIn / 4] >> (input_ % 32)) & 1;
+    return true;
+  }
+
+ private:
+  static constexpr size_t kSize = 4096;
+  static constexpr uint32_t kDataIn = 0x138;
+  static constexpr uint32_t kClearDataOut = 0x190;
+  static constexpr uint32_t kSetDataOut = 0x194;
+
+  volatile uint32_t* Map(int bank) {
+    static const off_t bases[] = {0x44e07000, 0x4804c000, 0x481ac000,
+                                  0x481ae000};
+    if (bank < 0 || bank >= 4)
+      return nullptr;
+    if (bank == output_ / 32 && output_bank_)
+      return output_bank_;
+    void* address =
+        mmap(nullptr, kSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd_,
+             bases[bank]);
+    if (address == MAP_FAILED)
+      return nullptr;
+    return static_cast<volatile uint32_t*>(address);
+  }
+
+  int output_;
+  int input_;
+  int fd_ = -1;
+  volatile uint32_t* output_bank_ = nullptr;
+  volatile uint32_t* input_bank_ = nullptr;
+};
+
+// Toggle the output, then measure the round trips.
+void Measure(Access* access, int iterations, BenchResult* result) {
+  TRACE_SCOPE("gpio::Measure");
+  int64_t start = MonotonicNs();
+  for (int i = 0; i < iterations; ++i)
+    result->failed += !access->Write(i & 1);
+  int64_t elapsed = MonotonicNs() - start;
+  if (elapsed > 0)
+    result->toggles_per_second = iterations * 1e9 / elapsed;
+
+  std::vector<int64_t> latencies;
+  latencies.reserve(iterations);
+  int value = 0;
+  for (int i = 0; i < iterations; ++i) {
+    value ^= 1;
+    int64_t written = MonotonicNs();
+    if (!access->Write(value)) {
+      result->failed++;
+      continue;
+    }
+    int read = -1;
+    int64_t now = written;
+    while (read != value && now - written < TimeoutNs) {
+      if (!access->Read(&read))
+        break;
+      now = MonotonicNs();
+    }
+    if (read == value)
+      latencies.push_back(now - written);
+    else if (read < 0)
+      result->failed++;
+    else
+      result->timeouts++;
+  }
+
+  result->samples = latencies.size();
+  if (latencies.empty())
+    return;
+  std::sort(latencies.begin(), latencies.end());
+  auto percentile = [&](size_t p) {
+    return latencies[(latencies.size() - 1) * p / 100];
+  };
+  result->min_ns = latencies.front();
+  result->p50_ns = percentile(50);
+  result->p99_ns = percentile(99);
+  result->max_ns = latencies.back();
+  for (int64_t latency : latencies) {
+    size_t bucket = 0;
+    while (bucket < 62 && (int64_t(2) << bucket) <= latency)
+      bucket++;
+    if (result->histogram.size() <= bucket)
+      result->histogram.resize(bucket + 1);
+    result->histogram[bucket]++;
+  }
+}
+
+void WriteEscaped(std::ostream& out, const std::string& text) {
+  out << '"';
+  for (char c : text) {
+    if (c == '"' || c == '\\')
+      out << '\\';
+    out << c;
+  }
+  out << '"';
+}
+
+}  // namespace
+
+const char* MethodName(Method method) {
+  for (const auto& it : methodNames) {
+    if (it.first == method)
+      return it.second;
+  }
+  return "";
+}
+
+bool ParseMethod(const std::string& name, Method* method) {
+  for (const auto& it : methodNames) {
+    if (name == it.second) {
+      *method = it.first;
+      return true;
+    }
+  }
+  return false;
+}
+
+BenchResult Benchmark(Method method, int output, int input, int iterations) {
+  TRACE_SCOPE("gpio::Benchmark");
+  BenchResult result;
+  result.method = method;
+
+  Backend previous = CurrentBackend();
+  Backend backend = method == Method::Chardev ? Backend::Chardev
+                    : method == Method::Mmio  ? previous
+                                              : Backend::Sysfs;
+  PreferBackend(backend);
+  if (CurrentBackend() != backend) {
+    result.error = backend == Backend::Chardev
+                       ? "no GPIO character devices"
+                       : "no /sys/class/gpio";
+    PreferBackend(previous);
+    return result;
+  }
+  if (method == Method::Mmio && !MmioAccess::Supported()) {
+    result.error = "not an AM335x";
+    PreferBackend(previous);
+    return result;
+  }
+
+  std::vector<int> numbers = {output};
+  if (input != output)
+    numbers.push_back(input);
+  if (!Export(numbers) || !SetDirection(output, "low") ||
+      (input != output && !SetDirection(input, "in"))) {
+    result.error = "cannot configure the lines";
+  } else {
+    std::unique_ptr<Access> access;
+    switch (method) {
+      case Method::Sysfs:
+        access = std::make_unique<SysfsAccess>(output, input);
+        break;
+      case Method::SysfsFd:
+        access = std::make_unique<SysfsFdAccess>(output, input);
+        break;
+      case Method::Chardev:
+        access = std::make_unique<ChardevAccess>(output, input);
+        break;
+      case Method::Mmio: {
+        auto mmio = std::make_unique<MmioAccess>(output, input);
+        if (mmio->mapped())
+          access = std::move(mmio);
+        else
+          result.error = "cannot map the GPIO registers from /dev/mem";
+        break;
+      }
+    }
+    if (access)
+      Measure(access.get(), iterations, &result);
+    if (access && !result.samples)
+      result.error = "the input never read the output, are they wired?";
+  }
+
+  UnexportAll();
+  PreferBackend(previous);
+  return result;
+}
+
+void WriteBenchJson(std::ostream& out,
+                    int output,
+                    int input,
+                    int iterations,
+                    const std::vector<BenchResult>& results) {
+  out << "{\"output\":" << output << ",\"input\":" << input
+      << ",\"iterations\":" << iterations << ",\"results\":[";
+  for (size_t i = 0; i < results.size(); ++i) {
+    const BenchResult& result = results[i];
+    out << (i ? "," : "") << "\n{\"method\":\"" << MethodName(result.method)
+        << "\"";
+    if (!result.error.empty()) {
+      out << ",\"error\":";
+      WriteEscaped(out, result.error);
+    }
+    out << ",\"toggles_per_second\":"
+        << static_cast<int64_t>(result.toggles_per_second)
+        << ",\"latency_ns\":{\"samples\":" << result.samples
+        << ",\"timeouts\":" << result.timeouts
+        << ",\"failed\":" << result.failed << ",\"min\":" << result.min_ns
+        << ",\"p50\":" << result.p50_ns << ",\"p99\":" << result.p99_ns
+        << ",\"max\":" << result.max_ns << ",\"histogram\":[";
+    // The buckets by their lower bound.
+    bool first = true;
+    for (size_t bucket = 0; bucket < result.histogram.size(); ++bucket) {
+      if (!result.histogram[bucket])
+        continue;
+      out << (first ? "" : ",") << "{\"from\":" << (int64_t(1) << bucket)
+          << ",\"count\":" << result.histogram[bucket] << "}";
+      first = false;
+    }
+    out << "]}}";
+  }
+  out << "\n]}\n";
+}
+
+}  // namespace gpio
+}  // namespace hw
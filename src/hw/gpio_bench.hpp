@@ -0,0 +1,60 @@
+#ifndef BEAGLE_CONFIG_HW_GPIO_BENCH_HPP
+#define BEAGLE_CONFIG_HW_GPIO_BENCH_HPP
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Compare the ways of accessing GPIO lines: how fast an output toggles, and
+// how long a value written to an output takes to be read on an input wired to
+// it. The output may be the input too, eg. with gpio-sim, to measure a write
+// followed by a read back without any hardware.
+namespace hw {
+namespace gpio {
+
+enum class Method {
+  Sysfs,    // Open, write or read and close the value attribute each time.
+  SysfsFd,  // The value attributes kept open.
+  Chardev,  // GPIO_V2_LINE_SET_VALUES and GET_VALUES.
+  Mmio,     // The registers of the GPIO modules of the AM335x, from /dev/mem.
+};
+
+// eg. "sysfs-fd"
+const char* MethodName(Method method);
+bool ParseMethod(const std::string& name, Method* method);
+
+struct BenchResult {
+  Method method;
+  std::string error;  // Empty if the method could be measured.
+  double toggles_per_second = 0;
+
+  // The latency from the write to the output to the read of the same value on
+  // the input, in ns.
+  uint64_t samples = 0;
+  uint64_t timeouts = 0;  // Values not read within 10ms.
+  uint64_t failed = 0;    // Failed writes or reads.
+  int64_t min_ns = 0;
+  int64_t p50_ns = 0;
+  int64_t p99_ns = 0;
+  int64_t max_ns = 0;
+  // The samples from 2^i to 2^(i+1) ns.
+  std::vector<uint64_t> histogram;
+};
+
+// Measure |method| over |iterations| toggles and as many round trips. The
+// lines are configured through the backend of the method, sysfs or the
+// character devices, then unexported or released.
+BenchResult Benchmark(Method method, int output, int input, int iterations);
+
+// Write |results| as JSON.
+void WriteBenchJson(std::ostream& out,
+                    int output,
+                    int input,
+                    int iterations,
+                    const std::vector<BenchResult>& results);
+
+}  // namespace gpio
+}  // namespace hw
+
+#endif /* end of include guard: BEAGLE_CONFIG_HW_GPIO_BENCH_HPP */
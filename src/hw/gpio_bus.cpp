@@ -0,0 +1,157 @@
+#include "hw/gpio_bus.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <ctime>
+#include <sstream>
+#include "hw/gpio.hpp"
+#include "hw/gpiochip.hpp"
+#include "trace.hpp"
+
+namespace hw {
+namespace gpio {
+
+namespace {
+
+int64_t MonotonicNs() {
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000000000ll + now.tv_nsec;
+}
+
+}  // namespace
+
+bool ParseBus(const std::string& text,
+              std::vector<int>* numbers,
+              std::string* error) {
+  numbers->clear();
+  std::string source = text;
+  std::replace(source.begin(), source.end(), ',', ' ');
+  std::istringstream tokens(source);
+  std::string token;
+  while (tokens >> token) {
+    int number = 0;
+    if (!Resolve(token, &number)) {
+      *error = "Unknown line: " + token;
+      return false;
+    }
+    if (std::find(numbers->begin(), numbers->end(), number) !=
+        numbers->end()) {
+      *error = "Repeated line: " + token;
+      return false;
+    }
+    if (numbers->size() == 64) {
+      *error = "More than 64 lines";
+      return false;
+    }
+    numbers->push_back(number);
+  }
+  if (numbers->empty()) {
+    *error = "No lines";
+    return false;
+  }
+  return true;
+}
+
+Bus::Bus(const std::vector<int>& numbers, BitOrder order) : numbers_(numbers) {
+  if (numbers_.size() > 64)
+    numbers_.resize(64);
+  if (order == BitOrder::MsbFirst)
+    std::reverse(numbers_.begin(), numbers_.end());
+  mask_ = numbers_.size() == 64 ? ~0ull : (1ull << numbers_.size()) - 1;
+  Export(numbers_);
+
+  if (CurrentBackend() == Backend::Chardev) {
+    reader_ = std::make_unique<gpiochip::ValueReader>(numbers_);
+    writer_ = std::make_unique<gpiochip::ValueWriter>(numbers_);
+  } else {
+    for (int number : numbers_) {
+      std::string path = Path(number) + "/value";
+      fds_.push_back(open(path.c_str(), O_RDWR | O_CLOEXEC));
+    }
+  }
+}
+
+Bus::~Bus() {
+  if (writer_)
+    writer_->Sync();
+  for (int fd : fds_) {
+    if (fd >= 0)
+      close(fd);
+  }
+}
+
+bool Bus::SetOutput(bool output, uint64_t word) {
+  TRACE_SCOPE("Bus::SetOutput");
+  if (writer_)
+    writer_->Sync();
+  bool all = true;
+  for (size_t i = 0; i < numbers_.size(); ++i) {
+    const char* direction = !output ? "in" : (word >> i) & 1 ? "high" : "low";
+    all &= SetDirection(numbers_[i], direction);
+  }
+  return all;
+}
+
+bool Bus::Read(uint64_t* word) const {
+  if (reader_)
+    return reader_->Read(word);
+
+  uint64_t result = 0;
+  for (size_t i = 0; i < fds_.size(); ++i) {
+    char value = 0;
+    if (pread(fds_[i], &value, 1, 0) != 1)
+      return false;
+    result |= uint64_t(value == '1') << i;
+  }
+  *word = result;
+  return true;
+}
+
+bool Bus::Write(uint64_t word) {
+  if (writer_)
+    return writer_->Write(mask_, word);
+
+  bool written = true;
+  for (size_t i = 0; i < fds_.size(); ++i)
+    written &= pwrite(fds_[i], (word >> i) & 1 ? "1" : "0", 1, 0) == 1;
+  return written;
+}
+
+size_t Bus::requests() const {
+  return writer_ ? writer_->requests() : fds_.size();
+}
+
+Throughput MeasureThroughput(Bus* bus, std::chrono::nanoseconds duration) {
+  TRACE_SCOPE("gpio::MeasureThroughput");
+  Throughput throughput;
+  // Check the clock every so many words only, not to measure it instead.
+  constexpr uint64_t kBatch = 64;
+
+  uint64_t words = 0;
+  int64_t start = MonotonicNs();
+  int64_t now = start;
+  while (now - start < duration.count()) {
+    for (uint64_t i = 0; i < kBatch; ++i)
+      throughput.failed += !bus->Write(words + i);
+    words += kBatch;
+    now = MonotonicNs();
+  }
+  throughput.writes_per_second = words * 1e9 / (now - start);
+
+  uint64_t word = 0;
+  words = 0;
+  start = MonotonicNs();
+  now = start;
+  while (now - start < duration.count()) {
+    for (uint64_t i = 0; i < kBatch; ++i)
+      throughput.failed += !bus->Read(&word);
+    words += kBatch;
+    now = MonotonicNs();
+  }
+  throughput.reads_per_second = words * 1e9 / (now - start);
+  return throughput;
+}
+
+}  // namespace gpio
+}  // namespace hw
@@ -0,0 +1,81 @@
+#ifndef BEAGLE_CONFIG_HW_GPIO_BUS_HPP
+#define BEAGLE_CONFIG_HW_GPIO_BUS_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace hw {
+namespace gpiochip {
+class ValueReader;
+class ValueWriter;
+}  // namespace gpiochip
+
+namespace gpio {
+
+// Whether the first line of a bus is its least or most significant bit.
+enum class BitOrder {
+  LsbFirst,
+  MsbFirst,
+};
+
+// Parse the lines of a bus, separated by spaces or commas, as for Resolve().
+// Returns false with |error| set if one is unknown, repeated, or if there are
+// more than 64 of them.
+bool ParseBus(const std::string& text,
+              std::vector<int>* numbers,
+              std::string* error);
+
+// A group of lines read and written as a word, eg. a parallel interface.
+//
+// With the character devices, a word is read or written with a single
+// GPIO_V2_LINE_GET_VALUES or SET_VALUES per chip, so that the lines of a chip
+// change at once. With sysfs, the value attributes are kept open and written
+// one after the other.
+class Bus {
+ public:
+  // Up to 64 |numbers|, exported if they aren't.
+  Bus(const std::vector<int>& numbers, BitOrder order);
+  ~Bus();
+
+  Bus(const Bus&) = delete;
+  Bus& operator=(const Bus&) = delete;
+
+  size_t width() const { return numbers_.size(); }
+
+  // The lines by increasing bit.
+  const std::vector<int>& numbers() const { return numbers_; }
+
+  // Make all the lines inputs, or outputs set to |word|.
+  bool SetOutput(bool output, uint64_t word);
+
+  bool Read(uint64_t* word) const;
+  bool Write(uint64_t word);
+
+  // The requests written per word: more than one when the lines span chips.
+  size_t requests() const;
+
+ private:
+  std::vector<int> numbers_;
+  uint64_t mask_;
+  std::unique_ptr<gpiochip::ValueReader> reader_;  // Character devices.
+  std::unique_ptr<gpiochip::ValueWriter> writer_;
+  std::vector<int> fds_;  // sysfs value attributes.
+};
+
+struct Throughput {
+  double writes_per_second = 0;
+  double reads_per_second = 0;
+  uint64_t failed = 0;
+};
+
+// Write an incrementing word for |duration|, then read the bus for as long.
+// The bus is left at the last word written.
+Throughput MeasureThroughput(Bus* bus, std::chrono::nanoseconds duration);
+
+}  // namespace gpio
+}  // namespace hw
+
+#endif /* end of include guard: BEAGLE_CONFIG_HW_GPIO_BUS_HPP */
@@ -0,0 +1,207 @@
+#include "hw/gpio_cache.hpp"
+#include <sys/utsname.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include "hw/gpiochip.hpp"
+#include "hw/root.hpp"
+#include "hw/sysfs.hpp"
+#include "trace.hpp"
+#include "xdg_utils.hpp"
+
+namespace hw {
+namespace gpio {
+
+namespace {
+
+// The file starts with Magic and Version, followed by the key and the pins:
+//   u32 key size, key
+//   u32 number of pins
+//   per pin: i32 number, u8 label size, label
+// in the byte order of the board.
+const char Magic[4] = {'B', 'B', 'G', 'P'};
+constexpr uint32_t Version = 1;
+
+std::string CachePath() {
+  std::string home;
+  try {
+    home = xdg_utils::cache::home();
+  } catch (const std::runtime_error&) {
+    // Neither XDG_CACHE_HOME nor HOME are set.
+  }
+  if (home.empty())
+    return {};
+  return home + "/bb-config/gpio-pins.bin";
+}
+
+std::string KernelRelease() {
+  std::string release;
+  if (ReadLine(Rooted("/proc/sys/kernel/osrelease"), &release))
+    return release;
+  utsname name;
+  if (uname(&name) == 0)
+    return name.release;
+  return {};
+}
+
+// The labels of the chips, eg. "gpio-0-31,gpio-32-63".
+std::string ChipLabels() {
+  std::vector<std::string> labels;
+  if (CurrentBackend() == Backend::Chardev) {
+    for (const auto& chip : gpiochip::FindChips())
+      labels.push_back(chip.label);
+  } else {
+    std::error_code error;
+    for (const auto& it : std::filesystem::directory_iterator(
+             Rooted("/sys/class/gpio"), error)) {
+      std::string name = it.path().filename();
+      std::string label;
+      if (name.rfind("gpiochip", 0) == 0 &&
+          ReadLine(it.path() / "label", &label)) {
+        labels.push_back(name + "=" + label);
+      }
+    }
+    std::sort(labels.begin(), labels.end());
+  }
+
+  std::string joined;
+  for (const auto& label : labels)
+    joined += (joined.empty() ? "" : ",") + label;
+  return joined;
+}
+
+template <typename T>
+void Put(std::string* out, T value) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// Reads from a buffer, failing once past its end.
+class Reader {
+ public:
+  explicit Reader(const std::string& data) : data_(data) {}
+
+  template <typename T>
+  bool Get(T* value) {
+    if (data_.size() - offset_ < sizeof(T))
+      return false;
+    std::memcpy(value, data_.data() + offset_, sizeof(T));
+    offset_ += sizeof(T);
+    return true;
+  }
+
+  bool Get(size_t size, std::string* value) {
+    if (data_.size() - offset_ < size)
+      return false;
+    value->assign(data_, offset_, size);
+    offset_ += size;
+    return true;
+  }
+
+  bool done() const { return offset_ == data_.size(); }
+
+ private:
+  const std::string& data_;
+  size_t offset_ = 0;
+};
+
+}  // namespace
+
+std::string PinCacheKey() {
+  TRACE_SCOPE("gpio::PinCacheKey");
+  std::string labels = ChipLabels();
+  if (labels.empty())
+    return {};
+
+  std::string model;
+  ReadLine(Rooted("/proc/device-tree/model"), &model);
+  // The model ends with a NUL byte.
+  model = model.c_str();
+
+  std::string backend =
+      CurrentBackend() == Backend::Chardev ? "chardev" : "sysfs";
+  return model + "\n" + KernelRelease() + "\n" + labels + "\n" + backend +
+         "\n" + Rooted("/");
+}
+
+bool LoadPins(const std::string& key, std::vector<Pin>* pins) {
+  TRACE_SCOPE("gpio::LoadPins");
+  std::string path = CachePath();
+  if (key.empty() || path.empty())
+    return false;
+  std::ifstream file(path, std::ios::binary);
+  std::string data((std::istreambuf_iterator<char>(file)),
+                   std::istreambuf_iterator<char>());
+
+  Reader reader(data);
+  std::string magic, cached_key;
+  uint32_t version = 0, key_size = 0, count = 0;
+  if (!reader.Get(sizeof(Magic), &magic) ||
+      magic != std::string(Magic, sizeof(Magic)) || !reader.Get(&version) ||
+      version != Version || !reader.Get(&key_size) ||
+      !reader.Get(key_size, &cached_key) || cached_key != key ||
+      !reader.Get(&count)) {
+    return false;
+  }
+
+  std::vector<Pin> loaded;
+  for (uint32_t i = 0; i < count; ++i) {
+    int32_t number = 0;
+    uint8_t label_size = 0;
+    Pin pin;
+    if (!reader.Get(&number) || !reader.Get(&label_size) ||
+        !reader.Get(label_size, &pin.label)) {
+      return false;
+    }
+    pin.number = number;
+    loaded.push_back(pin);
+  }
+  if (!reader.done())
+    return false;
+  *pins = std::move(loaded);
+  return true;
+}
+
+bool StorePins(const std::string& key, const std::vector<Pin>& pins) {
+  TRACE_SCOPE("gpio::StorePins");
+  std::string path = CachePath();
+  if (key.empty() || path.empty())
+    return false;
+
+  std::string data(Magic, sizeof(Magic));
+  Put(&data, Version);
+  Put(&data, uint32_t(key.size()));
+  data += key;
+  Put(&data, uint32_t(pins.size()));
+  for (const auto& pin : pins) {
+    if (pin.label.size() > UINT8_MAX)
+      return false;
+    Put(&data, int32_t(pin.number));
+    Put(&data, uint8_t(pin.label.size()));
+    data += pin.label;
+  }
+
+  // Replace the file atomically, for concurrent runs not to read half of it.
+  std::error_code error;
+  std::filesystem::create_directories(
+      std::filesystem::path(path).parent_path(), error);
+  std::string temporary = path + "." + std::to_string(getpid());
+  {
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    if (!file.write(data.data(), data.size()))
+      return false;
+  }
+  std::filesystem::rename(temporary, path, error);
+  if (error) {
+    std::filesystem::remove(temporary, error);
+    return false;
+  }
+  return true;
+}
+
+}  // namespace gpio
+}  // namespace hw
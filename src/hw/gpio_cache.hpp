@@ -0,0 +1,29 @@
+#ifndef BEAGLE_CONFIG_HW_GPIO_CACHE_HPP
+#define BEAGLE_CONFIG_HW_GPIO_CACHE_HPP
+
+#include <string>
+#include <vector>
+#include "hw/gpio.hpp"
+
+// The lines of the expansion headers found by FindPins() from the GPIO chips,
+// cached across runs in $XDG_CACHE_HOME/bb-config/gpio-pins.bin. They only
+// change with the board, the kernel or its device tree, which make up the key
+// of the cache.
+namespace hw {
+namespace gpio {
+
+// The board model, the kernel release, the labels of the GPIO chips, the
+// backend and the root. Empty if the chips can't be listed.
+std::string PinCacheKey();
+
+// Load the pins cached for |key|. Returns false if there are none, or if they
+// were cached for another key.
+bool LoadPins(const std::string& key, std::vector<Pin>* pins);
+
+// Cache |pins| for |key|, replacing the previous ones.
+bool StorePins(const std::string& key, const std::vector<Pin>& pins);
+
+}  // namespace gpio
+}  // namespace hw
+
+#endif /* end of include guard: BEAGLE_CONFIG_HW_GPIO_CACHE_HPP */
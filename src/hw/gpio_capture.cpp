@@ -0,0 +1,167 @@
+#include "hw/gpio_capture.hpp"
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <ctime>
+#include "hw/gpio.hpp"
+#include "hw/gpiochip.hpp"
+#include "trace.hpp"
+
+namespace hw {
+namespace gpio {
+
+namespace {
+
+// Above the normal threads, but below the threaded interrupt handlers (50), not
+// to hold off the drivers for the duration of a capture.
+constexpr int CapturePriority = 40;
+
+// On a single CPU, eg. the AM335x of the BeagleBone Black, the capture would
+// starve every other thread, the UI included. It samples in bursts instead.
+constexpr int64_t BurstNs = 9000000;
+constexpr int64_t PauseNs = 1000000;
+
+int64_t MonotonicNs() {
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000000000ll + now.tv_nsec;
+}
+
+}  // namespace
+
+Capture::Capture(const std::vector<int>& numbers) : numbers_(numbers) {
+  if (numbers_.size() > 64)
+    numbers_.resize(64);
+  if (CurrentBackend() == Backend::Chardev) {
+    reader_ = std::make_unique<gpiochip::ValueReader>(numbers_);
+    return;
+  }
+  for (int number : numbers_) {
+    std::string path = Path(number) + "/value";
+    fds_.push_back(open(path.c_str(), O_RDONLY | O_CLOEXEC));
+  }
+}
+
+Capture::~Capture() {
+  Stop();
+  for (int fd : fds_) {
+    if (fd >= 0)
+      close(fd);
+  }
+}
+
+bool Capture::Start(std::chrono::nanoseconds duration) {
+  TRACE_SCOPE("Capture::Start");
+  if (thread_.joinable() || numbers_.empty())
+    return false;
+  stop_ = false;
+  running_ = true;
+  thread_ = std::thread([this, duration] { Run(duration.count()); });
+  return true;
+}
+
+void Capture::Stop() {
+  stop_ = true;
+  if (thread_.joinable())
+    thread_.join();
+}
+
+bool Capture::Read(uint64_t* bits) {
+  if (reader_)
+    return reader_->Read(bits);
+
+  uint64_t result = 0;
+  for (size_t i = 0; i < fds_.size(); ++i) {
+    char value = '0';
+    if (pread(fds_[i], &value, 1, 0) != 1)
+      return false;
+    if (value == '1')
+      result |= 1ull << i;
+  }
+  *bits = result;
+  return true;
+}
+
+void Capture::Run(int64_t duration_ns) {
+  sched_param param = {};
+  param.sched_priority = CapturePriority;
+  realtime_ = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+
+  bool bursts = std::thread::hardware_concurrency() <= 1;
+  int64_t start = MonotonicNs();
+  int64_t now = start;
+  int64_t burst = start;
+  int64_t paused = 0;
+  uint64_t samples = 0;
+  Sample last = {start, 0};
+  while (!stop_ && now - start < duration_ns) {
+    if (bursts && now - burst >= BurstNs && samples) {
+      timespec pause = {0, PauseNs};
+      nanosleep(&pause, nullptr);
+      int64_t resumed = MonotonicNs();
+      // The samples the pause missed, at the rate so far.
+      double period = double(now - start - paused) / samples;
+      missed_ += (resumed - now) / period;
+      paused += resumed - now;
+      now = burst = resumed;
+    }
+
+    uint64_t bits = 0;
+    if (!Read(&bits))
+      break;
+    now = MonotonicNs();
+    samples++;
+    if (samples == 1 || bits != last.bits) {
+      last = {now, bits};
+      if (!changes_.Push(last))
+        lost_++;
+    }
+    samples_.store(samples, std::memory_order_relaxed);
+    elapsed_ns_.store(now - start, std::memory_order_relaxed);
+  }
+
+  // Mark the end of the capture.
+  if (samples > 1 && !changes_.Push({now, last.bits}))
+    lost_++;
+  running_ = false;
+}
+
+bool WriteVcd(std::ostream& out,
+              const std::vector<std::string>& names,
+              const std::vector<Sample>& samples) {
+  // The identifiers of the variables are printable characters from '!'.
+  out << "$version bb-config $end\n"
+      << "$timescale 1ns $end\n"
+      << "$scope module gpio $end\n";
+  for (size_t i = 0; i < names.size(); ++i) {
+    std::string name = names[i];
+    for (char& c : name) {
+      if (c == ' ')
+        c = '_';
+    }
+    out << "$var wire 1 " << char('!' + i) << " " << name << " $end\n";
+  }
+  out << "$upscope $end\n"
+      << "$enddefinitions $end\n";
+
+  for (size_t i = 0; i < samples.size(); ++i) {
+    const Sample& sample = samples[i];
+    uint64_t changed = i == 0 ? ~0ull : sample.bits ^ samples[i - 1].bits;
+    if (!changed && i + 1 < samples.size())
+      continue;
+    out << "#" << sample.timestamp_ns - samples[0].timestamp_ns << "\n";
+    if (i == 0)
+      out << "$dumpvars\n";
+    for (size_t j = 0; j < names.size(); ++j) {
+      if ((changed >> j) & 1)
+        out << ((sample.bits >> j) & 1) << char('!' + j) << "\n";
+    }
+    if (i == 0)
+      out << "$end\n";
+  }
+  return bool(out);
+}
+
+}  // namespace gpio
+}  // namespace hw
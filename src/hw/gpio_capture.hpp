@@ -0,0 +1,92 @@
+#ifndef BEAGLE_CONFIG_HW_GPIO_CAPTURE_HPP
+#define BEAGLE_CONFIG_HW_GPIO_CAPTURE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "spsc_queue.hpp"
+
+namespace hw {
+namespace gpiochip {
+class ValueReader;
+}  // namespace gpiochip
+
+namespace gpio {
+
+// The levels of the captured lines at a time, in CLOCK_MONOTONIC.
+struct Sample {
+  int64_t timestamp_ns;
+  uint64_t bits;  // Bit i for the line i of the capture.
+};
+
+// Sample exported lines as fast as the backend allows, like a logic analyzer,
+// from a thread with a real-time priority when it can get one. Only the
+// samples where a level changes are kept, in a preallocated ring the UI
+// drains, so that slow signals don't fill it.
+//
+// The thread doesn't sleep while it samples: a capture lasts a fixed
+// duration, for the rest of the system to get the CPU back. On a single CPU,
+// it pauses regularly, and counts the samples it misses.
+class Capture {
+ public:
+  // Up to 64 |numbers|.
+  explicit Capture(const std::vector<int>& numbers);
+  ~Capture();
+
+  Capture(const Capture&) = delete;
+  Capture& operator=(const Capture&) = delete;
+
+  // Sample for |duration|, once: a capture doesn't restart.
+  bool Start(std::chrono::nanoseconds duration);
+  void Stop();
+  bool running() const { return running_; }
+
+  // Pop the oldest change not consumed yet. The first and last samples are
+  // always kept. Consumer side.
+  bool Pop(Sample* sample) { return changes_.Pop(sample); }
+
+  const std::vector<int>& numbers() const { return numbers_; }
+
+  uint64_t samples() const { return samples_; }
+  // The changes lost because the consumer didn't keep up.
+  uint64_t lost() const { return lost_; }
+  // The samples missed while the thread paused, estimated from the rate.
+  uint64_t missed() const { return missed_; }
+  int64_t elapsed_ns() const { return elapsed_ns_; }
+  // Whether the thread got SCHED_FIFO, which takes CAP_SYS_NICE.
+  bool realtime() const { return realtime_; }
+
+ private:
+  void Run(int64_t duration_ns);
+  bool Read(uint64_t* bits);
+
+  std::vector<int> numbers_;
+  std::unique_ptr<gpiochip::ValueReader> reader_;  // Character devices.
+  std::vector<int> fds_;                           // sysfs value attributes.
+
+  SpscQueue<Sample> changes_{1 << 16};
+  std::atomic<bool> stop_{false};
+  std::atomic<bool> running_{false};
+  std::atomic<bool> realtime_{false};
+  std::atomic<uint64_t> samples_{0};
+  std::atomic<uint64_t> lost_{0};
+  std::atomic<uint64_t> missed_{0};
+  std::atomic<int64_t> elapsed_ns_{0};
+  std::thread thread_;
+};
+
+// Write |samples| of the lines |names| as a Value Change Dump, for sigrok or
+// GTKWave. Times are relative to the first sample.
+bool WriteVcd(std::ostream& out,
+              const std::vector<std::string>& names,
+              const std::vector<Sample>& samples);
+
+}  // namespace gpio
+}  // namespace hw
+
+#endif /* end of include guard: BEAGLE_CONFIG_HW_GPIO_CAPTURE_HPP */
@@ -0,0 +1,224 @@
+#include "hw/gpio_monitor.hpp"
+#include <fcntl.h>
+#include <linux/gpio.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <ctime>
+#include "hw/gpio.hpp"
+#include "hw/gpiochip.hpp"
+#include "trace.hpp"
+
+namespace hw {
+namespace gpio {
+
+namespace {
+
+int64_t MonotonicNs() {
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000000000ll + now.tv_nsec;
+}
+
+}  // namespace
+
+EdgeMonitor::EdgeMonitor() {
+  wake_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  thread_ = std::thread([this] { Run(); });
+}
+
+EdgeMonitor::~EdgeMonitor() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  Wake();
+  thread_.join();
+
+  for (const auto& it : sources_) {
+    if (!it.second.chardev)
+      close(it.second.fd);
+  }
+  for (int fd : closing_)
+    close(fd);
+  close(wake_fd_);
+}
+
+bool EdgeMonitor::Watch(int number) {
+  TRACE_SCOPE("EdgeMonitor::Watch");
+  State state = Read(number);
+  if (state.edge == "none")
+    return false;
+
+  Source source = {-1, CurrentBackend() == Backend::Chardev, 0, state.edge};
+  if (source.chardev) {
+    if (!gpiochip::EventSource(number, &source.fd, &source.offset))
+      return false;
+  } else {
+    source.fd = open((Path(number) + "/value").c_str(), O_RDONLY | O_CLOEXEC);
+    if (source.fd < 0)
+      return false;
+    // sysfs notifies the readers of the value only once they have read it.
+    char value[8];
+    if (read(source.fd, value, sizeof(value)) < 0) {
+      close(source.fd);
+      return false;
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = sources_.find(number);
+    if (it != sources_.end() && !it->second.chardev)
+      closing_.push_back(it->second.fd);
+    sources_[number] = source;
+    changed_ = true;
+  }
+  Wake();
+  return true;
+}
+
+void EdgeMonitor::Unwatch(int number) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = sources_.find(number);
+    if (it == sources_.end())
+      return;
+    if (!it->second.chardev)
+      closing_.push_back(it->second.fd);
+    sources_.erase(it);
+    changed_ = true;
+  }
+  Wake();
+}
+
+void EdgeMonitor::Wake() {
+  uint64_t one = 1;
+  [[maybe_unused]] ssize_t size = write(wake_fd_, &one, sizeof(one));
+}
+
+void EdgeMonitor::Push(const Edge& edge) {
+  if (!edges_.Push(edge))
+    dropped_++;
+}
+
+void EdgeMonitor::Run() {
+  std::map<int, Source> sources;
+  std::vector<pollfd> fds;
+  std::vector<int> numbers;  // Of the sysfs descriptors in |fds|, else -1.
+
+  while (true) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (stop_)
+        return;
+      for (int fd : closing_)
+        close(fd);
+      closing_.clear();
+
+      if (changed_) {
+        changed_ = false;
+        sources = sources_;
+        fds = {{wake_fd_, POLLIN, 0}};
+        numbers = {-1};
+        for (const auto& it : sources) {
+          const Source& source = it.second;
+          // The lines requested together share their descriptor.
+          bool shared = source.chardev &&
+                        std::any_of(fds.begin(), fds.end(), [&](auto& fd) {
+                          return fd.fd == source.fd;
+                        });
+          if (shared)
+            continue;
+          fds.push_back(
+              {source.fd, short(source.chardev ? POLLIN : POLLPRI), 0});
+          numbers.push_back(source.chardev ? -1 : it.first);
+        }
+      }
+    }
+
+    if (poll(fds.data(), fds.size(), -1) < 0) {
+      if (errno == EINTR)
+        continue;
+      return;
+    }
+
+    if (fds[0].revents) {
+      uint64_t count;
+      [[maybe_unused]] ssize_t size = read(wake_fd_, &count, sizeof(count));
+      continue;
+    }
+
+    for (size_t i = 1; i < fds.size(); ++i) {
+      if (!fds[i].revents)
+        continue;
+      if (numbers[i] < 0)
+        ReadLineEvents(fds[i].fd, sources);
+      else
+        ReadValue(numbers[i], sources[numbers[i]]);
+    }
+  }
+}
+
+void EdgeMonitor::ReadLineEvents(int fd, const std::map<int, Source>& sources) {
+  gpio_v2_line_event events[64];
+  ssize_t size = read(fd, events, sizeof(events));
+  if (size <= 0)
+    return;
+
+  for (size_t i = 0; i < size / sizeof(events[0]); ++i) {
+    for (const auto& it : sources) {
+      const Source& source = it.second;
+      if (source.chardev && source.fd == fd &&
+          source.offset == events[i].offset) {
+        Push({it.first, static_cast<int64_t>(events[i].timestamp_ns),
+              events[i].id == GPIO_V2_LINE_EVENT_RISING_EDGE});
+        break;
+      }
+    }
+  }
+}
+
+void EdgeMonitor::ReadValue(int number, const Source& source) {
+  int64_t timestamp = MonotonicNs();
+  char value = '0';
+  if (lseek(source.fd, 0, SEEK_SET) < 0 || read(source.fd, &value, 1) != 1)
+    return;
+
+  // With a single edge detected, the level may already have changed back.
+  bool rising = value == '1';
+  if (source.edge == "rising")
+    rising = true;
+  else if (source.edge == "falling")
+    rising = false;
+  Push({number, timestamp, rising});
+}
+
+void EdgeStats::Add(const Edge& edge) {
+  level = edge.rising;
+  last_edge_ns = edge.timestamp_ns;
+
+  if (!edge.rising) {
+    falling++;
+    if (last_rising_ns_ >= 0)
+      high_ns = edge.timestamp_ns - last_rising_ns_;
+    last_falling_ns_ = edge.timestamp_ns;
+    return;
+  }
+
+  rising++;
+  if (last_falling_ns_ >= 0)
+    low_ns = edge.timestamp_ns - last_falling_ns_;
+  if (last_rising_ns_ >= 0 && edge.timestamp_ns > last_rising_ns_) {
+    double period = edge.timestamp_ns - last_rising_ns_;
+    // Smooth the jitter of the timestamps over the last periods.
+    period_ns_ = period_ns_ ? (period_ns_ * 7 + period) / 8 : period;
+    frequency = 1e9 / period_ns_;
+  }
+  last_rising_ns_ = edge.timestamp_ns;
+}
+
+}  // namespace gpio
+}  // namespace hw
@@ -0,0 +1,95 @@
+#ifndef BEAGLE_CONFIG_HW_GPIO_MONITOR_HPP
+#define BEAGLE_CONFIG_HW_GPIO_MONITOR_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "spsc_queue.hpp"
+
+namespace hw {
+namespace gpio {
+
+// An edge of a line, timestamped with CLOCK_MONOTONIC.
+struct Edge {
+  int number;
+  int64_t timestamp_ns;
+  bool rising;
+};
+
+// Wait on the edges of lines, as configured with SetEdge(), from a thread of
+// its own: line events of the character devices, or POLLPRI on the value
+// attribute with sysfs. The thread sleeps in poll() between edges, and queues
+// them without locking for a single consumer thread.
+class EdgeMonitor {
+ public:
+  EdgeMonitor();
+  ~EdgeMonitor();
+
+  EdgeMonitor(const EdgeMonitor&) = delete;
+  EdgeMonitor& operator=(const EdgeMonitor&) = delete;
+
+  // Start waiting on the edges of the exported line |number|. Returns false if
+  // it detects no edge.
+  bool Watch(int number);
+  void Unwatch(int number);
+
+  // Pop the oldest edge not consumed yet. Consumer side.
+  bool Pop(Edge* edge) { return edges_.Pop(edge); }
+
+  // The edges lost because the consumer didn't keep up.
+  uint64_t dropped() const { return dropped_; }
+
+ private:
+  struct Source {
+    int fd;
+    bool chardev;
+    uint32_t offset;   // Of the line in its request, for the character devices.
+    std::string edge;  // The edges detected by sysfs.
+  };
+
+  void Run();
+  void Wake();
+  void Push(const Edge& edge);
+  void ReadLineEvents(int fd, const std::map<int, Source>& sources);
+  void ReadValue(int number, const Source& source);
+
+  SpscQueue<Edge> edges_{16384};
+  std::atomic<uint64_t> dropped_{0};
+
+  std::mutex mutex_;
+  std::map<int, Source> sources_;
+  std::vector<int> closing_;  // sysfs descriptors, closed by the thread.
+  bool changed_ = true;
+  bool stop_ = false;
+
+  int wake_fd_ = -1;
+  std::thread thread_;
+};
+
+// The level, edge counts, frequency and pulse widths of a line, from its
+// successive edges.
+struct EdgeStats {
+  void Add(const Edge& edge);
+
+  int level = -1;  // Unknown until the first edge.
+  uint64_t rising = 0;
+  uint64_t falling = 0;
+  double frequency = 0;  // Hz, averaged over the last periods.
+  int64_t high_ns = 0;   // Width of the last high pulse.
+  int64_t low_ns = 0;    // Width of the last low pulse.
+  int64_t last_edge_ns = -1;
+
+ private:
+  int64_t last_rising_ns_ = -1;
+  int64_t last_falling_ns_ = -1;
+  double period_ns_ = 0;
+};
+
+}  // namespace gpio
+}  // namespace hw
+
+#endif /* end of include guard: BEAGLE_CONFIG_HW_GPIO_MONITOR_HPP */
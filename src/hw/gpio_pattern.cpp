@@ -0,0 +1,285 @@
+#include "hw/gpio_pattern.hpp"
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <sstream>
+#include "hw/gpio.hpp"
+#include "hw/gpiochip.hpp"
+#include "log.hpp"
+#include "trace.hpp"
+
+namespace hw {
+namespace gpio {
+
+namespace {
+
+// The thread sleeps between the steps, so it can preempt the threaded
+// interrupt handlers (50) to be on time.
+constexpr int PatternPriority = 60;
+
+// The stack locked for the thread.
+constexpr size_t LockedStack = 64 * 1024;
+
+// The first step is applied after this, for it to be timed like the others.
+constexpr int64_t LeadNs = 1000000;
+
+int64_t MonotonicNs() {
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000000000ll + now.tv_nsec;
+}
+
+// eg. "10ms", "2.5us"
+bool ParseDelay(const std::string& token, std::chrono::nanoseconds* delay) {
+  char* end = nullptr;
+  double value = std::strtod(token.c_str(), &end);
+  std::string unit = end;
+  double scale = 0;
+  if (unit == "ns")
+    scale = 1;
+  else if (unit == "us")
+    scale = 1e3;
+  else if (unit == "ms")
+    scale = 1e6;
+  else if (unit == "s")
+    scale = 1e9;
+  if (end == token.c_str() || !scale || value < 0)
+    return false;
+  *delay = std::chrono::nanoseconds(std::llround(value * scale));
+  return true;
+}
+
+// Lock the pages of the stack the thread may use, faulting them in first.
+bool LockStack() {
+  volatile char stack[LockedStack];
+  for (size_t i = 0; i < sizeof(stack); i += 4096)
+    stack[i] = 0;
+  return mlock(const_cast<char*>(stack), sizeof(stack)) == 0;
+}
+
+}  // namespace
+
+bool ParsePattern(const std::string& text,
+                  std::vector<int>* numbers,
+                  std::vector<Step>* steps,
+                  std::string* error) {
+  numbers->clear();
+  steps->clear();
+  std::string source = text;
+  std::replace(source.begin(), source.end(), '\n', ';');
+  std::replace(source.begin(), source.end(), ',', ' ');
+
+  std::istringstream parts(source);
+  std::string part;
+  while (std::getline(parts, part, ';')) {
+    std::istringstream tokens(part);
+    std::string token;
+    Step step = {0, 0, std::chrono::nanoseconds(-1)};
+    bool empty = true;
+    while (tokens >> token) {
+      empty = false;
+      size_t equal = token.find('=');
+      if (equal == std::string::npos) {
+        if (step.delay.count() >= 0 || !ParseDelay(token, &step.delay)) {
+          *error = "Invalid delay: " + token;
+          return false;
+        }
+        continue;
+      }
+
+      int number = 0;
+      std::string value = token.substr(equal + 1);
+      if (!Resolve(token.substr(0, equal), &number)) {
+        *error = "Unknown line: " + token.substr(0, equal);
+        return false;
+      }
+      if (value != "0" && value != "1") {
+        *error = "Invalid value: " + token;
+        return false;
+      }
+      auto it = std::find(numbers->begin(), numbers->end(), number);
+      size_t index = it - numbers->begin();
+      if (it == numbers->end()) {
+        if (numbers->size() == 64) {
+          *error = "More than 64 lines";
+          return false;
+        }
+        numbers->push_back(number);
+      }
+      step.mask |= 1ull << index;
+      if (value == "1")
+        step.values |= 1ull << index;
+    }
+    if (empty)
+      continue;
+    if (step.delay.count() < 0) {
+      *error = "Missing delay: " + part;
+      return false;
+    }
+    steps->push_back(step);
+  }
+
+  if (steps->empty()) {
+    *error = "Empty pattern";
+    return false;
+  }
+  return true;
+}
+
+PatternPlayer::PatternPlayer(const std::vector<int>& numbers)
+    : numbers_(numbers) {
+  if (numbers_.size() > 64)
+    numbers_.resize(64);
+  // A line not requested would be skipped by the writer, silently.
+  ready_ = Export(numbers_);
+  for (int number : numbers_) {
+    if (Read(number).direction != "out")
+      ready_ &= SetDirection(number, "low");
+  }
+
+  if (CurrentBackend() == Backend::Chardev) {
+    writer_ = std::make_unique<gpiochip::ValueWriter>(numbers_);
+    ready_ &= writer_->lines() == numbers_.size();
+  } else {
+    for (int number : numbers_) {
+      std::string path = Path(number) + "/value";
+      fds_.push_back(open(path.c_str(), O_WRONLY | O_CLOEXEC));
+      ready_ &= fds_.back() >= 0;
+    }
+  }
+  timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+}
+
+PatternPlayer::~PatternPlayer() {
+  Stop();
+  for (int fd : fds_) {
+    if (fd >= 0)
+      close(fd);
+  }
+  if (timer_fd_ >= 0)
+    close(timer_fd_);
+  munlock(this, sizeof(*this));
+}
+
+bool PatternPlayer::Start(std::vector<Step> steps, int repeat) {
+  TRACE_SCOPE("PatternPlayer::Start");
+  if (thread_.joinable() || steps.empty() || timer_fd_ < 0 || !ready_)
+    return false;
+  steps_ = std::move(steps);
+  running_ = true;
+  thread_ = std::thread([this, repeat] { Run(repeat); });
+  return true;
+}
+
+void PatternPlayer::Stop() {
+  stop_ = true;
+  if (thread_.joinable())
+    thread_.join();
+}
+
+Jitter PatternPlayer::jitter() const {
+  auto relaxed = std::memory_order_relaxed;
+  Jitter jitter;
+  jitter.steps = steps_count_.load(std::memory_order_acquire);
+  jitter.min_ns = min_ns_.load(relaxed);
+  jitter.max_ns = max_ns_.load(relaxed);
+  if (jitter.steps)
+    jitter.mean_ns = double(sum_ns_.load(relaxed)) / jitter.steps;
+  jitter.late = late_.load(relaxed);
+  jitter.failed = failed_.load(relaxed);
+  uint64_t count = 0;
+  for (size_t i = 0; i <= kBuckets; ++i) {
+    count += histogram_[i].load(relaxed);
+    if (count * 100 >= jitter.steps * 99) {
+      // Past the histogram, the maximum is the closest bound known.
+      jitter.p99_ns = i < kBuckets ? int64_t(i) * 1000 : jitter.max_ns;
+      break;
+    }
+  }
+  return jitter;
+}
+
+bool PatternPlayer::Write(uint64_t mask, uint64_t values) {
+  if (writer_)
+    return writer_->Write(mask, values);
+
+  bool written = true;
+  for (size_t i = 0; i < fds_.size(); ++i) {
+    if ((mask >> i) & 1)
+      written &= pwrite(fds_[i], (values >> i) & 1 ? "1" : "0", 1, 0) == 1;
+  }
+  return written;
+}
+
+void PatternPlayer::Record(int64_t late_ns) {
+  auto relaxed = std::memory_order_relaxed;
+  uint64_t steps = steps_count_.load(relaxed);
+  if (!steps || late_ns < min_ns_.load(relaxed))
+    min_ns_.store(late_ns, relaxed);
+  if (!steps || late_ns > max_ns_.load(relaxed))
+    max_ns_.store(late_ns, relaxed);
+  Increase(&sum_ns_, late_ns);
+
+  size_t bucket = std::min<int64_t>(std::max<int64_t>(late_ns, 0) / 1000,
+                                    kBuckets);
+  Increase(&histogram_[bucket], uint64_t(1));
+  // Last, for the steps read to not exceed the histogram.
+  steps_count_.store(steps + 1, std::memory_order_release);
+}
+
+void PatternPlayer::Run(int repeat) {
+  trace::SetThreadName("pattern");
+  sched_param param = {};
+  param.sched_priority = PatternPriority;
+  realtime_ = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+  // Lock what the thread touches, rather than all of bb-config.
+  locked_ = LockStack() && mlock(this, sizeof(*this)) == 0 &&
+            mlock(steps_.data(), steps_.size() * sizeof(Step)) == 0;
+  if (!realtime_ || !locked_)
+    LOG_INFO << "Pattern without SCHED_FIFO or locked memory, which take "
+                "CAP_SYS_NICE and CAP_IPC_LOCK";
+
+  int64_t deadline = MonotonicNs() + LeadNs;
+  for (int played = 0; !stop_ && (!repeat || played < repeat); ++played) {
+    for (size_t i = 0; i < steps_.size() && !stop_; ++i) {
+      itimerspec timer = {};
+      timer.it_value.tv_sec = deadline / 1000000000;
+      timer.it_value.tv_nsec = deadline % 1000000000;
+      timerfd_settime(timer_fd_, TFD_TIMER_ABSTIME, &timer, nullptr);
+
+      // Wake up at least every 100ms, to stop.
+      pollfd fd = {timer_fd_, POLLIN, 0};
+      while (!stop_ && poll(&fd, 1, 100) == 0) {
+      }
+      uint64_t expirations;
+      if (stop_ || read(timer_fd_, &expirations, sizeof(expirations)) < 0)
+        break;
+
+      const Step& step = steps_[i];
+      bool written = Write(step.mask, step.values);
+      int64_t applied = MonotonicNs();
+      Record(applied - deadline);
+      deadline += step.delay.count();
+      if (!written)
+        Increase(&failed_, uint64_t(1));
+      if (applied > deadline)
+        Increase(&late_, uint64_t(1));
+    }
+  }
+
+  munlock(steps_.data(), steps_.size() * sizeof(Step));
+  if (writer_)
+    writer_->Sync();
+  running_ = false;
+}
+
+}  // namespace gpio
+}  // namespace hw
@@ -0,0 +1,116 @@
+#ifndef BEAGLE_CONFIG_HW_GPIO_PATTERN_HPP
+#define BEAGLE_CONFIG_HW_GPIO_PATTERN_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace hw {
+namespace gpiochip {
+class ValueWriter;
+}  // namespace gpiochip
+
+namespace gpio {
+
+// Set the lines of |mask| to |values|, then wait |delay| before the next step.
+// Bit i is the line i of the pattern.
+struct Step {
+  uint64_t mask;
+  uint64_t values;
+  std::chrono::nanoseconds delay;
+};
+
+// Parse a pattern, one step per line or separated by ';', as the values of
+// lines followed by the delay, eg.
+//
+//   P9_12=1 P9_15=0 10ms; P9_12=0 500us
+//
+// Lines are given as for Resolve(). Delays take a ns, us, ms or s suffix.
+// Returns false with |error| set if the pattern is invalid.
+bool ParsePattern(const std::string& text,
+                  std::vector<int>* numbers,
+                  std::vector<Step>* steps,
+                  std::string* error);
+
+// How late the steps were applied, after their deadline.
+struct Jitter {
+  uint64_t steps = 0;
+  int64_t min_ns = 0;
+  int64_t max_ns = 0;
+  double mean_ns = 0;
+  int64_t p99_ns = 0;  // To the microsecond, up to 1ms, then the maximum.
+  uint64_t late = 0;  // Steps applied after the deadline of the next one.
+  uint64_t failed = 0;
+};
+
+// Play a pattern on output lines from a SCHED_FIFO thread, woken by a timerfd
+// at the absolute deadline of each step, so that the errors don't accumulate
+// over the steps. The memory the thread touches is locked, not to fault while
+// playing.
+class PatternPlayer {
+ public:
+  // Up to 64 |numbers|, exported and made outputs if they aren't.
+  explicit PatternPlayer(const std::vector<int>& numbers);
+  ~PatternPlayer();
+
+  PatternPlayer(const PatternPlayer&) = delete;
+  PatternPlayer& operator=(const PatternPlayer&) = delete;
+
+  // Play |steps| |repeat| times, or until Stop() if 0. Once only. Fails if
+  // any of the lines couldn't be made an output.
+  bool Start(std::vector<Step> steps, int repeat);
+  void Stop();
+  bool running() const { return running_; }
+
+  Jitter jitter() const;
+  bool realtime() const { return realtime_; }
+  bool locked() const { return locked_; }
+
+ private:
+  // The histogram of the lateness, by microsecond.
+  static constexpr size_t kBuckets = 1000;
+
+  void Run(int repeat);
+  bool Write(uint64_t mask, uint64_t values);
+  void Record(int64_t late_ns);
+  // Add to a counter only the thread writes, without a read-modify-write.
+  template <typename T>
+  static void Increase(std::atomic<T>* counter, T value) {
+    counter->store(counter->load(std::memory_order_relaxed) + value,
+                   std::memory_order_relaxed);
+  }
+
+  std::vector<int> numbers_;
+  std::unique_ptr<gpiochip::ValueWriter> writer_;  // Character devices.
+  std::vector<int> fds_;                           // sysfs value attributes.
+  std::vector<Step> steps_;
+  bool ready_ = false;  // Whether all the lines are outputs to write.
+
+  // Written by the thread only, and read by jitter() without a lock, for the
+  // thread not to wait on a thread of lower priority. The snapshot may mix
+  // two consecutive steps.
+  std::atomic<uint64_t> steps_count_{0};
+  std::atomic<int64_t> min_ns_{0};
+  std::atomic<int64_t> max_ns_{0};
+  std::atomic<int64_t> sum_ns_{0};
+  std::atomic<uint64_t> late_{0};
+  std::atomic<uint64_t> failed_{0};
+  std::array<std::atomic<uint64_t>, kBuckets + 1> histogram_{};
+
+  int timer_fd_ = -1;
+  std::atomic<bool> stop_{false};
+  std::atomic<bool> running_{false};
+  std::atomic<bool> realtime_{false};
+  std::atomic<bool> locked_{false};
+  std::thread thread_;
+};
+
+}  // namespace gpio
+}  // namespace hw
+
+#endif /* end of include guard: BEAGLE_CONFIG_HW_GPIO_PATTERN_HPP */
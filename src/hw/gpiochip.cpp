@@ -0,0 +1,532 @@
+#include "hw/gpiochip.hpp"
+#include <fcntl.h>
+#include <linux/gpio.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include "hw/root.hpp"
+#include "trace.hpp"
+
+namespace hw {
+namespace gpiochip {
+
+namespace {
+
+const char Consumer[] = "bb-config";
+
+constexpr uint64_t DirectionFlags =
+    GPIO_V2_LINE_FLAG_INPUT | GPIO_V2_LINE_FLAG_OUTPUT;
+constexpr uint64_t EdgeFlags =
+    GPIO_V2_LINE_FLAG_EDGE_RISING | GPIO_V2_LINE_FLAG_EDGE_FALLING;
+
+int OpenChip(const std::string& path) {
+  return open(path.c_str(), O_RDWR | O_CLOEXEC);
+}
+
+bool ReadLineInfo(int fd, uint32_t offset, gpio_v2_line_info* info) {
+  std::memset(info, 0, sizeof(*info));
+  info->offset = offset;
+  return ioctl(fd, GPIO_V2_GET_LINEINFO_IOCTL, info) == 0;
+}
+
+std::string EdgeName(uint64_t flags) {
+  switch (flags & EdgeFlags) {
+    case GPIO_V2_LINE_FLAG_EDGE_RISING:
+      return "rising";
+    case GPIO_V2_LINE_FLAG_EDGE_FALLING:
+      return "falling";
+    case EdgeFlags:
+      return "both";
+    default:
+      return "none";
+  }
+}
+
+Line ToLine(const Chip& chip, const gpio_v2_line_info& info) {
+  Line line;
+  line.number = chip.base + info.offset;
+  line.name = info.name;
+  line.consumer = info.consumer;
+  line.used = info.flags & GPIO_V2_LINE_FLAG_USED;
+  line.output = info.flags & GPIO_V2_LINE_FLAG_OUTPUT;
+  line.active_low = info.flags & GPIO_V2_LINE_FLAG_ACTIVE_LOW;
+  line.edge = EdgeName(info.flags);
+  return line;
+}
+
+// The lines requested together, and the configuration they were given. The
+// flags of a line have no direction while it is left as is.
+struct LineRequest {
+  ~LineRequest() {
+    if (fd >= 0)
+      close(fd);
+  }
+
+  int fd = -1;
+  std::vector<uint32_t> offsets;
+  std::vector<uint64_t> flags;
+  std::vector<bool> outputs;  // The directions the lines were requested with.
+  uint64_t values = 0;        // Of the outputs, bit i for offsets[i].
+};
+
+// Build the configuration of |request|. The most common flags are the default,
+// each other set of flags takes an attribute. Returns false when they don't
+// fit in the attributes.
+bool BuildConfig(const LineRequest& request, gpio_v2_line_config* config) {
+  std::memset(config, 0, sizeof(*config));
+  std::map<uint64_t, uint64_t> lines;  // flags -> mask
+  uint64_t outputs = 0;
+  for (size_t i = 0; i < request.flags.size(); ++i) {
+    lines[request.flags[i]] |= 1ull << i;
+    if (request.flags[i] & GPIO_V2_LINE_FLAG_OUTPUT)
+      outputs |= 1ull << i;
+  }
+
+  auto common = std::max_element(
+      lines.begin(), lines.end(), [](const auto& a, const auto& b) {
+        return __builtin_popcountll(a.second) < __builtin_popcountll(b.second);
+      });
+  if (common != lines.end())
+    config->flags = common->first;
+
+  // Keep an attribute for the output values.
+  for (const auto& it : lines) {
+    if (it == *common)
+      continue;
+    if (config->num_attrs + 1 >= GPIO_V2_LINE_NUM_ATTRS_MAX)
+      return false;
+    auto& attribute = config->attrs[config->num_attrs++];
+    attribute.attr.id = GPIO_V2_LINE_ATTR_ID_FLAGS;
+    attribute.attr.flags = it.first;
+    attribute.mask = it.second;
+  }
+
+  if (outputs) {
+    auto& attribute = config->attrs[config->num_attrs++];
+    attribute.attr.id = GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES;
+    attribute.attr.values = request.values & outputs;
+    attribute.mask = outputs;
+  }
+  return true;
+}
+
+// A requested line.
+struct Handle {
+  std::shared_ptr<LineRequest> request;
+  size_t index;
+};
+
+struct OpenedChip {
+  Chip chip;
+  int fd;
+};
+
+// The chips are opened once, and the lines stay requested until exit.
+std::mutex g_mutex;
+bool g_opened = false;
+std::vector<OpenedChip> g_chips;
+std::map<int, Handle> g_lines;
+
+// Requires g_mutex.
+const OpenedChip* FindChip(int number) {
+  if (!g_opened) {
+    g_opened = true;
+    for (auto& chip : FindChips()) {
+      int fd = OpenChip(chip.path);
+      if (fd >= 0)
+        g_chips.push_back({chip, fd});
+    }
+  }
+  for (const auto& it : g_chips) {
+    if (number >= it.chip.base && number < it.chip.base + it.chip.lines)
+      return &it;
+  }
+  return nullptr;
+}
+
+// Requires g_mutex.
+Handle* FindHandle(int number) {
+  auto it = g_lines.find(number);
+  return it == g_lines.end() ? nullptr : &it->second;
+}
+
+// Apply the new |flags| and |value| of a line, or restore them on failure.
+// Requires g_mutex.
+bool Configure(Handle* handle, uint64_t flags, int value) {
+  TRACE_SCOPE("gpiochip::Configure");
+  LineRequest& request = *handle->request;
+  uint64_t bit = 1ull << handle->index;
+  uint64_t old_flags = request.flags[handle->index];
+  uint64_t old_values = request.values;
+  request.flags[handle->index] = flags;
+  request.values = value ? request.values | bit : request.values & ~bit;
+
+  gpio_v2_line_config config;
+  if (BuildConfig(request, &config) &&
+      ioctl(request.fd, GPIO_V2_LINE_SET_CONFIG_IOCTL, &config) == 0) {
+    return true;
+  }
+  request.flags[handle->index] = old_flags;
+  request.values = old_values;
+  return false;
+}
+
+}  // namespace
+
+std::vector<Chip> FindChips() {
+  TRACE_SCOPE("gpiochip::FindChips");
+  std::string directory = Rooted("/dev");
+  std::vector<std::pair<int, Chip>> found;  // index, chip
+  std::error_code error;
+  for (const auto& it :
+       std::filesystem::directory_iterator(directory, error)) {
+    std::string name = it.path().filename();
+    int index = 0;
+    if (std::sscanf(name.c_str(), "gpiochip%d", &index) != 1)
+      continue;
+
+    int fd = OpenChip(it.path());
+    if (fd < 0)
+      continue;
+    gpiochip_info info = {};
+    if (ioctl(fd, GPIO_GET_CHIPINFO_IOCTL, &info) == 0)
+      found.push_back({index, {it.path(), info.label, -1, (int)info.lines}});
+    close(fd);
+  }
+  std::sort(found.begin(), found.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; });
+
+  std::vector<Chip> chips;
+  int next = 0;
+  for (auto& it : found) {
+    Chip& chip = it.second;
+    int first = 0, last = 0;
+    if (std::sscanf(chip.label.c_str(), "gpio-%d-%d", &first, &last) == 2 &&
+        last - first + 1 == chip.lines) {
+      chip.base = first;
+    } else {
+      chip.base = next;
+    }
+    next = std::max(next, chip.base + chip.lines);
+    chips.push_back(chip);
+  }
+  std::sort(chips.begin(), chips.end(),
+            [](const auto& a, const auto& b) { return a.base < b.base; });
+  return chips;
+}
+
+std::vector<Line> ReadLines(const Chip& chip) {
+  TRACE_SCOPE("gpiochip::ReadLines");
+  std::vector<Line> lines;
+  int fd = OpenChip(chip.path);
+  if (fd < 0)
+    return lines;
+  for (int offset = 0; offset < chip.lines; ++offset) {
+    gpio_v2_line_info info;
+    if (ReadLineInfo(fd, offset, &info))
+      lines.push_back(ToLine(chip, info));
+  }
+  close(fd);
+  return lines;
+}
+
+bool ReadLine(int number, Line* line) {
+  std::lock_guard<std::mutex> lock(g_mutex);
+  const OpenedChip* chip = FindChip(number);
+  gpio_v2_line_info info;
+  if (!chip || !ReadLineInfo(chip->fd, number - chip->chip.base, &info))
+    return false;
+  *line = ToLine(chip->chip, info);
+  return true;
+}
+
+bool Request(const std::vector<int>& numbers) {
+  TRACE_SCOPE("gpiochip::Request");
+  std::lock_guard<std::mutex> lock(g_mutex);
+  bool all = true;
+
+  // The lines to request, by chip, and their direction.
+  std::map<const OpenedChip*, std::vector<uint32_t>> offsets;
+  std::map<int, bool> outputs;
+  for (int number : numbers) {
+    if (FindHandle(number))
+      continue;
+    const OpenedChip* chip = FindChip(number);
+    gpio_v2_line_info info;
+    if (!chip || !ReadLineInfo(chip->fd, number - chip->chip.base, &info) ||
+        (info.flags & GPIO_V2_LINE_FLAG_USED)) {
+      all = false;
+      continue;
+    }
+    offsets[chip].push_back(info.offset);
+    outputs[number] = info.flags & GPIO_V2_LINE_FLAG_OUTPUT;
+  }
+
+  for (auto& it : offsets) {
+    const OpenedChip* chip = it.first;
+    auto& lines = it.second;
+    std::sort(lines.begin(), lines.end());
+    lines.erase(std::unique(lines.begin(), lines.end()), lines.end());
+
+    for (size_t begin = 0; begin < lines.size(); begin += GPIO_V2_LINES_MAX) {
+      size_t end = std::min(lines.size(), begin + GPIO_V2_LINES_MAX);
+      auto request = std::make_shared<LineRequest>();
+      request->offsets.assign(lines.begin() + begin, lines.begin() + end);
+      request->flags.resize(request->offsets.size(), 0);
+      for (uint32_t offset : request->offsets)
+        request->outputs.push_back(outputs[chip->chip.base + offset]);
+
+      gpio_v2_line_request line_request = {};
+      std::copy(request->offsets.begin(), request->offsets.end(),
+                line_request.offsets);
+      std::strncpy(line_request.consumer, Consumer,
+                   sizeof(line_request.consumer) - 1);
+      line_request.num_lines = request->offsets.size();
+      BuildConfig(*request, &line_request.config);
+      if (ioctl(chip->fd, GPIO_V2_GET_LINE_IOCTL, &line_request) != 0) {
+        all = false;
+        continue;
+      }
+
+      request->fd = line_request.fd;
+      for (size_t i = 0; i < request->offsets.size(); ++i)
+        g_lines[chip->chip.base + request->offsets[i]] = {request, i};
+    }
+  }
+  return all;
+}
+
+void ReleaseAll() {
+  std::lock_guard<std::mutex> lock(g_mutex);
+  g_lines.clear();
+}
+
+bool GetValue(int number, int* value) {
+  std::lock_guard<std::mutex> lock(g_mutex);
+  Handle* handle = FindHandle(number);
+  if (!handle)
+    return false;
+  gpio_v2_line_values values = {};
+  values.mask = 1ull << handle->index;
+  if (ioctl(handle->request->fd, GPIO_V2_LINE_GET_VALUES_IOCTL, &values))
+    return false;
+  *value = (values.bits & values.mask) ? 1 : 0;
+  return true;
+}
+
+std::vector<LineState> Snapshot(const std::vector<int>& numbers) {
+  TRACE_SCOPE("gpiochip::Snapshot");
+  std::lock_guard<std::mutex> lock(g_mutex);
+
+  // The lines to read, by request.
+  std::map<LineRequest*, uint64_t> masks;
+  for (int number : numbers) {
+    Handle* handle = FindHandle(number);
+    if (handle)
+      masks[handle->request.get()] |= 1ull << handle->index;
+  }
+  std::map<LineRequest*, uint64_t> bits;
+  for (const auto& it : masks) {
+    gpio_v2_line_values values = {};
+    values.mask = it.second;
+    if (ioctl(it.first->fd, GPIO_V2_LINE_GET_VALUES_IOCTL, &values) == 0)
+      bits[it.first] = values.bits;
+  }
+
+  // The configuration of the lines is the one they were requested with, then
+  // the one bb-config gave them.
+  std::vector<LineState> states;
+  for (int number : numbers) {
+    Handle* handle = FindHandle(number);
+    if (!handle || !bits.count(handle->request.get()))
+      continue;
+    const LineRequest& request = *handle->request;
+    uint64_t flags = request.flags[handle->index];
+    LineState state;
+    state.number = number;
+    state.output = request.outputs[handle->index];
+    if (flags & DirectionFlags)
+      state.output = flags & GPIO_V2_LINE_FLAG_OUTPUT;
+    state.active_low = flags & GPIO_V2_LINE_FLAG_ACTIVE_LOW;
+    state.edge = EdgeName(flags);
+    state.value = (bits[handle->request.get()] >> handle->index) & 1;
+    states.push_back(state);
+  }
+  return states;
+}
+
+bool SetValue(int number, int value) {
+  TRACE_SCOPE("gpiochip::SetValue");
+  std::lock_guard<std::mutex> lock(g_mutex);
+  Handle* handle = FindHandle(number);
+  if (!handle)
+    return false;
+  gpio_v2_line_values values = {};
+  values.mask = 1ull << handle->index;
+  values.bits = value ? values.mask : 0;
+  if (ioctl(handle->request->fd, GPIO_V2_LINE_SET_VALUES_IOCTL, &values))
+    return false;
+  LineRequest& request = *handle->request;
+  request.values = (request.values & ~values.mask) | values.bits;
+  return true;
+}
+
+bool SetDirection(int number, bool output, int value) {
+  std::lock_guard<std::mutex> lock(g_mutex);
+  Handle* handle = FindHandle(number);
+  if (!handle)
+    return false;
+  uint64_t flags = handle->request->flags[handle->index] & ~DirectionFlags;
+  if (output)
+    flags = (flags & ~EdgeFlags) | GPIO_V2_LINE_FLAG_OUTPUT;
+  else
+    flags |= GPIO_V2_LINE_FLAG_INPUT;
+  return Configure(handle, flags, value);
+}
+
+bool SetEdge(int number, const std::string& edge) {
+  std::lock_guard<std::mutex> lock(g_mutex);
+  Handle* handle = FindHandle(number);
+  if (!handle)
+    return false;
+
+  uint64_t edges = 0;
+  if (edge == "rising")
+    edges = GPIO_V2_LINE_FLAG_EDGE_RISING;
+  else if (edge == "falling")
+    edges = GPIO_V2_LINE_FLAG_EDGE_FALLING;
+  else if (edge == "both")
+    edges = EdgeFlags;
+  else if (edge != "none")
+    return false;
+
+  // As with sysfs, only inputs detect edges.
+  const LineRequest& request = *handle->request;
+  uint64_t flags = request.flags[handle->index];
+  const OpenedChip* chip = FindChip(number);
+  gpio_v2_line_info info;
+  if (!chip || !ReadLineInfo(chip->fd, number - chip->chip.base, &info) ||
+      (info.flags & GPIO_V2_LINE_FLAG_OUTPUT)) {
+    return false;
+  }
+  flags = (flags & ~(DirectionFlags | EdgeFlags)) | GPIO_V2_LINE_FLAG_INPUT |
+          edges;
+  return Configure(handle, flags, 0);
+}
+
+bool SetActiveLow(int number, bool active_low) {
+  std::lock_guard<std::mutex> lock(g_mutex);
+  Handle* handle = FindHandle(number);
+  if (!handle)
+    return false;
+  const LineRequest& request = *handle->request;
+  uint64_t flags = request.flags[handle->index] & ~GPIO_V2_LINE_FLAG_ACTIVE_LOW;
+  if (active_low)
+    flags |= GPIO_V2_LINE_FLAG_ACTIVE_LOW;
+  int value = (request.values >> handle->index) & 1;
+  return Configure(handle, flags, value);
+}
+
+ValueReader::ValueReader(const std::vector<int>& numbers) {
+  std::lock_guard<std::mutex> lock(g_mutex);
+  std::map<LineRequest*, size_t> groups;  // -> index in groups_
+  for (size_t i = 0; i < numbers.size() && i < 64; ++i) {
+    Handle* handle = FindHandle(numbers[i]);
+    if (!handle)
+      continue;
+    auto it = groups.find(handle->request.get());
+    if (it == groups.end()) {
+      it = groups.emplace(handle->request.get(), groups_.size()).first;
+      groups_.push_back({handle->request, handle->request->fd, 0, {}});
+    }
+    Group& group = groups_[it->second];
+    group.mask |= 1ull << handle->index;
+    group.bits.push_back({handle->index, i});
+  }
+}
+
+bool ValueReader::Read(uint64_t* bits) const {
+  uint64_t result = 0;
+  for (const auto& group : groups_) {
+    gpio_v2_line_values values = {};
+    values.mask = group.mask;
+    if (ioctl(group.fd, GPIO_V2_LINE_GET_VALUES_IOCTL, &values))
+      return false;
+    for (const auto& bit : group.bits)
+      result |= ((values.bits >> bit.first) & 1) << bit.second;
+  }
+  *bits = result;
+  return true;
+}
+
+ValueWriter::ValueWriter(const std::vector<int>& numbers) {
+  std::lock_guard<std::mutex> lock(g_mutex);
+  std::map<LineRequest*, size_t> groups;  // -> index in groups_
+  for (size_t i = 0; i < numbers.size() && i < 64; ++i) {
+    Handle* handle = FindHandle(numbers[i]);
+    if (!handle)
+      continue;
+    auto it = groups.find(handle->request.get());
+    if (it == groups.end()) {
+      it = groups.emplace(handle->request.get(), groups_.size()).first;
+      groups_.push_back({handle->request, handle->request->fd, {}});
+    }
+    groups_[it->second].bits.push_back({handle->index, i});
+    lines_++;
+  }
+}
+
+bool ValueWriter::Write(uint64_t mask, uint64_t bits) {
+  bool written = true;
+  for (const auto& group : groups_) {
+    gpio_v2_line_values values = {};
+    for (const auto& bit : group.bits) {
+      if (!((mask >> bit.second) & 1))
+        continue;
+      values.mask |= 1ull << bit.first;
+      values.bits |= ((bits >> bit.second) & 1) << bit.first;
+    }
+    if (values.mask &&
+        ioctl(group.fd, GPIO_V2_LINE_SET_VALUES_IOCTL, &values) != 0) {
+      written = false;
+    }
+  }
+  mask_ |= mask;
+  bits_ = (bits_ & ~mask) | (bits & mask);
+  return written;
+}
+
+void ValueWriter::Sync() {
+  std::lock_guard<std::mutex> lock(g_mutex);
+  for (const auto& group : groups_) {
+    auto& request = *static_cast<LineRequest*>(group.request.get());
+    for (const auto& bit : group.bits) {
+      if (!((mask_ >> bit.second) & 1))
+        continue;
+      uint64_t flag = 1ull << bit.first;
+      if ((bits_ >> bit.second) & 1)
+        request.values |= flag;
+      else
+        request.values &= ~flag;
+    }
+  }
+}
+
+bool EventSource(int number, int* fd, uint32_t* offset) {
+  std::lock_guard<std::mutex> lock(g_mutex);
+  Handle* handle = FindHandle(number);
+  if (!handle)
+    return false;
+  *fd = handle->request->fd;
+  *offset = handle->request->offsets[handle->index];
+  return true;
+}
+
+}  // namespace gpiochip
+}  // namespace hw
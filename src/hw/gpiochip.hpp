@@ -0,0 +1,139 @@
+#ifndef BEAGLE_CONFIG_HW_GPIOCHIP_HPP
+#define BEAGLE_CONFIG_HW_GPIOCHIP_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// GPIO lines through the character devices /dev/gpiochipN, with the v2 uAPI of
+// <linux/gpio.h>. Unlike sysfs, it needs neither gpioinfo nor a kernel built
+// with CONFIG_GPIO_SYSFS. However, a line keeps its settings only while it is
+// requested: the lines are released when bb-config exits.
+//
+// Lines are numbered as in sysfs, from the base of their chip. The base is
+// parsed from the label of the chip, eg. gpio-32-63, and otherwise follows the
+// lines of the previous chips.
+namespace hw {
+namespace gpiochip {
+
+struct Chip {
+  std::string path;   // eg. /dev/gpiochip1
+  std::string label;  // eg. gpio-32-63
+  int base;
+  int lines;
+};
+
+struct Line {
+  int number;
+  std::string name;  // eg. "P9_12 [gpio1_28]", may be empty.
+  std::string consumer;
+  bool used;  // Requested by the kernel, another process or bb-config.
+  bool output;
+  bool active_low;
+  std::string edge;  // "none", "rising", "falling" or "both".
+};
+
+// The chips of the board, by increasing base.
+std::vector<Chip> FindChips();
+
+// The information of all the lines of |chip|.
+std::vector<Line> ReadLines(const Chip& chip);
+
+// The information of the line |number|.
+bool ReadLine(int number, Line* line);
+
+// Request |numbers|, with a single request per chip for those not requested
+// yet. Their configuration is left as is. Lines used elsewhere are skipped.
+// Returns whether all of them are requested.
+bool Request(const std::vector<int>& numbers);
+
+// Release all the requested lines.
+void ReleaseAll();
+
+// The configuration and value of a requested line.
+struct LineState {
+  int number;
+  bool output;
+  bool active_low;
+  std::string edge;
+  int value;  // Logical.
+};
+
+// The state of the requested lines among |numbers|, with a single
+// GPIO_V2_LINE_GET_VALUES per request, ie. per chip, and no other access to
+// the chips: a requested line keeps the configuration given by bb-config.
+std::vector<LineState> Snapshot(const std::vector<int>& numbers);
+
+// The operations below apply to requested lines only. Values are logical, ie.
+// inverted for active low lines.
+bool GetValue(int number, int* value);
+bool SetValue(int number, int value);
+bool SetDirection(int number, bool output, int value);
+bool SetEdge(int number, const std::string& edge);
+bool SetActiveLow(int number, bool active_low);
+
+// Read the values of requested lines repeatedly, eg. to sample them: a single
+// GPIO_V2_LINE_GET_VALUES per request, ie. per chip, without taking any lock.
+// The requests are kept open until it is destroyed.
+class ValueReader {
+ public:
+  // Up to 64 |numbers|. Lines not requested read as 0.
+  explicit ValueReader(const std::vector<int>& numbers);
+
+  // Bit i of |bits| is the logical value of numbers[i].
+  bool Read(uint64_t* bits) const;
+
+ private:
+  struct Group {
+    std::shared_ptr<const void> request;
+    int fd;
+    uint64_t mask;
+    std::vector<std::pair<int, int>> bits;  // In the request, in the result.
+  };
+  std::vector<Group> groups_;
+};
+
+// Set the values of requested output lines repeatedly, eg. to play a pattern
+// or drive a bus: a single GPIO_V2_LINE_SET_VALUES per request, ie. per chip,
+// without taking any lock. Call Sync() once done, for the configuration of the
+// lines to keep the values.
+class ValueWriter {
+ public:
+  // Up to 64 |numbers|. Lines not requested are ignored.
+  explicit ValueWriter(const std::vector<int>& numbers);
+
+  // Set the lines i of |mask| to bit i of |bits|, logically.
+  bool Write(uint64_t mask, uint64_t bits);
+
+  // Record the last values written.
+  void Sync();
+
+  // The GPIO_V2_LINE_SET_VALUES per Write(), ie. the chips of the lines. Only
+  // the lines of a chip change at once.
+  size_t requests() const { return groups_.size(); }
+  // The lines requested, written to.
+  size_t lines() const { return lines_; }
+
+ private:
+  struct Group {
+    std::shared_ptr<void> request;
+    int fd;
+    std::vector<std::pair<int, int>> bits;  // In the request, in the input.
+  };
+  std::vector<Group> groups_;
+  size_t lines_ = 0;
+  uint64_t mask_ = 0;  // Of the values written.
+  uint64_t bits_ = 0;
+};
+
+// The file descriptor delivering the edge events of |number|, as struct
+// gpio_v2_line_event for its |offset|. It is shared by the lines requested
+// together, and stays open until ReleaseAll().
+bool EventSource(int number, int* fd, uint32_t* offset);
+
+}  // namespace gpiochip
+}  // namespace hw
+
+#endif /* end of include guard: BEAGLE_CONFIG_HW_GPIOCHIP_HPP */
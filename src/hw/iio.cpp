@@ -0,0 +1,218 @@
+#include "hw/iio.hpp"
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include "hw/root.hpp"
+#include "hw/sysfs.hpp"
+#include "log.hpp"
+#include "trace.hpp"
+
+namespace hw {
+namespace iio {
+
+namespace {
+
+// The scans the device buffers, about 20ms at the rate of the AM335x ADC.
+constexpr int BufferLength = 4096;
+
+// The scans the device waits for before waking the thread up, for it to read
+// in chunks rather than scan by scan.
+constexpr int Watermark = 256;
+
+int64_t MonotonicNs() {
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000000000ll + now.tv_nsec;
+}
+
+}  // namespace
+
+bool ParseScanType(const std::string& text, ScanType* type) {
+  char endian = 0, sign = 0;
+  int bits = 0, storage_bits = 0, shift = 0;
+  if (std::sscanf(text.c_str(), "%ce:%c%d/%d>>%d", &endian, &sign, &bits,
+                  &storage_bits, &shift) != 5) {
+    return false;
+  }
+  if ((endian != 'b' && endian != 'l') || (sign != 's' && sign != 'u') ||
+      (storage_bits != 8 && storage_bits != 16 && storage_bits != 32 &&
+       storage_bits != 64) ||
+      bits <= 0 || bits + shift > storage_bits) {
+    return false;
+  }
+  type->big_endian = endian == 'b';
+  type->is_signed = sign == 's';
+  type->bits = bits;
+  type->storage_bits = storage_bits;
+  type->shift = shift;
+  return true;
+}
+
+Stream::Stream(const std::string& device,
+               const std::vector<std::string>& channels)
+    : device_(device), channels_(channels) {
+  if (channels_.size() > MaxChannels)
+    channels_.resize(MaxChannels);
+}
+
+Stream::~Stream() {
+  Stop();
+}
+
+bool Stream::Enable(bool enable) {
+  return Write(device_ + "/buffer/enable", enable ? "1" : "0");
+}
+
+bool Stream::Start(std::string* error) {
+  TRACE_SCOPE("iio::Stream::Start");
+  if (thread_.joinable() || channels_.empty())
+    return false;
+  if (!std::filesystem::exists(device_ + "/buffer/enable")) {
+    *error = "The device has no buffer";
+    return false;
+  }
+  Enable(false);
+
+  // The scans hold the channels enabled only, by increasing index.
+  std::string elements = device_ + "/scan_elements";
+  std::error_code ignored;
+  for (const auto& it :
+       std::filesystem::directory_iterator(elements, ignored)) {
+    std::string name = it.path().filename();
+    if (name.size() > 3 && !name.compare(name.size() - 3, 3, "_en"))
+      Write(it.path(), "0");
+  }
+
+  std::vector<std::pair<long long, size_t>> order;
+  elements_.assign(channels_.size(), {});
+  for (size_t i = 0; i < channels_.size(); ++i) {
+    std::string prefix = elements + "/in_" + channels_[i];
+    long long index = 0;
+    std::string type;
+    if (!ReadInt(prefix + "_index", &index) ||
+        !ReadLine(prefix + "_type", &type) ||
+        !ParseScanType(type, &elements_[i].type) ||
+        !Write(prefix + "_en", "1")) {
+      *error = "Cannot enable " + channels_[i] + " in the scans";
+      return false;
+    }
+    order.emplace_back(index, i);
+  }
+  std::sort(order.begin(), order.end());
+  // Each value is aligned to its size, and the scan to its largest value.
+  size_t offset = 0, alignment = 1;
+  for (const auto& it : order) {
+    Element& element = elements_[it.second];
+    size_t size = element.type.storage_bits / 8;
+    offset = (offset + size - 1) / size * size;
+    element.offset = offset;
+    offset += size;
+    alignment = std::max(alignment, size);
+  }
+  scan_size_ = (offset + alignment - 1) / alignment * alignment;
+
+  Write(device_ + "/buffer/length", std::to_string(BufferLength));
+  if (std::filesystem::exists(device_ + "/buffer/watermark"))
+    Write(device_ + "/buffer/watermark", std::to_string(Watermark));
+  if (!Enable(true)) {
+    *error = "Cannot enable the buffer, it may need a trigger in "
+             "trigger/current_trigger";
+    return false;
+  }
+
+  std::string name = std::filesystem::path(device_).filename();
+  fd_ = open(Rooted("/dev/" + name).c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+  if (fd_ < 0) {
+    *error = "Cannot open /dev/" + name;
+    Enable(false);
+    return false;
+  }
+
+  stop_ = false;
+  running_ = true;
+  thread_ = std::thread([this] { Run(); });
+  return true;
+}
+
+void Stream::Stop() {
+  stop_ = true;
+  if (thread_.joinable())
+    thread_.join();
+  if (fd_ < 0)
+    return;
+  close(fd_);
+  fd_ = -1;
+  Enable(false);
+}
+
+int32_t Stream::Decode(const uint8_t* scan, const Element& element) const {
+  const ScanType& type = element.type;
+  const uint8_t* bytes = scan + element.offset;
+  size_t size = type.storage_bits / 8;
+  uint64_t raw = 0;
+  for (size_t i = 0; i < size; ++i) {
+    if (type.big_endian)
+      raw = raw << 8 | bytes[i];
+    else
+      raw |= uint64_t(bytes[i]) << (8 * i);
+  }
+  raw >>= type.shift;
+  if (type.bits < 64)
+    raw &= (1ull << type.bits) - 1;
+  if (type.is_signed && type.bits < 64 && (raw >> (type.bits - 1)) & 1)
+    raw |= ~0ull << type.bits;
+  return static_cast<int32_t>(static_cast<int64_t>(raw));
+}
+
+void Stream::Run() {
+  trace::SetThreadName("iio stream");
+  // Large enough for the whole buffer of the device, and whole scans.
+  std::vector<uint8_t> buffer(BufferLength * scan_size_);
+  size_t pending = 0;  // Bytes of an incomplete scan.
+  int64_t start = MonotonicNs();
+  pollfd fd = {fd_, POLLIN, 0};
+
+  while (!stop_) {
+    int ready = poll(&fd, 1, 100);
+    if (ready < 0 && errno != EINTR)
+      break;
+    if (ready <= 0)
+      continue;
+    ssize_t size =
+        read(fd_, buffer.data() + pending, buffer.size() - pending);
+    if (size < 0) {
+      if (errno == EAGAIN || errno == EINTR)
+        continue;
+      LOG_WARNING << "Failed to read " << device_ << ": " << errno;
+      break;
+    }
+
+    TRACE_SCOPE("iio::Stream::Decode");
+    size_t available = pending + size;
+    size_t count = available / scan_size_;
+    if (count >= size_t(BufferLength))
+      overruns_++;
+    for (size_t i = 0; i < count; ++i) {
+      const uint8_t* bytes = buffer.data() + i * scan_size_;
+      Scan scan = {};
+      for (size_t channel = 0; channel < elements_.size(); ++channel)
+        scan.values[channel] = Decode(bytes, elements_[channel]);
+      if (!scans_.Push(scan))
+        dropped_++;
+    }
+    pending = available - count * scan_size_;
+    std::copy(buffer.begin() + count * scan_size_,
+              buffer.begin() + available, buffer.begin());
+    count_ += count;
+    elapsed_ns_ = MonotonicNs() - start;
+  }
+  running_ = false;
+}
+
+}  // namespace iio
+}  // namespace hw
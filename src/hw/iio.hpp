@@ -0,0 +1,96 @@
+#ifndef BEAGLE_CONFIG_HW_IIO_HPP
+#define BEAGLE_CONFIG_HW_IIO_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#include "spsc_queue.hpp"
+
+// IIO devices, eg. the ADC of the AM335x, streamed through their buffer: the
+// channels enabled in scan_elements/ are sampled together into scans, read in
+// chunks from /dev/iio:deviceN.
+namespace hw {
+namespace iio {
+
+// The format of a channel in the scans, from scan_elements/in_<channel>_type,
+// eg. "le:u12/16>>0".
+struct ScanType {
+  bool big_endian = false;
+  bool is_signed = false;
+  int bits = 0;          // Significant.
+  int storage_bits = 0;  // 8, 16, 32 or 64.
+  int shift = 0;
+};
+
+bool ParseScanType(const std::string& text, ScanType* type);
+
+// The channels of a stream.
+constexpr size_t MaxChannels = 8;
+
+// The values of the channels of a stream, sampled together, in the order of
+// the channels given to the stream.
+struct Scan {
+  int32_t values[MaxChannels];
+};
+
+// Stream channels of a device from a thread, to a preallocated queue the UI
+// drains. The device samples on its own, as the AM335x ADC in continuous mode,
+// or from the trigger set in its trigger/current_trigger.
+class Stream {
+ public:
+  // |device| eg. /sys/bus/iio/devices/iio:device0, |channels| eg. "voltage0",
+  // up to MaxChannels.
+  Stream(const std::string& device, const std::vector<std::string>& channels);
+  ~Stream();
+
+  Stream(const Stream&) = delete;
+  Stream& operator=(const Stream&) = delete;
+
+  // Enable the buffer with the channels only. Returns false with |error| set
+  // if the device has no buffer or refuses to enable it.
+  bool Start(std::string* error);
+  void Stop();
+  bool running() const { return running_; }
+
+  // Pop the oldest scan not consumed yet. Consumer side.
+  bool Pop(Scan* scan) { return scans_.Pop(scan); }
+
+  uint64_t scans() const { return count_; }
+  int64_t elapsed_ns() const { return elapsed_ns_; }
+  // The reads that found the buffer of the device full: it lost scans since.
+  uint64_t overruns() const { return overruns_; }
+  // The scans lost because the consumer didn't keep up.
+  uint64_t dropped() const { return dropped_; }
+
+ private:
+  struct Element {
+    size_t offset;  // In the scan, in bytes.
+    ScanType type;
+  };
+
+  void Run();
+  int32_t Decode(const uint8_t* scan, const Element& element) const;
+  bool Enable(bool enable);
+
+  std::string device_;
+  std::vector<std::string> channels_;
+  std::vector<Element> elements_;  // Of channels_.
+  size_t scan_size_ = 0;
+  int fd_ = -1;
+
+  SpscQueue<Scan> scans_{1 << 16};
+  std::atomic<uint64_t> count_{0};
+  std::atomic<int64_t> elapsed_ns_{0};
+  std::atomic<uint64_t> overruns_{0};
+  std::atomic<uint64_t> dropped_{0};
+  std::atomic<bool> stop_{false};
+  std::atomic<bool> running_{false};
+  std::thread thread_;
+};
+
+}  // namespace iio
+}  // namespace hw
+
+#endif /* end of include guard: BEAGLE_CONFIG_HW_IIO_HPP */
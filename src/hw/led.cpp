@@ -0,0 +1,88 @@
+#include "hw/led.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <sstream>
+#include "hw/root.hpp"
+#include "hw/sysfs.hpp"
+#include "trace.hpp"
+
+namespace hw {
+namespace led {
+
+namespace {
+std::string LedsPath() {
+  return Rooted("/sys/class/leds/");
+}
+}  // namespace
+
+std::vector<std::string> FindLEDs() {
+  std::vector<std::string> names;
+  if (!std::filesystem::exists(LedsPath()))
+    return names;
+
+  for (const auto& it : std::filesystem::directory_iterator(LedsPath()))
+    names.push_back(it.path().filename());
+  std::sort(names.begin(), names.end());
+  return names;
+}
+
+bool Resolve(const std::string& name, std::string* led) {
+  for (const auto& it : FindLEDs()) {
+    auto colon = it.rfind(':');
+    bool suffix = colon != std::string::npos && it.substr(colon + 1) == name;
+    if (it == name || suffix) {
+      *led = it;
+      return true;
+    }
+  }
+  return false;
+}
+
+State Read(const std::string& led) {
+  TRACE_SCOPE("led::Read");
+  State state;
+  long long brightness = 0;
+  if (ReadInt(LedsPath() + led + "/brightness", &brightness))
+    state.brightness = brightness;
+
+  std::string trigger;
+  ReadLine(LedsPath() + led + "/trigger", &trigger);
+
+  std::string entry;
+  std::stringstream ss(trigger);
+  while (std::getline(ss, entry, ' ')) {
+    if (entry.empty())
+      continue;
+    if (entry.front() == '[')
+      state.trigger_selected = state.triggers.size();
+    state.triggers.push_back(entry);
+  }
+
+  size_t left = trigger.find('[');
+  size_t right = trigger.find(']');
+  if (left < right && left != std::string::npos && right != std::string::npos)
+    state.trigger = trigger.substr(left + 1, right - left - 1);
+  // A plain file, eg. of a fixture, holds the trigger last written.
+  else if (state.triggers.size() == 1)
+    state.trigger = state.triggers[0];
+  return state;
+}
+
+bool SetBrightness(const std::string& led, int brightness) {
+  return Write(LedsPath() + led + "/brightness", std::to_string(brightness));
+}
+
+bool SetTrigger(const std::string& led, const std::string& trigger) {
+  return Write(LedsPath() + led + "/trigger", trigger);
+}
+
+bool SetTimer(const std::string& led, int delay_on, int delay_off) {
+  // delay_on and delay_off only exist once the timer trigger is active.
+  bool ok = SetTrigger(led, "timer");
+  ok &= Write(LedsPath() + led + "/delay_on", std::to_string(delay_on));
+  ok &= Write(LedsPath() + led + "/delay_off", std::to_string(delay_off));
+  return ok;
+}
+
+}  // namespace led
+}  // namespace hw
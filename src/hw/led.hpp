@@ -0,0 +1,38 @@
+#ifndef BEAGLE_CONFIG_HW_LED_HPP
+#define BEAGLE_CONFIG_HW_LED_HPP
+
+#include <string>
+#include <vector>
+
+// LEDs of /sys/class/leds.
+namespace hw {
+namespace led {
+
+struct State {
+  int brightness = 0;
+  // The triggers as listed by sysfs. The active one is within brackets.
+  std::vector<std::string> triggers;
+  int trigger_selected = 0;
+  // The active trigger, or "error".
+  std::string trigger = "error";
+};
+
+// List the LEDs, eg. "beaglebone:green:usr0", sorted by name.
+std::vector<std::string> FindLEDs();
+
+// Resolve a name given by the user: either a full name, or its last part after
+// ':', eg. "usr0".
+bool Resolve(const std::string& name, std::string* led);
+
+State Read(const std::string& led);
+
+bool SetBrightness(const std::string& led, int brightness);
+bool SetTrigger(const std::string& led, const std::string& trigger);
+
+// Blink with the "timer" trigger. Delays are in milliseconds.
+bool SetTimer(const std::string& led, int delay_on, int delay_off);
+
+}  // namespace led
+}  // namespace hw
+
+#endif /* end of include guard: BEAGLE_CONFIG_HW_LED_HPP */
@@ -0,0 +1,132 @@
+#include "hw/pinmux.hpp"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include "hw/root.hpp"
+#include "hw/sysfs.hpp"
+#include "trace.hpp"
+
+namespace hw {
+namespace pinmux {
+
+namespace {
+
+std::string PinConfigPath() {
+  return Rooted("/sys/devices/platform/ocp");
+}
+
+std::string DeviceNamePath() {
+  return Rooted("/proc/device-tree/model");
+}
+
+// Where pin_info files are searched: next to the sources when running from the
+// build directory, then where they are installed.
+const char* const PinInfoDirectories[] = {
+    "../src/ui/panel/pinmux/",
+    "/usr/share/bb-config/",
+};
+
+}  // namespace
+
+std::string BoardModel() {
+  std::string model;
+  ReadLine(DeviceNamePath(), &model);
+  // The device tree strings are NUL terminated.
+  model.erase(std::find(model.begin(), model.end(), '\0'), model.end());
+  return model;
+}
+
+Headers ParsePinInfo(std::istream& in, const std::string& first_header) {
+  TRACE_SCOPE("pinmux::ParsePinInfo");
+  Headers headers;
+  std::string file_line;
+
+  while (getline(in, file_line)) {
+    if (file_line.compare("") == 0)
+      continue;
+
+    std::string head, tail, info, func, last;
+
+    PinDetail temp_pin;
+
+    do {
+      std::stringstream str(file_line);
+      getline(str, head, '_');
+      getline(str, tail, '_');
+      getline(str, last, '_');
+      std::stringstream str2(last);
+      getline(str2, info, '=');
+      std::stringstream str3(file_line);
+      while (str3.good()) {
+        getline(str3, func, '=');
+      }
+
+      temp_pin.header = head + "_" + tail;
+      func = func.substr(1, func.size() - 2);
+      if (!info.compare("INFO")) {
+        temp_pin.info = func;
+      } else if (!info.compare("PIN")) {
+        temp_pin.name = func;
+      } else if (!info.compare("PRU")) {
+        temp_pin.pru = func;
+      } else if (!info.compare("GPIO")) {
+        temp_pin.gpio = func;
+      } else if (!info.compare("PINMUX")) {
+        temp_pin.pinmux = func;
+      } else if (!info.compare("CAPE")) {
+        if (!head.compare(first_header)) {
+          headers.p1_p8.push_back(temp_pin);
+        } else {
+          headers.p2_p9.push_back(temp_pin);
+        }
+
+        break;
+      }
+    } while (getline(in, file_line));
+  }
+
+  return headers;
+}
+
+Headers LoadPins(const std::string& model) {
+  bool pocket = !model.compare(PocketName);
+  std::string file_name = pocket ? "pin_info_pocket" : "pin_info";
+  for (const char* directory : PinInfoDirectories) {
+    std::ifstream file(directory + file_name);
+    if (file.is_open())
+      return ParsePinInfo(file, pocket ? "P1" : "P8");
+  }
+  return {};
+}
+
+bool FindPin(const Headers& headers,
+             const std::string& header,
+             PinDetail* pin) {
+  std::string name = header;
+  std::replace(name.begin(), name.end(), '.', '_');
+  std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+  for (const auto* pins : {&headers.p1_p8, &headers.p2_p9}) {
+    for (const auto& it : *pins) {
+      if (it.header == name) {
+        *pin = it;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+std::string StatePath(const std::string& header) {
+  return PinConfigPath() + "/ocp:" + header + "_pinmux/state";
+}
+
+bool GetState(const std::string& header, std::string* state) {
+  return ReadLine(StatePath(header), state);
+}
+
+bool SetState(const std::string& header, const std::string& state) {
+  return Write(StatePath(header), state);
+}
+
+}  // namespace pinmux
+}  // namespace hw
@@ -0,0 +1,58 @@
+#ifndef BEAGLE_CONFIG_HW_PINMUX_HPP
+#define BEAGLE_CONFIG_HW_PINMUX_HPP
+
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace hw {
+namespace pinmux {
+
+const std::string PocketName = "TI AM335x PocketBeagle";
+const std::string BlackName = "TI AM335x BeagleBone Black";
+const std::string BlueName = "TI AM335x BeagleBone Blue";
+const std::string AI_Name = "BeagleBoard.org BeagleBone AI";
+
+struct PinDetail {
+  std::string header;        // eg. P9_22
+  std::string name;          // eg. gpio
+  std::string info;          // Pin info
+  std::string pru;           // Pru pin
+  std::string gpio;          // gpio pin
+  std::string pinmux;        // List of Pinmux which can config
+  std::string pinmux_value;  // Pinmux Current mode
+  bool config = false;       // Support PINMUX
+};
+
+// The pins of the two expansion headers of a board: P1/P2 on the
+// PocketBeagle, P8/P9 otherwise.
+struct Headers {
+  std::vector<PinDetail> p1_p8;
+  std::vector<PinDetail> p2_p9;
+};
+
+// Returns the model from the device tree, eg. "TI AM335x BeagleBone Black".
+std::string BoardModel();
+
+// Parse a pin_info file. Pins whose header is |first_header| go to p1_p8.
+Headers ParsePinInfo(std::istream& in, const std::string& first_header);
+
+// Load the pin_info file matching the board |model|.
+Headers LoadPins(const std::string& model);
+
+// Look up a pin by header name, eg. "P9_12" or "P9.12".
+bool FindPin(const Headers& headers,
+             const std::string& header,
+             PinDetail* pin);
+
+// Path of the pinmux state of a pin, eg.
+// /sys/devices/platform/ocp/ocp:P9_12_pinmux/state
+std::string StatePath(const std::string& header);
+
+bool GetState(const std::string& header, std::string* state);
+bool SetState(const std::string& header, const std::string& state);
+
+}  // namespace pinmux
+}  // namespace hw
+
+#endif /* end of include guard: BEAGLE_CONFIG_HW_PINMUX_HPP */
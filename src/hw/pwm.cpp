@@ -0,0 +1,144 @@
+#include "hw/pwm.hpp"
+#include <cstdlib>
+#include <filesystem>
+#include "hw/root.hpp"
+#include "hw/sysfs.hpp"
+#include "trace.hpp"
+
+namespace hw {
+namespace pwm {
+
+namespace {
+std::string PwmPath() {
+  return Rooted("/sys/class/pwm/");
+}
+}  // namespace
+
+std::vector<std::string> FindPWMs() {
+  std::vector<std::string> names;
+  if (!std::filesystem::exists(PwmPath()))
+    return names;
+
+  for (const auto& it : std::filesystem::directory_iterator(PwmPath())) {
+    std::string name = it.path().filename();
+    if (name.size() > 3 && name[3] == '-')
+      names.push_back(name);
+  }
+
+  return names;
+}
+
+std::string Path(const std::string& name) {
+  const std::string chip = "pwmchip";
+  if (name.compare(0, chip.size(), chip))
+    return PwmPath() + name;
+
+  // pwmchipN-M or pwmchipN/pwmM.
+  auto separator = name.find_first_of("-/");
+  if (separator == std::string::npos)
+    return PwmPath() + name;
+  std::string chip_path = PwmPath() + name.substr(0, separator);
+  std::string channel = name.substr(separator + 1);
+  if (!channel.compare(0, 3, "pwm"))
+    channel = channel.substr(3);
+
+  std::string path = chip_path + "/pwm" + channel;
+  if (!std::filesystem::exists(path))
+    Write(chip_path + "/export", channel);
+  return path;
+}
+
+bool Configure(const std::string& name,
+               long long period,
+               long long duty_cycle,
+               const std::string& polarity) {
+  TRACE_SCOPE("pwm::Configure");
+  State current;
+  bool ok = true;
+  if (Read(name, &current) && DutyCycleFirst(current, period)) {
+    ok &= SetDutyCycle(name, duty_cycle);
+    ok &= SetPeriod(name, period);
+  } else {
+    ok &= SetPeriod(name, period);
+    ok &= SetDutyCycle(name, duty_cycle);
+  }
+  ok &= SetPolarity(name, polarity);
+  return ok;
+}
+
+bool DutyCycleFirst(const State& current, long long period) {
+  return current.duty_cycle > period;
+}
+
+bool SetPeriod(const std::string& name, long long period) {
+  return Write(Path(name) + "/period", std::to_string(period));
+}
+
+bool SetDutyCycle(const std::string& name, long long duty_cycle) {
+  return Write(Path(name) + "/duty_cycle", std::to_string(duty_cycle));
+}
+
+bool SetPolarity(const std::string& name, const std::string& polarity) {
+  return Write(Path(name) + "/polarity", polarity);
+}
+
+bool Enable(const std::string& name, bool enable) {
+  return Write(Path(name) + "/enable", enable ? "1" : "0");
+}
+
+bool Read(const std::string& name, State* state) {
+  TRACE_SCOPE("pwm::Read");
+  std::string path = Path(name);
+  long long enabled = 0;
+  bool ok = ReadInt(path + "/period", &state->period);
+  ok &= ReadInt(path + "/duty_cycle", &state->duty_cycle);
+  ok &= ReadLine(path + "/polarity", &state->polarity);
+  ok &= ReadInt(path + "/enable", &enabled);
+  state->enabled = enabled;
+  return ok;
+}
+
+bool ParseTime(const std::string& input, long long* nanoseconds) {
+  const char* begin = input.c_str();
+  char* end = nullptr;
+  double value = std::strtod(begin, &end);
+  if (end == begin || value < 0)
+    return false;
+
+  std::string unit = end;
+  double scale = 0;
+  if (unit == "" || unit == "ns")
+    scale = 1;
+  else if (unit == "us")
+    scale = 1e3;
+  else if (unit == "ms")
+    scale = 1e6;
+  else if (unit == "s")
+    scale = 1e9;
+  else
+    return false;
+
+  *nanoseconds = static_cast<long long>(value * scale + 0.5);
+  return true;
+}
+
+bool ParseDuty(const std::string& input,
+               long long period,
+               long long* nanoseconds) {
+  if (input.empty() || input.back() != '%')
+    return ParseTime(input, nanoseconds);
+
+  const char* begin = input.c_str();
+  char* end = nullptr;
+  double percent = std::strtod(begin, &end);
+  // Nothing but the number before the '%', and NaN fails the range.
+  if (end == begin || end != begin + input.size() - 1 ||
+      !(percent >= 0 && percent <= 100)) {
+    return false;
+  }
+  *nanoseconds = static_cast<long long>(percent / 100 * period + 0.5);
+  return true;
+}
+
+}  // namespace pwm
+}  // namespace hw
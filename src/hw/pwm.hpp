@@ -0,0 +1,59 @@
+#ifndef BEAGLE_CONFIG_HW_PWM_HPP
+#define BEAGLE_CONFIG_HW_PWM_HPP
+
+#include <string>
+#include <vector>
+
+// PWM channels of /sys/class/pwm.
+namespace hw {
+namespace pwm {
+
+struct State {
+  long long period = 0;
+  long long duty_cycle = 0;
+  std::string polarity;
+  bool enabled = false;
+};
+
+// List the channels, eg. "pwm-4:0".
+std::vector<std::string> FindPWMs();
+
+// Returns the directory of a channel. Besides the names returned by
+// FindPWMs(), "pwmchip4-0" and "pwmchip4/pwm0" are accepted. Those are
+// exported if needed.
+std::string Path(const std::string& name);
+
+// Whether the duty cycle must be written before |period|: the kernel rejects
+// a period shorter than the duty cycle of |current|, and a duty cycle longer
+// than the period.
+bool DutyCycleFirst(const State& current, long long period);
+
+// Apply the settings in the order the kernel accepts them: period and duty
+// cycle, as DutyCycleFirst() tells, then polarity. Durations are in
+// nanoseconds.
+bool Configure(const std::string& name,
+               long long period,
+               long long duty_cycle,
+               const std::string& polarity);
+
+bool SetPeriod(const std::string& name, long long period);
+bool SetDutyCycle(const std::string& name, long long duty_cycle);
+bool SetPolarity(const std::string& name, const std::string& polarity);
+bool Enable(const std::string& name, bool enable);
+
+bool Read(const std::string& name, State* state);
+
+// Parse a duration such as "1ms", "2.5us" or "20000" into nanoseconds. Plain
+// numbers are in nanoseconds.
+bool ParseTime(const std::string& input, long long* nanoseconds);
+
+// Parse a duty cycle, as a duration for ParseTime() or a percentage of
+// |period| from 0 to 100, eg. "25%".
+bool ParseDuty(const std::string& input,
+               long long period,
+               long long* nanoseconds);
+
+}  // namespace pwm
+}  // namespace hw
+
+#endif /* end of include guard: BEAGLE_CONFIG_HW_PWM_HPP */
@@ -0,0 +1,24 @@
+#include "hw/root.hpp"
+
+namespace hw {
+
+namespace {
+// Without the trailing '/'. Empty for "/".
+std::string g_root;
+}  // namespace
+
+void SetRoot(const std::string& root) {
+  g_root = root;
+  while (!g_root.empty() && g_root.back() == '/')
+    g_root.pop_back();
+}
+
+std::string Rooted(const std::string& path) {
+  return g_root + path;
+}
+
+bool HasRoot() {
+  return !g_root.empty();
+}
+
+}  // namespace hw
@@ -0,0 +1,23 @@
+#ifndef BEAGLE_CONFIG_HW_ROOT_HPP
+#define BEAGLE_CONFIG_HW_ROOT_HPP
+
+#include <string>
+
+// The sysfs, procfs, /boot and /etc files used by bb-config are looked up
+// below a root directory, "/" by default. Pointing it to a copy of a board's
+// tree, such as the one made by tools/make_fixture.sh, allows running and
+// profiling bb-config on a development machine.
+namespace hw {
+
+// Set the root. Must be called before any other thread is started.
+void SetRoot(const std::string& root);
+
+// Returns |path| below the root, eg. /sys/class/gpio -> <root>/sys/class/gpio
+std::string Rooted(const std::string& path);
+
+// Whether a root other than "/" is used.
+bool HasRoot();
+
+}  // namespace hw
+
+#endif /* end of include guard: BEAGLE_CONFIG_HW_ROOT_HPP */
@@ -0,0 +1,55 @@
+#include "hw/sysfs.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <utility>
+#include "trace.hpp"
+
+namespace hw {
+
+bool ReadLine(const std::string& path, std::string* value) {
+  TRACE_SCOPE("sysfs read");
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return false;
+
+  // Most attributes fit in a single read, some like LED triggers may not.
+  std::string content;
+  char buffer[4096];
+  ssize_t size;
+  while ((size = read(fd, buffer, sizeof(buffer))) > 0)
+    content.append(buffer, size);
+  close(fd);
+  if (size < 0)
+    return false;
+
+  auto newline = content.find('\n');
+  if (newline != std::string::npos)
+    content.resize(newline);
+  *value = std::move(content);
+  return true;
+}
+
+bool ReadInt(const std::string& path, long long* value) {
+  std::string line;
+  if (!ReadLine(path, &line) || line.empty())
+    return false;
+
+  char* end = nullptr;
+  *value = std::strtoll(line.c_str(), &end, 10);
+  return end != line.c_str();
+}
+
+bool Write(const std::string& path, const std::string& value) {
+  TRACE_SCOPE("sysfs write");
+  // sysfs ignores O_TRUNC, regular files of a fixture tree need it.
+  int fd = open(path.c_str(), O_WRONLY | O_TRUNC | O_CLOEXEC);
+  if (fd < 0)
+    return false;
+
+  ssize_t size = write(fd, value.data(), value.size());
+  close(fd);
+  return size == static_cast<ssize_t>(value.size());
+}
+
+}  // namespace hw
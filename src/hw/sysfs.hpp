@@ -0,0 +1,22 @@
+#ifndef BEAGLE_CONFIG_HW_SYSFS_HPP
+#define BEAGLE_CONFIG_HW_SYSFS_HPP
+
+#include <string>
+
+// Helpers to access sysfs attributes with a single open/read/write/close,
+// without going through iostreams.
+namespace hw {
+
+// Read the first line of |path| into |value|, without the trailing newline.
+// |value| is left untouched on failure.
+bool ReadLine(const std::string& path, std::string* value);
+
+// Read an integer from |path|.
+bool ReadInt(const std::string& path, long long* value);
+
+// Write |value| to |path|.
+bool Write(const std::string& path, const std::string& value);
+
+}  // namespace hw
+
+#endif /* end of include guard: BEAGLE_CONFIG_HW_SYSFS_HPP */
@@ -0,0 +1,245 @@
+#include "log.hpp"
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <thread>
+#include "trace.hpp"
+
+namespace logging {
+
+namespace internal {
+std::atomic<int> level{static_cast<int>(Level::Info)};
+}  // namespace internal
+
+namespace {
+
+// A message in the ring. Longer ones are truncated.
+struct Record {
+  int64_t time_ns;
+  Level level;
+  const char* file;
+  int line;
+  uint16_t size;
+  char text[200];
+};
+
+// A bounded queue for many producers and the writer thread, after Dmitry
+// Vyukov's: each cell carries a sequence number telling whether it is free
+// for the producer of a position, or filled for the consumer.
+constexpr size_t kCapacity = 1024;
+struct Cell {
+  std::atomic<size_t> sequence;
+  Record record;
+};
+Cell g_cells[kCapacity];
+std::atomic<size_t> g_enqueue{0};
+size_t g_dequeue = 0;  // Writer thread only.
+std::atomic<uint64_t> g_dropped{0};
+
+bool Push(const Record& record) {
+  size_t position = g_enqueue.load(std::memory_order_relaxed);
+  Cell* cell;
+  while (true) {
+    cell = &g_cells[position % kCapacity];
+    size_t sequence = cell->sequence.load(std::memory_order_acquire);
+    auto difference = static_cast<intptr_t>(sequence - position);
+    if (difference == 0) {
+      if (g_enqueue.compare_exchange_weak(position, position + 1,
+                                          std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (difference < 0) {
+      return false;  // Full.
+    } else {
+      position = g_enqueue.load(std::memory_order_relaxed);
+    }
+  }
+  cell->record = record;
+  cell->sequence.store(position + 1, std::memory_order_release);
+  return true;
+}
+
+bool Pop(Record* record) {
+  Cell& cell = g_cells[g_dequeue % kCapacity];
+  if (cell.sequence.load(std::memory_order_acquire) != g_dequeue + 1)
+    return false;
+  *record = cell.record;
+  cell.sequence.store(g_dequeue + kCapacity, std::memory_order_release);
+  g_dequeue++;
+  return true;
+}
+
+const bool g_cells_ready = [] {
+  for (size_t i = 0; i < kCapacity; ++i)
+    g_cells[i].sequence.store(i, std::memory_order_relaxed);
+  return true;
+}();
+
+// The messages kept for Recent().
+constexpr size_t kRecent = 1000;
+
+// The size past which the log file is rotated, at Start().
+constexpr off_t kMaxFileSize = 1 << 20;
+
+std::mutex g_mutex;
+std::condition_variable g_wake;
+std::deque<Entry> g_recent;
+std::atomic<uint64_t> g_generation{0};
+std::FILE* g_file = nullptr;
+int g_pid = 0;
+bool g_stderr = false;
+bool g_stop = false;
+std::thread g_thread;
+
+// eg. 2024-05-01 12:34:56.789
+std::string FormatTime(int64_t time_ns) {
+  time_t seconds = time_ns / 1000000000;
+  tm local;
+  localtime_r(&seconds, &local);
+  char buffer[32];
+  size_t size = std::strftime(buffer, sizeof(buffer), "%F %T", &local);
+  std::snprintf(buffer + size, sizeof(buffer) - size, ".%03d",
+                int(time_ns / 1000000 % 1000));
+  return buffer;
+}
+
+// Write the queued messages. Writer thread, or Stop() once it is joined.
+void Drain() {
+  Record record;
+  std::deque<Entry> entries;
+  while (Pop(&record)) {
+    const char* base = std::strrchr(record.file, '/');
+    Entry entry;
+    entry.time_ns = record.time_ns;
+    entry.level = record.level;
+    entry.source = std::string(base ? base + 1 : record.file) + ":" +
+                   std::to_string(record.line);
+    entry.text.assign(record.text, record.size);
+    entries.push_back(std::move(entry));
+  }
+  if (entries.empty())
+    return;
+
+  TRACE_SCOPE("logging::Drain");
+  std::lock_guard<std::mutex> lock(g_mutex);
+  for (auto& entry : entries) {
+    std::string line = FormatTime(entry.time_ns) + " " +
+                       LevelLetter(entry.level) + " " + entry.source + " " +
+                       entry.text + "\n";
+    // The file is shared by the processes, told apart by their pid.
+    if (g_file)
+      std::fprintf(g_file, "%d %s", g_pid, line.c_str());
+    if (g_stderr && entry.level >= Level::Warning)
+      std::fputs(line.c_str(), stderr);
+    g_recent.push_back(std::move(entry));
+  }
+  while (g_recent.size() > kRecent)
+    g_recent.pop_front();
+  if (g_file)
+    std::fflush(g_file);
+  g_generation++;
+}
+
+void Run() {
+  trace::SetThreadName("log");
+  std::unique_lock<std::mutex> lock(g_mutex);
+  while (!g_stop) {
+    // Batch the messages rather than waking up for each of them.
+    g_wake.wait_for(lock, std::chrono::milliseconds(100));
+    lock.unlock();
+    Drain();
+    lock.lock();
+  }
+}
+
+}  // namespace
+
+bool ParseLevel(const std::string& name, Level* level) {
+  const std::pair<const char*, Level> levels[] = {
+      {"debug", Level::Debug},
+      {"info", Level::Info},
+      {"warning", Level::Warning},
+      {"error", Level::Error},
+  };
+  for (const auto& it : levels) {
+    if (name == it.first) {
+      *level = it.second;
+      return true;
+    }
+  }
+  return false;
+}
+
+char LevelLetter(Level level) {
+  return "DIWE"[static_cast<int>(level)];
+}
+
+void Start(Level level, const std::string& path, bool to_stderr) {
+  internal::level = static_cast<int>(level);
+  std::lock_guard<std::mutex> lock(g_mutex);
+  g_pid = getpid();
+  if (!path.empty()) {
+    // Appended to, for a headless command not to wipe the log of a session
+    // running. The previous file is kept once it grows too large.
+    struct stat status;
+    if (stat(path.c_str(), &status) == 0 && status.st_size > kMaxFileSize)
+      std::rename(path.c_str(), (path + ".1").c_str());
+    g_file = std::fopen(path.c_str(), "ae");
+  }
+  g_stderr = to_stderr;
+  g_stop = false;
+  g_thread = std::thread(Run);
+}
+
+void Stop() {
+  {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (!g_thread.joinable())
+      return;
+    g_stop = true;
+  }
+  g_wake.notify_one();
+  g_thread.join();
+  Drain();
+
+  std::lock_guard<std::mutex> lock(g_mutex);
+  if (g_file)
+    std::fclose(g_file);
+  g_file = nullptr;
+}
+
+std::deque<Entry> Recent() {
+  std::lock_guard<std::mutex> lock(g_mutex);
+  return g_recent;
+}
+
+uint64_t Generation() {
+  return g_generation;
+}
+
+uint64_t Dropped() {
+  return g_dropped;
+}
+
+Message::~Message() {
+  Record record;
+  timespec now;
+  clock_gettime(CLOCK_REALTIME, &now);
+  record.time_ns = now.tv_sec * 1000000000ll + now.tv_nsec;
+  record.level = level_;
+  record.file = file_;
+  record.line = line_;
+  std::string text = stream_.str();
+  record.size = std::min(text.size(), sizeof(record.text));
+  std::memcpy(record.text, text.data(), record.size);
+  if (!Push(record))
+    g_dropped++;
+}
+
+}  // namespace logging
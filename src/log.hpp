@@ -0,0 +1,111 @@
+#ifndef BEAGLE_CONFIG_LOG_HPP
+#define BEAGLE_CONFIG_LOG_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <sstream>
+#include <string>
+
+// Leveled logging, safe to use while the UI owns the terminal. Usage:
+//
+//   LOG_WARNING << "Failed to export GPIO " << number;
+//
+// Messages are queued without locking into a bounded ring, and written by a
+// thread of their own to the log file, and to stderr for the headless
+// commands. The most recent ones are kept for the Log panel.
+//
+// Messages below BEAGLE_CONFIG_MIN_LOG_LEVEL are compiled out, and those
+// below the level given to Start() cost a relaxed atomic load.
+#ifndef BEAGLE_CONFIG_MIN_LOG_LEVEL
+#define BEAGLE_CONFIG_MIN_LOG_LEVEL 0
+#endif
+
+namespace logging {
+
+enum class Level {
+  Debug = 0,
+  Info = 1,
+  Warning = 2,
+  Error = 3,
+};
+
+// Parse "debug", "info", "warning" or "error".
+bool ParseLevel(const std::string& name, Level* level);
+
+// eg. 'W' for Warning.
+char LevelLetter(Level level);
+
+namespace internal {
+extern std::atomic<int> level;
+}  // namespace internal
+
+inline bool Enabled(Level level) {
+  int value = static_cast<int>(level);
+  return value >= BEAGLE_CONFIG_MIN_LOG_LEVEL &&
+         value >= internal::level.load(std::memory_order_relaxed);
+}
+
+// Log the messages from |level| to |path|, and to stderr if |to_stderr|. An
+// empty |path| keeps them in memory only.
+void Start(Level level, const std::string& path, bool to_stderr);
+
+// Write the pending messages and stop the thread.
+void Stop();
+
+struct Entry {
+  int64_t time_ns;  // CLOCK_REALTIME
+  Level level;
+  std::string source;  // eg. gpio.cpp:284
+  std::string text;
+};
+
+// The most recent messages, oldest first.
+std::deque<Entry> Recent();
+
+// Incremented as messages are written, to refresh views of Recent().
+uint64_t Generation();
+
+// The messages lost because the ring was full.
+uint64_t Dropped();
+
+// Queue its message when destroyed. Use the LOG_* macros instead.
+class Message {
+ public:
+  Message(Level level, const char* file, int line)
+      : level_(level), file_(file), line_(line) {}
+  ~Message();
+
+  Message(const Message&) = delete;
+  Message& operator=(const Message&) = delete;
+
+  std::ostream& stream() { return stream_; }
+
+ private:
+  Level level_;
+  const char* file_;
+  int line_;
+  std::ostringstream stream_;
+};
+
+namespace internal {
+// Turn the stream of a message into void, for the macros to be expressions.
+struct Voidify {
+  void operator&(std::ostream&) {}
+};
+}  // namespace internal
+
+}  // namespace logging
+
+#define LOG_AT(level)                                 \
+  !logging::Enabled(level)                            \
+      ? (void)0                                       \
+      : logging::internal::Voidify() &                \
+            logging::Message(level, __FILE__, __LINE__).stream()
+
+#define LOG_DEBUG LOG_AT(logging::Level::Debug)
+#define LOG_INFO LOG_AT(logging::Level::Info)
+#define LOG_WARNING LOG_AT(logging::Level::Warning)
+#define LOG_ERROR LOG_AT(logging::Level::Error)
+
+#endif /* end of include guard: BEAGLE_CONFIG_LOG_HPP */
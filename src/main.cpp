@@ -1,6 +1,101 @@
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include "cli/cli.hpp"
+#include "hw/root.hpp"
+#include "log.hpp"
+#include "trace.hpp"
 #include "ui/ui.hpp"
+#include "xdg_utils.hpp"
 
-int main() {
-  ui::Loop();
-  return 0;
+namespace {
+
+void PrintUsage(const char* name) {
+  std::cout << "Usage: " << name << " [options]\n"
+            << "       " << name << " [options] <command> [arguments]\n"
+            << "Options:\n"
+            << "  --eager         Build every panel before the first frame\n"
+            << "  --lazy          Build panels when first displayed only\n"
+            << "  --startup-time  Print the time to first frame on exit\n"
+            << "  --trace=<file>  Write a Chrome trace-event JSON file on exit\n"
+            << "  --log-level=<level>\n"
+            << "                  debug, info (default), warning or error\n"
+            << "  --root=<dir>    Use the sysfs, procfs and /boot files below\n"
+            << "                  <dir>. Defaults to $BB_CONFIG_ROOT, or /\n"
+            << "  --help          Show this message\n";
+  cli::PrintUsage(std::cout);
+}
+
+// $XDG_STATE_HOME/bb-config/bb-config.log, or none without a home.
+std::string LogPath() {
+  std::string home;
+  try {
+    home = xdg_utils::state::home();
+  } catch (const std::runtime_error&) {
+  }
+  if (home.empty())
+    return {};
+  std::error_code error;
+  std::filesystem::create_directories(home + "/bb-config", error);
+  return home + "/bb-config/bb-config.log";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (const char* root = std::getenv("BB_CONFIG_ROOT"))
+    hw::SetRoot(root);
+
+  ui::LoopOptions options;
+  std::string trace_path;
+  logging::Level log_level = logging::Level::Info;
+  int command = 0;
+  for (int i = 1; i < argc && !command; ++i) {
+    if (cli::IsCommand(argv[i])) {
+      command = i;
+    } else if (!std::strncmp(argv[i], "--trace=", 8)) {
+      trace_path = argv[i] + 8;
+    } else if (!std::strncmp(argv[i], "--log-level=", 12) &&
+               logging::ParseLevel(argv[i] + 12, &log_level)) {
+    } else if (!std::strncmp(argv[i], "--root=", 7)) {
+      hw::SetRoot(argv[i] + 7);
+    } else if (!std::strcmp(argv[i], "--eager")) {
+      options.startup = ui::LoopOptions::Startup::Eager;
+    } else if (!std::strcmp(argv[i], "--lazy")) {
+      options.startup = ui::LoopOptions::Startup::Lazy;
+    } else if (!std::strcmp(argv[i], "--startup-time")) {
+      options.report_startup_time = true;
+    } else if (!std::strcmp(argv[i], "--help")) {
+      PrintUsage(argv[0]);
+      return 0;
+    } else {
+      std::cerr << "Unknown option: " << argv[i] << "\n";
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  if (!trace_path.empty()) {
+    trace::Start(trace_path);
+    trace::SetThreadName(command ? "cli" : "ui");
+  }
+
+  // The UI owns the terminal, the headless commands don't.
+  logging::Start(log_level, LogPath(), command != 0);
+
+  int status = 0;
+  if (command)
+    status = cli::Run(argc - command, argv + command);
+  else
+    ui::Loop(options);
+  logging::Stop();
+
+  if (!trace::Stop()) {
+    std::cerr << "Failed to write the trace to " << trace_path << "\n";
+    return 1;
+  }
+  return status;
 }
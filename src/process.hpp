@@ -23,6 +23,8 @@
 #include <system_error>
 #include <vector>
 
+#include "trace.hpp"
+
 namespace procxx {
 
 /**
@@ -394,6 +396,9 @@ class process {
     if (pid_ != -1)
       throw exception{"process already started"};
 
+    TRACE_SCOPE("process::exec",
+                trace::Enabled() ? trace::Intern(args_.front()) : nullptr);
+
     pipe_t err_pipe;
 
     auto pid = fork();
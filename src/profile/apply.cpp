@@ -0,0 +1,494 @@
+#include "profile/apply.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <set>
+#include <sstream>
+#include <vector>
+#include "hw/gpio.hpp"
+#include "hw/led.hpp"
+#include "hw/pinmux.hpp"
+#include "hw/pwm.hpp"
+#include "thread_pool.hpp"
+#include "trace.hpp"
+
+namespace profile {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// A single setting, eg. the direction of a GPIO.
+struct Step {
+  std::string description;
+  // The value expected when reading the setting back.
+  std::string expected;
+  std::function<bool()> apply;
+  // Read the setting back. Steps without one are not verified.
+  std::function<bool(std::string*)> read;
+
+  // The outcome.
+  std::string status = "skipped";
+  bool ok = false;
+  Clock::duration duration{};
+};
+
+// Steps applied in order. Groups of a same phase run concurrently.
+using Group = std::vector<Step>;
+
+struct Plan {
+  std::vector<Group> pinmux;
+  std::vector<Group> devices;
+};
+
+bool Fail(std::string* error, const std::string& message) {
+  *error = message;
+  return false;
+}
+
+bool ReadNumber(const Value& value, long long* number) {
+  if (value.type == Value::Type::Number) {
+    *number = static_cast<long long>(value.number);
+    return true;
+  }
+  if (value.type != Value::Type::String)
+    return false;
+  char* end = nullptr;
+  *number = std::strtoll(value.string.c_str(), &end, 10);
+  return end != value.string.c_str() && *end == '\0';
+}
+
+bool ReadTime(const Value& value, long long* nanoseconds) {
+  if (value.type == Value::Type::Number) {
+    *nanoseconds = static_cast<long long>(value.number);
+    return true;
+  }
+  return value.type == Value::Type::String &&
+         hw::pwm::ParseTime(value.string, nanoseconds);
+}
+
+bool ReadBool(const Value& value, bool* boolean) {
+  if (value.type == Value::Type::Bool) {
+    *boolean = value.boolean;
+    return true;
+  }
+  long long number = 0;
+  if (!ReadNumber(value, &number) || (number != 0 && number != 1))
+    return false;
+  *boolean = number;
+  return true;
+}
+
+// Check |section| only contains the given keys.
+bool CheckKeys(const std::string& name,
+               const Value& section,
+               const std::vector<std::string>& keys,
+               std::string* error) {
+  if (!section.is_object())
+    return Fail(error, name + " must be a table");
+  for (const auto& it : section.object) {
+    bool found = false;
+    for (const auto& key : keys)
+      found |= key == it.first;
+    if (!found)
+      return Fail(error, name + ": unknown setting '" + it.first + "'");
+  }
+  return true;
+}
+
+bool PlanPinmux(const Value& section, Plan* plan, std::string* error) {
+  if (!section.is_object())
+    return Fail(error, "pinmux must be a table");
+
+  auto headers = hw::pinmux::LoadPins(hw::pinmux::BoardModel());
+  for (const auto& it : section.object) {
+    hw::pinmux::PinDetail pin;
+    if (!hw::pinmux::FindPin(headers, it.first, &pin))
+      return Fail(error, "pinmux: unknown pin " + it.first);
+    std::string mode = it.second.ToString();
+    if (mode.empty())
+      return Fail(error, "pinmux: the mode of " + it.first + " is missing");
+
+    std::string header = pin.header;
+    plan->pinmux.push_back({{
+        "pinmux " + header + " = " + mode,
+        mode,
+        [=] { return hw::pinmux::SetState(header, mode); },
+        [=](std::string* state) {
+          return hw::pinmux::GetState(header, state);
+        },
+    }});
+  }
+  return true;
+}
+
+bool PlanGpio(const Value& section, Plan* plan, std::string* error) {
+  if (!section.is_object())
+    return Fail(error, "gpio must be a table");
+
+  std::set<int> numbers;
+  for (const auto& it : section.object) {
+    const std::string name = "gpio " + it.first;
+    if (!CheckKeys(name, it.second,
+                   {"direction", "value", "active_low", "edge"}, error)) {
+      return false;
+    }
+
+    int number = 0;
+    if (!hw::gpio::Resolve(it.first, &number))
+      return Fail(error, name + ": unknown GPIO");
+    // Each line is configured by a single group.
+    if (!numbers.insert(number).second)
+      return Fail(error, name + ": GPIO " + std::to_string(number) +
+                             " is listed twice");
+
+    Group group;
+    group.push_back({
+        name + " export",
+        "",
+        [=] { return hw::gpio::Export(number); },
+        nullptr,
+    });
+
+    // active_low changes the meaning of value, and edge requires an input:
+    // active_low goes first, then direction and edge, then value.
+    using Field = std::string hw::gpio::State::*;
+    using Setter = bool (*)(int, const std::string&);
+    struct Attribute {
+      const char* key;
+      Field field;
+      Setter set;
+    };
+    const Attribute attributes[] = {
+        {"active_low", &hw::gpio::State::active_low, hw::gpio::SetActiveLow},
+        {"direction", &hw::gpio::State::direction, hw::gpio::SetDirection},
+        {"edge", &hw::gpio::State::edge, hw::gpio::SetEdge},
+        {"value", &hw::gpio::State::value, hw::gpio::SetValue},
+    };
+    for (const auto& attribute : attributes) {
+      const Value* value = it.second.Find(attribute.key);
+      if (!value)
+        continue;
+      std::string expected = value->ToString();
+      if (value->type == Value::Type::Bool)
+        expected = value->boolean ? "1" : "0";
+      Field field = attribute.field;
+      Setter set = attribute.set;
+      group.push_back({
+          name + " " + attribute.key + " = " + expected,
+          expected,
+          [=] { return set(number, expected); },
+          [=](std::string* state) {
+            *state = hw::gpio::Read(number).*field;
+            return true;
+          },
+      });
+    }
+    plan->devices.push_back(std::move(group));
+  }
+  return true;
+}
+
+bool PlanPwm(const Value& section, Plan* plan, std::string* error) {
+  if (!section.is_object())
+    return Fail(error, "pwm must be a table");
+
+  for (const auto& it : section.object) {
+    const std::string name = "pwm " + it.first;
+    if (!CheckKeys(name, it.second, {"period", "duty", "polarity", "enable"},
+                   error)) {
+      return false;
+    }
+    const std::string channel = it.first;
+
+    long long period = 0;
+    const Value* period_value = it.second.Find("period");
+    if (!period_value || !ReadTime(*period_value, &period))
+      return Fail(error, name + ": period must be a duration, eg. \"1ms\"");
+
+    // The duty cycle is left as it is unless given.
+    long long duty = 0;
+    const Value* duty_value = it.second.Find("duty");
+    if (duty_value) {
+      bool parsed = duty_value->type == Value::Type::String
+                        ? hw::pwm::ParseDuty(duty_value->string, period, &duty)
+                        : ReadTime(*duty_value, &duty);
+      if (!parsed || duty < 0) {
+        return Fail(error, name + ": duty must be a duration or a percentage "
+                                  "from 0 to 100");
+      }
+      if (duty > period)
+        return Fail(error, name + ": duty must not exceed period");
+    }
+
+    std::string polarity = "normal";
+    if (const Value* value = it.second.Find("polarity"))
+      polarity = value->ToString();
+    if (polarity != "normal" && polarity != "inversed")
+      return Fail(error, name + ": polarity must be normal or inversed");
+
+    bool enable = true;
+    if (const Value* value = it.second.Find("enable")) {
+      if (!ReadBool(*value, &enable))
+        return Fail(error, name + ": enable must be a boolean");
+    }
+
+    auto read = [channel](long long hw::pwm::State::*field) {
+      return [channel, field](std::string* state) {
+        hw::pwm::State current;
+        if (!hw::pwm::Read(channel, &current))
+          return false;
+        *state = std::to_string(current.*field);
+        return true;
+      };
+    };
+    Step period_step = {
+        name + " period = " + std::to_string(period),
+        std::to_string(period),
+        [=] { return hw::pwm::SetPeriod(channel, period); },
+        read(&hw::pwm::State::period),
+    };
+    Step duty_step = {
+        name + " duty_cycle = " + std::to_string(duty),
+        std::to_string(duty),
+        [=] { return hw::pwm::SetDutyCycle(channel, duty); },
+        read(&hw::pwm::State::duty_cycle),
+    };
+
+    // The duty cycle goes first when shrinking the period below the current
+    // one. The polarity can only be changed while disabled.
+    hw::pwm::State current;
+    bool known = hw::pwm::Read(channel, &current);
+    Group group;
+    if (known && current.enabled && current.polarity != polarity) {
+      group.push_back({
+          name + " enable = 0",
+          "0",
+          [=] { return hw::pwm::Enable(channel, false); },
+          nullptr,
+      });
+    }
+    if (known && hw::pwm::DutyCycleFirst(current, period)) {
+      if (!duty_value) {
+        return Fail(error, name + ": duty must be given, the current one "
+                                  "exceeds period");
+      }
+      group.push_back(duty_step);
+      group.push_back(period_step);
+    } else {
+      group.push_back(period_step);
+      if (duty_value)
+        group.push_back(duty_step);
+    }
+    group.push_back({
+        name + " polarity = " + polarity,
+        polarity,
+        [=] { return hw::pwm::SetPolarity(channel, polarity); },
+        [=](std::string* state) {
+          hw::pwm::State now;
+          *state = hw::pwm::Read(channel, &now) ? now.polarity : "";
+          return !state->empty();
+        },
+    });
+    group.push_back({
+        name + " enable = " + (enable ? "1" : "0"),
+        enable ? "1" : "0",
+        [=] { return hw::pwm::Enable(channel, enable); },
+        [=](std::string* state) {
+          hw::pwm::State now;
+          if (!hw::pwm::Read(channel, &now))
+            return false;
+          *state = now.enabled ? "1" : "0";
+          return true;
+        },
+    });
+    plan->devices.push_back(std::move(group));
+  }
+  return true;
+}
+
+bool PlanLed(const Value& section, Plan* plan, std::string* error) {
+  if (!section.is_object())
+    return Fail(error, "led must be a table");
+
+  for (const auto& it : section.object) {
+    const std::string name = "led " + it.first;
+    if (!CheckKeys(name, it.second,
+                   {"trigger", "brightness", "delay_on", "delay_off"},
+                   error)) {
+      return false;
+    }
+
+    std::string led;
+    if (!hw::led::Resolve(it.first, &led))
+      return Fail(error, name + ": unknown LED");
+
+    Group group;
+    const Value* trigger = it.second.Find("trigger");
+    const Value* delay_on = it.second.Find("delay_on");
+    const Value* delay_off = it.second.Find("delay_off");
+    auto read_trigger = [led](std::string* state) {
+      *state = hw::led::Read(led).trigger;
+      return true;
+    };
+    if (delay_on || delay_off) {
+      long long on = 0, off = 0;
+      if ((trigger && trigger->ToString() != "timer") ||
+          (delay_on && !ReadNumber(*delay_on, &on)) ||
+          (delay_off && !ReadNumber(*delay_off, &off))) {
+        return Fail(error,
+                    name + ": delays are in ms and need a timer trigger");
+      }
+      group.push_back({
+          name + " timer = " + std::to_string(on) + "/" + std::to_string(off),
+          "timer",
+          [=] { return hw::led::SetTimer(led, on, off); },
+          read_trigger,
+      });
+    } else if (trigger) {
+      std::string value = trigger->ToString();
+      group.push_back({
+          name + " trigger = " + value,
+          value,
+          [=] { return hw::led::SetTrigger(led, value); },
+          read_trigger,
+      });
+    }
+
+    if (const Value* value = it.second.Find("brightness")) {
+      long long brightness = 0;
+      if (!ReadNumber(*value, &brightness))
+        return Fail(error, name + ": brightness must be a number");
+      group.push_back({
+          name + " brightness = " + std::to_string(brightness),
+          std::to_string(brightness),
+          [=] { return hw::led::SetBrightness(led, brightness); },
+          [=](std::string* state) {
+            *state = std::to_string(hw::led::Read(led).brightness);
+            return true;
+          },
+      });
+    }
+    plan->devices.push_back(std::move(group));
+  }
+  return true;
+}
+
+bool BuildPlan(const Value& profile, Plan* plan, std::string* error) {
+  if (!profile.is_object())
+    return Fail(error, "a profile must be a table");
+
+  for (const auto& it : profile.object) {
+    bool ok = true;
+    if (it.first == "pinmux")
+      ok = PlanPinmux(it.second, plan, error);
+    else if (it.first == "gpio")
+      ok = PlanGpio(it.second, plan, error);
+    else if (it.first == "pwm")
+      ok = PlanPwm(it.second, plan, error);
+    else if (it.first == "led")
+      ok = PlanLed(it.second, plan, error);
+    else
+      ok = Fail(error, "unknown section '" + it.first + "'");
+    if (!ok)
+      return false;
+  }
+  return true;
+}
+
+// Apply the steps of |group| in order, stopping at the first failure.
+void RunGroup(Group* group) {
+  for (auto& step : *group) {
+    TRACE_SCOPE("profile step",
+                trace::Enabled() ? trace::Intern(step.description) : nullptr);
+    auto start = Clock::now();
+    bool applied = step.apply();
+    step.duration = Clock::now() - start;
+    if (!applied) {
+      step.status = "failed";
+      return;
+    }
+
+    std::string actual;
+    if (!step.read) {
+      step.status = "ok";
+    } else if (!step.read(&actual)) {
+      step.status = "unverified";
+    } else if (actual != step.expected) {
+      step.status = "read back " + actual;
+      return;
+    } else {
+      step.status = "ok";
+    }
+    step.ok = true;
+  }
+}
+
+// Run the groups concurrently.
+void RunPhase(std::vector<Group>* groups, ThreadPool* pool) {
+  for (auto& group : *groups)
+    pool->Post([&group] { RunGroup(&group); });
+  pool->Wait();
+}
+
+std::string Milliseconds(Clock::duration duration) {
+  char buffer[32];
+  std::snprintf(
+      buffer, sizeof(buffer), "%.2fms",
+      std::chrono::duration<double, std::milli>(duration).count());
+  return buffer;
+}
+
+}  // namespace
+
+bool Load(const std::string& path, Value* value, std::string* error) {
+  std::ifstream file(path);
+  if (!file)
+    return Fail(error, "cannot open " + path);
+  std::stringstream content;
+  content << file.rdbuf();
+
+  bool toml = path.size() >= 5 && !path.compare(path.size() - 5, 5, ".toml");
+  bool parsed = toml ? ParseToml(content.str(), value, error)
+                     : ParseJson(content.str(), value, error);
+  if (!parsed)
+    *error = path + ": " + *error;
+  return parsed;
+}
+
+bool Apply(const Value& profile, std::ostream& out, std::string* error) {
+  TRACE_SCOPE("profile::Apply");
+  Plan plan;
+  if (!BuildPlan(profile, &plan, error))
+    return false;
+
+  auto start = Clock::now();
+  {
+    ThreadPool pool;
+    RunPhase(&plan.pinmux, &pool);
+    RunPhase(&plan.devices, &pool);
+  }
+  auto duration = Clock::now() - start;
+
+  int steps = 0, failures = 0;
+  for (const auto* phase : {&plan.pinmux, &plan.devices}) {
+    for (const auto& group : *phase) {
+      for (const auto& step : group) {
+        steps++;
+        failures += !step.ok;
+        out << std::setw(10) << Milliseconds(step.duration) << "  "
+            << step.description
+            << ": " << step.status << "\n";
+      }
+    }
+  }
+  out << "Applied " << steps - failures << "/" << steps << " settings of "
+      << plan.pinmux.size() + plan.devices.size() << " groups in "
+      << Milliseconds(duration) << "\n";
+  return failures == 0;
+}
+
+}  // namespace profile
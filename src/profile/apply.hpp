@@ -0,0 +1,40 @@
+#ifndef BEAGLE_CONFIG_PROFILE_APPLY_HPP
+#define BEAGLE_CONFIG_PROFILE_APPLY_HPP
+
+#include <ostream>
+#include <string>
+#include "profile/value.hpp"
+
+// Board profiles: the pinmux, GPIO, PWM and LED settings of a board in a
+// single file. For instance in TOML:
+//
+//   [pinmux]
+//   P9_12 = "gpio"
+//   P9_14 = "pwm"
+//
+//   [gpio.P9_12]
+//   direction = "out"
+//   value = 1
+//
+//   [pwm."pwm-4:0"]
+//   period = "1ms"
+//   duty = "25%"
+//
+//   [led.usr0]
+//   trigger = "heartbeat"
+namespace profile {
+
+// Load a .json or .toml profile.
+bool Load(const std::string& path, Value* value, std::string* error);
+
+// Apply a profile. Pins are muxed first. Then every GPIO, PWM and LED is
+// configured concurrently with the others, one setting after the other in the
+// order the kernel requires. Every setting is read back to verify it.
+//
+// Prints the outcome and duration of every setting to |out|. Returns false if
+// the profile is invalid, with |error| set, or if any setting failed.
+bool Apply(const Value& profile, std::ostream& out, std::string* error);
+
+}  // namespace profile
+
+#endif /* end of include guard: BEAGLE_CONFIG_PROFILE_APPLY_HPP */
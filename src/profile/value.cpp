@@ -0,0 +1,414 @@
+#include "profile/value.hpp"
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+
+namespace profile {
+
+const Value* Value::Find(const std::string& key) const {
+  for (const auto& it : object) {
+    if (it.first == key)
+      return &it.second;
+  }
+  return nullptr;
+}
+
+Value* Value::Find(const std::string& key) {
+  for (auto& it : object) {
+    if (it.first == key)
+      return &it.second;
+  }
+  return nullptr;
+}
+
+Value& Value::operator[](const std::string& key) {
+  if (Value* value = Find(key))
+    return *value;
+  object.emplace_back(key, Value());
+  return object.back().second;
+}
+
+std::string Value::ToString() const {
+  switch (type) {
+    case Type::Bool:
+      return boolean ? "true" : "false";
+    case Type::Number: {
+      if (number == std::floor(number) && std::fabs(number) < 1e18)
+        return std::to_string(static_cast<long long>(number));
+      std::ostringstream out;
+      out << number;
+      return out.str();
+    }
+    case Type::String:
+      return string;
+    default:
+      return "";
+  }
+}
+
+namespace {
+
+// A cursor over the input, keeping track of the line for error messages.
+class Reader {
+ public:
+  Reader(const std::string& input, std::string* error)
+      : input_(input), error_(error) {}
+
+  bool Done() const { return position_ >= input_.size(); }
+  char Peek() const { return Done() ? '\0' : input_[position_]; }
+  bool PeekDigit() const {
+    return isdigit(static_cast<unsigned char>(Peek()));
+  }
+
+  char Next() {
+    char c = Peek();
+    if (c == '\n')
+      line_++;
+    position_++;
+    return c;
+  }
+
+  bool Consume(char c) {
+    if (Peek() != c)
+      return false;
+    Next();
+    return true;
+  }
+
+  bool ConsumeWord(const char* word) {
+    size_t size = std::char_traits<char>::length(word);
+    if (input_.compare(position_, size, word))
+      return false;
+    position_ += size;
+    return true;
+  }
+
+  // Skip spaces and tabs, and newlines too if |newlines|.
+  void SkipSpaces(bool newlines) {
+    while (Peek() == ' ' || Peek() == '\t' || Peek() == '\r' ||
+           (newlines && Peek() == '\n')) {
+      Next();
+    }
+  }
+
+  bool Fail(const std::string& message) {
+    if (error_->empty())
+      *error_ = "line " + std::to_string(line_) + ": " + message;
+    return false;
+  }
+
+  // Parse a number in the JSON or TOML syntax. Underscores are allowed
+  // between digits, as in TOML.
+  bool ParseNumber(Value* value) {
+    std::string digits;
+    while (!Done() && (PeekDigit() || Peek() == '-' || Peek() == '+' ||
+                       Peek() == '.' || Peek() == 'e' || Peek() == 'E' ||
+                       Peek() == '_')) {
+      char c = Next();
+      if (c != '_')
+        digits += c;
+    }
+    char* end = nullptr;
+    double number = std::strtod(digits.c_str(), &end);
+    if (digits.empty() || *end != '\0')
+      return Fail("invalid number '" + digits + "'");
+    value->type = Value::Type::Number;
+    value->number = number;
+    return true;
+  }
+
+  // Parse a string delimited by |quote|. Escapes are handled unless |literal|.
+  bool ParseString(char quote, bool literal, std::string* out) {
+    if (!Consume(quote))
+      return Fail(std::string("expected ") + quote);
+    while (!Done() && Peek() != quote && Peek() != '\n') {
+      char c = Next();
+      if (c != '\\' || literal) {
+        *out += c;
+        continue;
+      }
+      switch (Next()) {
+        case '"':
+          *out += '"';
+          break;
+        case '\\':
+          *out += '\\';
+          break;
+        case '/':
+          *out += '/';
+          break;
+        case 'n':
+          *out += '\n';
+          break;
+        case 't':
+          *out += '\t';
+          break;
+        case 'r':
+          *out += '\r';
+          break;
+        default:
+          return Fail("unsupported escape sequence");
+      }
+    }
+    if (!Consume(quote))
+      return Fail("unterminated string");
+    return true;
+  }
+
+ private:
+  const std::string& input_;
+  std::string* error_;
+  size_t position_ = 0;
+  int line_ = 1;
+};
+
+bool ParseJsonValue(Reader* reader, Value* value, int depth) {
+  if (depth > 32)
+    return reader->Fail("too deeply nested");
+
+  reader->SkipSpaces(true);
+  char c = reader->Peek();
+  if (c == '{') {
+    reader->Next();
+    value->type = Value::Type::Object;
+    reader->SkipSpaces(true);
+    if (reader->Consume('}'))
+      return true;
+    do {
+      reader->SkipSpaces(true);
+      std::string key;
+      if (!reader->ParseString('"', false, &key))
+        return false;
+      reader->SkipSpaces(true);
+      if (!reader->Consume(':'))
+        return reader->Fail("expected ':'");
+      if (value->Find(key))
+        return reader->Fail("duplicate key '" + key + "'");
+      if (!ParseJsonValue(reader, &(*value)[key], depth + 1))
+        return false;
+      reader->SkipSpaces(true);
+    } while (reader->Consume(','));
+    if (!reader->Consume('}'))
+      return reader->Fail("expected ',' or '}'");
+    return true;
+  }
+
+  if (c == '[') {
+    reader->Next();
+    value->type = Value::Type::Array;
+    reader->SkipSpaces(true);
+    if (reader->Consume(']'))
+      return true;
+    do {
+      value->array.emplace_back();
+      if (!ParseJsonValue(reader, &value->array.back(), depth + 1))
+        return false;
+      reader->SkipSpaces(true);
+    } while (reader->Consume(','));
+    if (!reader->Consume(']'))
+      return reader->Fail("expected ',' or ']'");
+    return true;
+  }
+
+  if (c == '"') {
+    value->type = Value::Type::String;
+    return reader->ParseString('"', false, &value->string);
+  }
+
+  if (reader->ConsumeWord("true") || reader->ConsumeWord("false")) {
+    value->type = Value::Type::Bool;
+    value->boolean = c == 't';
+    return true;
+  }
+
+  if (reader->ConsumeWord("null"))
+    return true;
+
+  if (c == '-' || reader->PeekDigit())
+    return reader->ParseNumber(value);
+
+  return reader->Fail("unexpected character");
+}
+
+bool IsBareKeyChar(char c) {
+  return isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '-';
+}
+
+// Parse a dotted key, eg. gpio.P9_12 or pwm."pwm-4:0".
+bool ParseTomlKey(Reader* reader, std::vector<std::string>* key) {
+  do {
+    reader->SkipSpaces(false);
+    std::string part;
+    if (reader->Peek() == '"') {
+      if (!reader->ParseString('"', false, &part))
+        return false;
+    } else if (reader->Peek() == '\'') {
+      if (!reader->ParseString('\'', true, &part))
+        return false;
+    } else {
+      while (IsBareKeyChar(reader->Peek()))
+        part += reader->Next();
+      if (part.empty())
+        return reader->Fail("expected a key");
+    }
+    key->push_back(part);
+    reader->SkipSpaces(false);
+  } while (reader->Consume('.'));
+  return true;
+}
+
+// Returns the table at |key| from |root|, creating it as needed.
+bool FindTomlTable(Reader* reader,
+                   Value* root,
+                   const std::vector<std::string>& key,
+                   size_t size,
+                   Value** table) {
+  Value* current = root;
+  for (size_t i = 0; i < size; ++i) {
+    Value& child = (*current)[key[i]];
+    if (child.type == Value::Type::Null)
+      child.type = Value::Type::Object;
+    if (!child.is_object())
+      return reader->Fail("'" + key[i] + "' is not a table");
+    current = &child;
+  }
+  *table = current;
+  return true;
+}
+
+bool ParseTomlValue(Reader* reader, Value* value, int depth);
+
+bool ParseTomlKeyValue(Reader* reader, Value* table, int depth) {
+  std::vector<std::string> key;
+  if (!ParseTomlKey(reader, &key))
+    return false;
+  if (!reader->Consume('='))
+    return reader->Fail("expected '='");
+
+  Value* parent = nullptr;
+  if (!FindTomlTable(reader, table, key, key.size() - 1, &parent))
+    return false;
+  if (parent->Find(key.back()))
+    return reader->Fail("duplicate key '" + key.back() + "'");
+  return ParseTomlValue(reader, &(*parent)[key.back()], depth);
+}
+
+bool ParseTomlValue(Reader* reader, Value* value, int depth) {
+  if (depth > 32)
+    return reader->Fail("too deeply nested");
+
+  reader->SkipSpaces(false);
+  char c = reader->Peek();
+  if (c == '"' || c == '\'') {
+    value->type = Value::Type::String;
+    return reader->ParseString(c, c == '\'', &value->string);
+  }
+
+  if (c == '{') {
+    reader->Next();
+    value->type = Value::Type::Object;
+    reader->SkipSpaces(false);
+    if (reader->Consume('}'))
+      return true;
+    do {
+      if (!ParseTomlKeyValue(reader, value, depth + 1))
+        return false;
+      reader->SkipSpaces(false);
+    } while (reader->Consume(','));
+    if (!reader->Consume('}'))
+      return reader->Fail("expected ',' or '}'");
+    return true;
+  }
+
+  if (c == '[') {
+    reader->Next();
+    value->type = Value::Type::Array;
+    reader->SkipSpaces(true);
+    while (!reader->Consume(']')) {
+      value->array.emplace_back();
+      if (!ParseTomlValue(reader, &value->array.back(), depth + 1))
+        return false;
+      reader->SkipSpaces(true);
+      if (!reader->Consume(',') && reader->Peek() != ']')
+        return reader->Fail("expected ',' or ']'");
+      reader->SkipSpaces(true);
+    }
+    return true;
+  }
+
+  if (reader->ConsumeWord("true") || reader->ConsumeWord("false")) {
+    value->type = Value::Type::Bool;
+    value->boolean = c == 't';
+    return true;
+  }
+
+  if (c == '-' || c == '+' || reader->PeekDigit())
+    return reader->ParseNumber(value);
+
+  return reader->Fail("unexpected character");
+}
+
+// Skip the rest of a line, which may only contain a comment.
+bool EndTomlLine(Reader* reader) {
+  reader->SkipSpaces(false);
+  if (reader->Consume('#')) {
+    while (!reader->Done() && reader->Peek() != '\n')
+      reader->Next();
+  }
+  if (!reader->Done() && !reader->Consume('\n'))
+    return reader->Fail("expected the end of the line");
+  return true;
+}
+
+}  // namespace
+
+bool ParseJson(const std::string& input, Value* value, std::string* error) {
+  error->clear();
+  *value = Value();
+  Reader reader(input, error);
+  if (!ParseJsonValue(&reader, value, 0))
+    return false;
+  reader.SkipSpaces(true);
+  if (!reader.Done())
+    return reader.Fail("unexpected data after the document");
+  return true;
+}
+
+bool ParseToml(const std::string& input, Value* value, std::string* error) {
+  error->clear();
+  *value = Value();
+  value->type = Value::Type::Object;
+  Reader reader(input, error);
+  Value* table = value;
+
+  while (!reader.Done()) {
+    reader.SkipSpaces(false);
+    char c = reader.Peek();
+    if (c == '\n' || c == '#' || reader.Done()) {
+      if (!EndTomlLine(&reader))
+        return false;
+      continue;
+    }
+
+    if (reader.Consume('[')) {
+      if (reader.Peek() == '[')
+        return reader.Fail("arrays of tables are not supported");
+      std::vector<std::string> key;
+      if (!ParseTomlKey(&reader, &key))
+        return false;
+      if (!reader.Consume(']'))
+        return reader.Fail("expected ']'");
+      if (!FindTomlTable(&reader, value, key, key.size(), &table))
+        return false;
+    } else if (!ParseTomlKeyValue(&reader, table, 0)) {
+      return false;
+    }
+
+    if (!EndTomlLine(&reader))
+      return false;
+  }
+  return true;
+}
+
+}  // namespace profile
@@ -0,0 +1,46 @@
+#ifndef BEAGLE_CONFIG_PROFILE_VALUE_HPP
+#define BEAGLE_CONFIG_PROFILE_VALUE_HPP
+
+#include <string>
+#include <utility>
+#include <vector>
+
+// The document tree shared by the JSON and TOML readers of board profiles.
+namespace profile {
+
+struct Value {
+  enum class Type { Null, Bool, Number, String, Array, Object };
+
+  Type type = Type::Null;
+  bool boolean = false;
+  double number = 0;
+  std::string string;
+  std::vector<Value> array;
+  // Members in file order.
+  std::vector<std::pair<std::string, Value>> object;
+
+  bool is_object() const { return type == Type::Object; }
+
+  // Returns the member |key| of an object, or nullptr.
+  const Value* Find(const std::string& key) const;
+  Value* Find(const std::string& key);
+
+  // Returns the member |key|, inserting a null one if needed.
+  Value& operator[](const std::string& key);
+
+  // The value as written in the file, for strings, numbers and booleans.
+  std::string ToString() const;
+};
+
+// Parse |input|. On failure, returns false and sets |error| to a message
+// starting with the line number.
+bool ParseJson(const std::string& input, Value* value, std::string* error);
+
+// Parse the subset of TOML used by profiles: tables, dotted and quoted keys,
+// strings, numbers, booleans, arrays and inline tables. Arrays of tables and
+// dates are not supported.
+bool ParseToml(const std::string& input, Value* value, std::string* error);
+
+}  // namespace profile
+
+#endif /* end of include guard: BEAGLE_CONFIG_PROFILE_VALUE_HPP */
@@ -0,0 +1,87 @@
+#ifndef BEAGLE_CONFIG_RING_BUFFER_HPP
+#define BEAGLE_CONFIG_RING_BUFFER_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// The last |capacity| items pushed, in a buffer allocated once: pushing
+// overwrites the oldest item once full, in constant time. Not thread safe.
+template <typename T>
+class RingBuffer {
+ public:
+  explicit RingBuffer(size_t capacity)
+      : items_(std::max<size_t>(capacity, 1)) {}
+
+  void Push(const T& item) {
+    items_[next_] = item;
+    next_ = next_ + 1 == items_.size() ? 0 : next_ + 1;
+    size_ = std::min(size_ + 1, items_.size());
+  }
+
+  void Clear() {
+    next_ = 0;
+    size_ = 0;
+  }
+
+  size_t size() const { return size_; }
+  size_t capacity() const { return items_.size(); }
+
+  // The |index|th oldest item.
+  const T& operator[](size_t index) const { return items_[Physical(index)]; }
+
+  // The lowest and highest of some items.
+  struct Range {
+    T min;
+    T max;
+  };
+
+  // Reduce the |count| newest items into up to |columns| ranges, oldest
+  // first, for a plot of the envelope of the items: a spike shorter than a
+  // column still shows in its range. With fewer items than columns, there is
+  // a range per item.
+  void Envelope(size_t count,
+                size_t columns,
+                std::vector<Range>* ranges) const {
+    count = std::min(count, size_);
+    size_t first = size_ - count;
+    size_t reduced = std::min(count, columns);
+    ranges->resize(reduced);
+    for (size_t column = 0; column < reduced; ++column) {
+      size_t begin = first + column * count / reduced;
+      size_t end = first + (column + 1) * count / reduced;
+      (*ranges)[column] = Reduce(begin, end);
+    }
+  }
+
+ private:
+  size_t Physical(size_t index) const {
+    size_t physical = next_ + items_.size() - size_ + index;
+    return physical >= items_.size() ? physical - items_.size() : physical;
+  }
+
+  // The range of the items from |begin| to |end|, not empty, in at most two
+  // contiguous runs of the buffer.
+  Range Reduce(size_t begin, size_t end) const {
+    size_t physical = Physical(begin);
+    size_t remaining = end - begin;
+    Range range = {items_[physical], items_[physical]};
+    while (remaining) {
+      size_t run = std::min(remaining, items_.size() - physical);
+      const T* items = items_.data() + physical;
+      for (size_t i = 0; i < run; ++i) {
+        range.min = std::min(range.min, items[i]);
+        range.max = std::max(range.max, items[i]);
+      }
+      remaining -= run;
+      physical = 0;
+    }
+    return range;
+  }
+
+  std::vector<T> items_;
+  size_t next_ = 0;  // Where the next item goes.
+  size_t size_ = 0;
+};
+
+#endif /* end of include guard: BEAGLE_CONFIG_RING_BUFFER_HPP */
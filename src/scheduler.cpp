@@ -0,0 +1,133 @@
+#include "scheduler.hpp"
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdint>
+#include "trace.hpp"
+
+Scheduler::Scheduler() {
+  timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+  wake_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  thread_ = std::thread([this] { Run(); });
+}
+
+Scheduler::~Scheduler() {
+  Stop();
+  close(timer_fd_);
+  close(wake_fd_);
+}
+
+Scheduler::JobId Scheduler::Add(Clock::duration period,
+                                std::function<void()> job) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  JobId id = next_id_++;
+  jobs_[id] = {period, std::move(job), Clock::now(), Clock::time_point()};
+  return id;
+}
+
+void Scheduler::Remove(JobId id) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto it = jobs_.find(id);
+  if (it == jobs_.end())
+    return;
+  job_done_.wait(lock, [&] { return !it->second.running; });
+  jobs_.erase(it);
+}
+
+void Scheduler::Touch(JobId id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = jobs_.find(id);
+  if (it == jobs_.end())
+    return;
+
+  Job& job = it->second;
+  auto now = Clock::now();
+  if (job.visible_until < now) {
+    job.next_run = now;
+    Wake();
+  }
+  job.visible_until = now + 2 * job.period;
+}
+
+void Scheduler::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stop_)
+      return;
+    stop_ = true;
+    Wake();
+  }
+  thread_.join();
+}
+
+void Scheduler::Wake() {
+  uint64_t one = 1;
+  (void)!write(wake_fd_, &one, sizeof(one));
+}
+
+void Scheduler::ArmTimer(Clock::time_point deadline) {
+  itimerspec spec = {};
+  if (deadline != Clock::time_point::max()) {
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  deadline.time_since_epoch())
+                  .count();
+    // A zero it_value would disarm the timer.
+    ns = std::max<decltype(ns)>(ns, 1);
+    spec.it_value.tv_sec = ns / 1000000000;
+    spec.it_value.tv_nsec = ns % 1000000000;
+  }
+  timerfd_settime(timer_fd_, TFD_TIMER_ABSTIME, &spec, nullptr);
+}
+
+void Scheduler::Run() {
+  trace::SetThreadName("scheduler");
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stop_) {
+    // Run the visible jobs whose deadline passed, and find the next one.
+    auto now = Clock::now();
+    auto deadline = Clock::time_point::max();
+    for (auto& [id, job] : jobs_) {
+      if (job.visible_until < now)
+        continue;
+
+      if (job.next_run <= now) {
+        // Skip the periods missed rather than running the job in a burst.
+        while (job.next_run <= now)
+          job.next_run += job.period;
+
+        job.running = true;
+        auto run = job.run;
+        lock.unlock();
+        run();
+        lock.lock();
+        // |jobs_| may have changed, but Remove() waits for |running| so this
+        // job is still there.
+        job.running = false;
+        job_done_.notify_all();
+        if (stop_)
+          return;
+        // Restart the scan, as iterators may have been invalidated.
+        deadline = Clock::time_point();
+        break;
+      }
+      deadline = std::min(deadline, job.next_run);
+    }
+
+    if (deadline == Clock::time_point())
+      continue;
+
+    ArmTimer(deadline);
+    lock.unlock();
+    pollfd fds[] = {
+        {timer_fd_, POLLIN, 0},
+        {wake_fd_, POLLIN, 0},
+    };
+    poll(fds, 2, -1);
+    uint64_t value;
+    (void)!read(timer_fd_, &value, sizeof(value));
+    (void)!read(wake_fd_, &value, sizeof(value));
+    lock.lock();
+  }
+}
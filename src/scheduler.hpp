@@ -0,0 +1,66 @@
+#ifndef BEAGLE_CONFIG_SCHEDULER_HPP
+#define BEAGLE_CONFIG_SCHEDULER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+
+// Run periodic hardware polling jobs from a single thread. The thread sleeps
+// on a timerfd armed at the nearest deadline, instead of every job owning a
+// sleeping thread.
+//
+// A job only runs while it is visible: Touch() makes it visible for a couple
+// of periods, and is meant to be called when the panel owning the job is
+// rendered. Hidden jobs cost nothing.
+class Scheduler {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using JobId = int;
+
+  Scheduler();
+  ~Scheduler();
+
+  Scheduler(const Scheduler&) = delete;
+  Scheduler& operator=(const Scheduler&) = delete;
+
+  // Register |job| to run every |period|. It starts hidden.
+  JobId Add(Clock::duration period, std::function<void()> job);
+
+  // Unregister a job. Waits for it to complete if it is running.
+  void Remove(JobId id);
+
+  // Keep the job running for two more periods. Runs it immediately if it was
+  // hidden.
+  void Touch(JobId id);
+
+  // Cancel every job and stop the thread without waiting for any deadline.
+  void Stop();
+
+ private:
+  struct Job {
+    Clock::duration period;
+    std::function<void()> run;
+    Clock::time_point next_run;
+    Clock::time_point visible_until;
+    bool running = false;
+  };
+
+  void Run();
+  void Wake();
+  void ArmTimer(Clock::time_point deadline);
+
+  std::mutex mutex_;
+  std::condition_variable job_done_;
+  std::map<JobId, Job> jobs_;
+  JobId next_id_ = 0;
+  bool stop_ = false;
+
+  int timer_fd_ = -1;
+  int wake_fd_ = -1;
+  std::thread thread_;
+};
+
+#endif /* end of include guard: BEAGLE_CONFIG_SCHEDULER_HPP */
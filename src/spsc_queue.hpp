@@ -0,0 +1,57 @@
+#ifndef BEAGLE_CONFIG_SPSC_QUEUE_HPP
+#define BEAGLE_CONFIG_SPSC_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// A bounded lock-free queue between a single producer thread and a single
+// consumer thread, e.g. from a thread waiting on hardware events to the UI.
+// Neither side ever blocks: Push() fails when the queue is full, and Pop()
+// when it is empty.
+template <typename T>
+class SpscQueue {
+ public:
+  // |capacity| is rounded up to a power of two.
+  explicit SpscQueue(size_t capacity) {
+    size_t size = 1;
+    while (size < capacity)
+      size *= 2;
+    items_.resize(size);
+    mask_ = size - 1;
+  }
+
+  SpscQueue(const SpscQueue&) = delete;
+  SpscQueue& operator=(const SpscQueue&) = delete;
+
+  // Producer side.
+  bool Push(const T& item) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) > mask_)
+      return false;
+    items_[tail & mask_] = item;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side.
+  bool Pop(T* item) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire))
+      return false;
+    *item = items_[head & mask_];
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  size_t capacity() const { return mask_ + 1; }
+
+ private:
+  std::vector<T> items_;
+  size_t mask_ = 0;
+  // On separate cache lines, for the two threads not to share them.
+  alignas(64) std::atomic<size_t> head_{0};
+  alignas(64) std::atomic<size_t> tail_{0};
+};
+
+#endif /* end of include guard: BEAGLE_CONFIG_SPSC_QUEUE_HPP */
@@ -0,0 +1,57 @@
+#include "thread_pool.hpp"
+#include <algorithm>
+#include "trace.hpp"
+
+ThreadPool::ThreadPool(size_t size) {
+  for (size_t i = 0; i < std::max<size_t>(size, 1); ++i)
+    threads_.emplace_back([this] { Run(); });
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+    tasks_.clear();
+  }
+  task_available_.notify_all();
+  for (auto& thread : threads_)
+    thread.join();
+}
+
+void ThreadPool::Post(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(std::move(task));
+  }
+  task_available_.notify_one();
+}
+
+void ThreadPool::Wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_.wait(lock, [this] { return tasks_.empty() && running_ == 0; });
+}
+
+size_t ThreadPool::DefaultSize() {
+  return std::clamp<size_t>(std::thread::hardware_concurrency(), 2, 4);
+}
+
+void ThreadPool::Run() {
+  trace::SetThreadName("thread pool");
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    task_available_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+    if (stop_)
+      return;
+
+    auto task = std::move(tasks_.front());
+    tasks_.pop_front();
+    running_++;
+    lock.unlock();
+    task();
+    task = nullptr;
+    lock.lock();
+    running_--;
+    if (tasks_.empty() && running_ == 0)
+      idle_.notify_all();
+  }
+}
@@ -0,0 +1,43 @@
+#ifndef BEAGLE_CONFIG_THREAD_POOL_HPP
+#define BEAGLE_CONFIG_THREAD_POOL_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A small fixed-size pool of worker threads running tasks in FIFO order.
+// Destroying the pool drops the tasks not started yet and waits for the
+// running ones.
+class ThreadPool {
+ public:
+  explicit ThreadPool(size_t size = DefaultSize());
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  void Post(std::function<void()> task);
+
+  // Block until every posted task has completed.
+  void Wait();
+
+  // Most panels wait on I/O rather than the CPU, so use a few threads even on
+  // single core boards.
+  static size_t DefaultSize();
+
+ private:
+  void Run();
+
+  std::mutex mutex_;
+  std::condition_variable task_available_;
+  std::condition_variable idle_;
+  std::deque<std::function<void()>> tasks_;
+  size_t running_ = 0;
+  bool stop_ = false;
+  std::vector<std::thread> threads_;
+};
+
+#endif /* end of include guard: BEAGLE_CONFIG_THREAD_POOL_HPP */
@@ -0,0 +1,207 @@
+#include "trace.hpp"
+#include <unistd.h>
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+namespace trace {
+
+namespace internal {
+std::atomic<bool> enabled{false};
+}  // namespace internal
+
+namespace {
+
+struct Event {
+  const char* name;
+  const char* arg;
+  int64_t begin;
+  int64_t end;
+};
+
+// Events are appended to a list of fixed size chunks owned by a single
+// thread. The writer publishes each event by bumping |size| with release
+// semantics, so Stop() can read them while the thread keeps running.
+struct Chunk {
+  static constexpr size_t kCapacity = 1024;
+  std::atomic<size_t> size{0};
+  std::atomic<Chunk*> next{nullptr};
+  Event events[kCapacity];
+};
+
+// Past this, events are counted but dropped to bound memory usage.
+constexpr size_t kMaxChunksPerThread = 1024;
+
+struct Buffer {
+  int tid = 0;
+  std::string thread_name;
+  std::unique_ptr<Chunk> head = std::make_unique<Chunk>();
+  Chunk* tail = head.get();
+  size_t chunks = 1;
+  std::atomic<size_t> dropped{0};
+
+  ~Buffer() {
+    Chunk* chunk = head->next.load();
+    while (chunk) {
+      Chunk* next = chunk->next.load();
+      delete chunk;
+      chunk = next;
+    }
+  }
+};
+
+// Only taken the first time a thread records something, or to name it.
+std::mutex registry_mutex;
+std::vector<std::unique_ptr<Buffer>> registry;
+std::string output_path;
+
+thread_local Buffer* thread_buffer = nullptr;
+
+Buffer* ThreadBuffer() {
+  if (!thread_buffer) {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    registry.push_back(std::make_unique<Buffer>());
+    thread_buffer = registry.back().get();
+    thread_buffer->tid = static_cast<int>(registry.size());
+  }
+  return thread_buffer;
+}
+
+void WriteEscaped(std::ostream& out, const char* str) {
+  for (; *str; ++str) {
+    switch (*str) {
+      case '"':
+        out << "\\\"";
+        break;
+      case '\\':
+        out << "\\\\";
+        break;
+      case '\n':
+        out << "\\n";
+        break;
+      default:
+        if (static_cast<unsigned char>(*str) >= 0x20)
+          out << *str;
+    }
+  }
+}
+
+}  // namespace
+
+namespace internal {
+
+void Record(const char* name, const char* arg, int64_t begin, int64_t end) {
+  Buffer* buffer = ThreadBuffer();
+  Chunk* chunk = buffer->tail;
+  size_t size = chunk->size.load(std::memory_order_relaxed);
+  if (size == Chunk::kCapacity) {
+    if (buffer->chunks == kMaxChunksPerThread) {
+      buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    auto* next = new Chunk;
+    chunk->next.store(next, std::memory_order_release);
+    buffer->tail = chunk = next;
+    buffer->chunks++;
+    size = 0;
+  }
+  chunk->events[size] = {name, arg, begin, end};
+  chunk->size.store(size + 1, std::memory_order_release);
+}
+
+}  // namespace internal
+
+void Start(const std::string& path) {
+  output_path = path;
+  internal::enabled = true;
+}
+
+bool Stop() {
+  if (!internal::enabled.exchange(false))
+    return true;
+
+  std::ofstream out(output_path);
+  if (!out)
+    return false;
+
+  const int pid = getpid();
+  std::lock_guard<std::mutex> lock(registry_mutex);
+
+  // Timestamps are made relative to the first event to keep them short.
+  // Events are recorded as their span closes, after the spans nested in it:
+  // the earliest begins anywhere in the buffers.
+  int64_t origin = INT64_MAX;
+  for (const auto& buffer : registry) {
+    for (const Chunk* chunk = buffer->head.get(); chunk;
+         chunk = chunk->next.load(std::memory_order_acquire)) {
+      size_t size = chunk->size.load(std::memory_order_acquire);
+      for (size_t i = 0; i < size; ++i)
+        origin = std::min(origin, chunk->events[i].begin);
+    }
+  }
+
+  out << std::fixed << std::setprecision(3);
+  out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  const char* separator = "\n";
+  for (const auto& buffer : registry) {
+    if (!buffer->thread_name.empty()) {
+      out << separator << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":"
+          << pid << ",\"tid\":" << buffer->tid << ",\"args\":{\"name\":\"";
+      WriteEscaped(out, buffer->thread_name.c_str());
+      out << "\"}}";
+      separator = ",\n";
+    }
+
+    for (const Chunk* chunk = buffer->head.get(); chunk;
+         chunk = chunk->next.load(std::memory_order_acquire)) {
+      size_t size = chunk->size.load(std::memory_order_acquire);
+      for (size_t i = 0; i < size; ++i) {
+        const Event& event = chunk->events[i];
+        out << separator << "{\"name\":\"";
+        WriteEscaped(out, event.name);
+        out << "\",\"cat\":\"bb-config\",\"ph\":\"X\",\"ts\":"
+            << (event.begin - origin) / 1000.0
+            << ",\"dur\":" << (event.end - event.begin) / 1000.0
+            << ",\"pid\":" << pid << ",\"tid\":" << buffer->tid;
+        if (event.arg) {
+          out << ",\"args\":{\"detail\":\"";
+          WriteEscaped(out, event.arg);
+          out << "\"}";
+        }
+        out << "}";
+        separator = ",\n";
+      }
+    }
+
+    if (size_t dropped = buffer->dropped.load()) {
+      out << separator << "{\"name\":\"dropped " << dropped
+          << " events\",\"ph\":\"i\",\"s\":\"t\",\"ts\":0,\"pid\":" << pid
+          << ",\"tid\":" << buffer->tid << "}";
+    }
+  }
+  out << "\n]}\n";
+
+  return out.good();
+}
+
+const char* Intern(const std::string& str) {
+  static std::mutex mutex;
+  static std::unordered_set<std::string> strings;
+  std::lock_guard<std::mutex> lock(mutex);
+  return strings.insert(str).first->c_str();
+}
+
+void SetThreadName(const std::string& name) {
+  if (!Enabled())
+    return;
+  Buffer* buffer = ThreadBuffer();
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  buffer->thread_name = name;
+}
+
+}  // namespace trace
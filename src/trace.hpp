@@ -0,0 +1,80 @@
+#ifndef BEAGLE_CONFIG_TRACE_HPP
+#define BEAGLE_CONFIG_TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Lightweight scoped-span tracing, written as Chrome/Perfetto trace-event
+// JSON. Usage:
+//
+//   void Foo() {
+//     TRACE_SCOPE("Foo");
+//     ...
+//   }
+//
+// Each thread records into its own buffer without taking any lock, so tracing
+// does not serialize the threads it observes. When tracing is not started, a
+// span costs a single relaxed atomic load.
+namespace trace {
+
+namespace internal {
+extern std::atomic<bool> enabled;
+void Record(const char* name, const char* arg, int64_t begin, int64_t end);
+}  // namespace internal
+
+// Start recording spans. They are written to |path| by Stop().
+void Start(const std::string& path);
+
+// Stop recording and write the trace file. Returns false on I/O error.
+bool Stop();
+
+inline bool Enabled() {
+  return internal::enabled.load(std::memory_order_relaxed);
+}
+
+// Return a copy of |str| living until the program exits, usable as a span
+// name or argument. It takes a lock, so call it outside of hot paths.
+const char* Intern(const std::string& str);
+
+// Name the calling thread in the trace viewer.
+void SetThreadName(const std::string& name);
+
+inline int64_t Now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Record a span covering the lifetime of the object. |name| and |arg| must
+// outlive the program: use string literals or Intern().
+class Scope {
+ public:
+  explicit Scope(const char* name, const char* arg = nullptr)
+      : name_(Enabled() ? name : nullptr), arg_(arg) {
+    if (name_)
+      begin_ = Now();
+  }
+  ~Scope() {
+    if (name_)
+      internal::Record(name_, arg_, begin_, Now());
+  }
+
+  Scope(const Scope&) = delete;
+  Scope& operator=(const Scope&) = delete;
+
+ private:
+  const char* name_;
+  const char* arg_;
+  int64_t begin_ = 0;
+};
+
+}  // namespace trace
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(...) \
+  trace::Scope TRACE_CONCAT(trace_scope_, __LINE__)(__VA_ARGS__)
+
+#endif /* end of include guard: BEAGLE_CONFIG_TRACE_HPP */
@@ -0,0 +1,80 @@
+#include "uenv/uenv.hpp"
+#include <algorithm>
+#include <cctype>
+#include <unordered_map>
+#include "trace.hpp"
+
+namespace uenv {
+
+namespace {
+
+const char OverlaysMarker[] = "###U-Boot Overlays###";
+const char SectionEnd[] = "###";
+
+bool StartsWith(const std::string& line, const char* prefix) {
+  return line.compare(0, std::char_traits<char>::length(prefix), prefix) == 0;
+}
+
+std::string StripHashes(const std::string& line) {
+  std::string stripped = line;
+  stripped.erase(std::remove(stripped.begin(), stripped.end(), '#'),
+                 stripped.end());
+  return stripped;
+}
+
+}  // namespace
+
+bool IsSectionHeader(const std::string& line) {
+  return line.size() > 3 && StartsWith(line, "###") &&
+         isupper(static_cast<unsigned char>(line[3]));
+}
+
+bool IsComment(const std::string& line) {
+  return line.size() > 3 && StartsWith(line, "###") &&
+         islower(static_cast<unsigned char>(line[3]));
+}
+
+std::vector<Section> Parse(std::istream& in) {
+  TRACE_SCOPE("uenv::Parse");
+  std::vector<std::string> lines;
+  std::string line;
+  while (std::getline(in, line))
+    lines.push_back(std::move(line));
+
+  // The section titles, up to the end of the overlay block. The documentation
+  // link and the markers of the block are not sections.
+  std::vector<Section> sections;
+  bool in_overlays = false;
+  for (const auto& it : lines) {
+    if (it == OverlaysMarker) {
+      if (in_overlays)
+        break;
+      in_overlays = true;
+      continue;
+    }
+    if (IsSectionHeader(it) && !StartsWith(it, "###Documentation"))
+      sections.push_back({StripHashes(it), {}});
+  }
+
+  // Where each title first appears.
+  std::unordered_map<std::string, size_t> headers;
+  for (size_t i = 0; i < lines.size(); ++i) {
+    if (IsSectionHeader(lines[i]))
+      headers.emplace(StripHashes(lines[i]), i);
+  }
+
+  for (auto& section : sections) {
+    for (size_t i = headers[section.name] + 1; i < lines.size(); ++i) {
+      const std::string& option = lines[i];
+      if (option == OverlaysMarker || option == SectionEnd)
+        break;
+      if (IsComment(option))
+        continue;
+      section.options.push_back(
+          {StripHashes(option), !option.empty() && option[0] == '#'});
+    }
+  }
+  return sections;
+}
+
+}  // namespace uenv
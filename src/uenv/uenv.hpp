@@ -0,0 +1,44 @@
+#ifndef BEAGLE_CONFIG_UENV_HPP
+#define BEAGLE_CONFIG_UENV_HPP
+
+#include <istream>
+#include <string>
+#include <vector>
+
+// The U-Boot overlay section of /boot/uEnv.txt:
+//
+//   ###U-Boot Overlays###
+//   ###Master Enable
+//   enable_uboot_overlays=1
+//   ###
+//   ###Disable auto loading of virtual capes (emmc/video/wireless/adc)
+//   #disable_uboot_overlay_emmc=1
+//   ###
+//   ###U-Boot Overlays###
+//
+// Each "###<Title>" starts a section of options, ended by "###". An option is
+// disabled by commenting it out.
+namespace uenv {
+
+struct Option {
+  std::string name;  // The line without its '#', eg. enable_uboot_overlays=1
+  bool commented;
+};
+
+struct Section {
+  std::string name;  // The title without its '#', eg. Master Enable
+  std::vector<Option> options;
+};
+
+// Whether |line| starts a section, eg. "###Master Enable".
+bool IsSectionHeader(const std::string& line);
+
+// Whether |line| is a comment inside a section, eg. "###note".
+bool IsComment(const std::string& line);
+
+// Parse the sections of the overlay block, in the order of the file.
+std::vector<Section> Parse(std::istream& in);
+
+}  // namespace uenv
+
+#endif /* end of include guard: BEAGLE_CONFIG_UENV_HPP */
@@ -60,7 +60,7 @@ class AboutImpl : public PanelBase {
     Add(viewLogo);
   }
   ~AboutImpl(){};
-  std::string Title() override { return "About"; }
+  std::string Title() override { return panel::title::About; }
   Element RenderBackground() {
     Elements elements;
     for (const std::string& it : logo) {
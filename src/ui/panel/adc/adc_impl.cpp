@@ -1,17 +1,28 @@
+#include <algorithm>
 #include <chrono>
 #include <cmath>
+#include <cstdio>
 #include <cstdlib>
 #include <filesystem>
 #include <fstream>
 #include <functional>
+#include <iterator>
 #include <memory>
 #include <regex>
 #include <sstream>
 #include <vector>
 
+#include "dsp/fft.hpp"
+#include "dsp/stats.hpp"
 #include "ftxui/component/component.hpp"
 #include "ftxui/dom/elements.hpp"
+#include "hw/iio.hpp"
+#include "hw/root.hpp"
+#include "hw/sysfs.hpp"
 #include "process.hpp"
+#include "ring_buffer.hpp"
+#include "scheduler.hpp"
+#include "trace.hpp"
 #include "ui/panel/panel.hpp"
 
 using namespace ftxui;
@@ -19,13 +30,15 @@ using namespace std::chrono_literals;
 
 namespace ui {
 
-const std::string Analog_Path = "/sys/bus/iio/devices/iio:device0";
+std::string Analog_Path() {
+  return hw::Rooted("/sys/bus/iio/devices/iio:device0");
+}
 const int Max_Analog = 4095;
 
 std::vector<std::string> FindAnalogs() {
   std::vector<std::string> names;
 
-  for (const auto& it : std::filesystem::directory_iterator(Analog_Path)) {
+  for (const auto& it : std::filesystem::directory_iterator(Analog_Path())) {
     std::stringstream ss(it.path());
     std::string name;
 
@@ -40,69 +53,254 @@ std::vector<std::string> FindAnalogs() {
   return names;
 }
 
+// The samples displayed, from the most recent.
+const std::vector<std::string> windowEntries = {
+    "400",
+    "4 k",
+    "40 k",
+    "100 k",
+};
+const size_t windows[] = {400, 4000, 40000, 100000};
+
+// Polled reads in_voltageN_raw every second, Streaming reads the scans of the
+// buffer of the device as it samples.
+const std::vector<std::string> modeEntries = {
+    "Polled",
+    "Streaming",
+};
+
+// Time plots the samples, Spectrum the amplitudes of their frequencies.
+const std::vector<std::string> viewEntries = {
+    "Time",
+    "Spectrum",
+};
+
+// The samples of the FFT of the spectrum, from the most recent.
+const std::vector<std::string> fftEntries = {
+    "1 k",
+    "4 k",
+    "16 k",
+};
+const size_t fftSizes[] = {1024, 4096, 16384};
+
+const std::vector<std::string> fftWindowEntries = {
+    "Hann",
+    "Blackman",
+};
+const dsp::Window fftWindows[] = {dsp::Window::Hann, dsp::Window::Blackman};
+
+// The range of the spectrum, from the full scale of the ADC.
+const double spectrumFloor = -120;
+
+double Dbfs(double amplitude) {
+  return amplitude > 0 ? 20 * std::log10(amplitude / Max_Analog)
+                       : spectrumFloor;
+}
+
+// eg. "50.0 Hz" or "12.50 kHz".
+std::string FormatFrequency(double hz) {
+  char line[32];
+  if (hz >= 1000)
+    snprintf(line, sizeof(line), "%.2f kHz", hz / 1000);
+  else
+    snprintf(line, sizeof(line), "%.1f Hz", hz);
+  return line;
+}
+
+// Plot the amplitudes of the bins 1 to Nyquist over the width of |canvas|, in
+// dBFS: each column shows the highest of its bins, for a narrow line not to
+// fall between the columns.
+void DrawSpectrum(Canvas& canvas, const std::vector<float>& amplitudes) {
+  TRACE_SCOPE("DrawSpectrum");
+  int width = canvas.width();
+  int height = canvas.height();
+  if (width <= 0 || height <= 0 || amplitudes.size() < 2)
+    return;
+  size_t bins = amplitudes.size() - 1;
+  size_t columns = std::min<size_t>(bins, width);
+  for (size_t column = 0; column < columns; ++column) {
+    size_t begin = 1 + column * bins / columns;
+    size_t end = 1 + (column + 1) * bins / columns;
+    float highest = 0;
+    for (size_t k = begin; k < end; ++k)
+      highest = std::max(highest, amplitudes[k]);
+    double level = std::clamp(Dbfs(highest), spectrumFloor, 0.0);
+    int x = column * (width - 1) / std::max<size_t>(columns - 1, 1);
+    int y = static_cast<int>(level / spectrumFloor * (height - 1));
+    canvas.DrawPointLine(x, height - 1, x, y);
+  }
+}
+
+// Plot the envelope of the last |window| samples of |data| over the width of
+// |canvas|: each column spans from the lowest to the highest of its samples,
+// so that a window of any length draws in the same time, without losing the
+// spikes. |ranges| is reused across frames.
+void DrawEnvelope(Canvas& canvas,
+                  const RingBuffer<int>& data,
+                  size_t window,
+                  const Color& color,
+                  std::vector<RingBuffer<int>::Range>* ranges) {
+  TRACE_SCOPE("DrawEnvelope");
+  int width = canvas.width();
+  int height = canvas.height();
+  if (width <= 0 || height <= 0)
+    return;
+  // The columns of the window, and those with samples yet, on the right.
+  size_t columns = std::min<size_t>(window, width);
+  size_t available = std::min(data.size(), window);
+  size_t filled = available * columns / window;
+  if (available && !filled)
+    filled = 1;
+  data.Envelope(available, filled, ranges);
+  if (ranges->empty())
+    return;
+
+  auto y = [height](int value) {
+    value = std::clamp(value, 0, Max_Analog);
+    return (height - 1) - value * (height - 1) / Max_Analog;
+  };
+  int offset = static_cast<int>(columns - ranges->size());
+  auto x = [&](size_t column) {
+    return (offset + static_cast<int>(column)) * (width - 1) /
+           std::max(static_cast<int>(columns) - 1, 1);
+  };
+  for (size_t i = 0; i < ranges->size(); ++i) {
+    auto range = (*ranges)[i];
+    if (i > 0) {
+      // Join the previous column, for the trace to be continuous.
+      const auto& previous = (*ranges)[i - 1];
+      if (x(i) - x(i - 1) > 1) {
+        canvas.DrawPointLine(x(i - 1), y(previous.max), x(i), y(range.min),
+                             color);
+      } else {
+        range.min = std::min(range.min, previous.max);
+        range.max = std::max(range.max, previous.min);
+      }
+    }
+    canvas.DrawPointLine(x(i), y(range.min), x(i), y(range.max), color);
+  }
+}
+
+// The rows of the histogram of RenderStats(), from the bins of the stats.
+const size_t histogramRows = 16;
+
+// The statistics of the samples of a channel, in volts, with their histogram
+// from the highest values down, to read along the graph.
+Element RenderStats(const dsp::Stats& stats, const Color& foreground) {
+  auto volts = [](double value) {
+    char line[16];
+    snprintf(line, sizeof(line), "%.3f V", value * 1.8 / Max_Analog);
+    return std::string(line);
+  };
+  auto row = [](const std::string& label, const std::string& value) {
+    return hbox(text(label), filler(), text(value));
+  };
+
+  Elements rows = {
+      row("Samples ", std::to_string(stats.count())),
+      row("Mean ", volts(stats.mean())),
+      row("Min ", volts(stats.min())),
+      row("Max ", volts(stats.max())),
+      row("RMS ", volts(stats.rms())),
+      row("Std dev ", volts(stats.stddev())),
+      separator(),
+  };
+
+  const auto& histogram = stats.histogram();
+  size_t per_row = (histogram.size() + histogramRows - 1) / histogramRows;
+  std::vector<uint64_t> counts;
+  for (size_t i = 0; i < histogram.size(); i += per_row) {
+    uint64_t count = 0;
+    for (size_t j = i; j < std::min(i + per_row, histogram.size()); ++j)
+      count += histogram[j];
+    counts.push_back(count);
+  }
+  uint64_t highest = counts.empty()
+                         ? 0
+                         : *std::max_element(counts.begin(), counts.end());
+  for (size_t i = counts.size(); i-- > 0;) {
+    float fraction = highest ? float(counts[i]) / highest : 0;
+    rows.push_back(hbox({
+        text(volts(double(i * per_row * stats.bin_width())) + " "),
+        gauge(fraction) | color(foreground) | flex,
+    }));
+  }
+  rows.push_back(text(std::string("Kernel: ") + dsp::ReduceKernel()) | dim);
+  return vbox(std::move(rows)) | size(WIDTH, EQUAL, 22);
+}
+
 // Graph class for handling how value stores and display in graph
 class Graph {
  public:
-  std::vector<int> operator()(int width, int height) const {
-    std::vector<int> output(width);
-    for (int i = 0; i < width; ++i) {
-      if (i >= (int)data_vect.size())
-        break;
-
-      float v = 0;
-      v += (float)data_vect[i];
-      v -= hScale_start_;
-      v /= Max_Analog;
-      v *= height;
-
-      for (int j = 0; j < sample_; j++) {
-        if (i * sample_ + j >= width)
-          break;
-        output[i * sample_ + j] = static_cast<int>(v);
-      }
-    }
-    return output;
+  void Draw(Canvas& canvas, size_t window) const {
+    DrawEnvelope(canvas, data_, window, Color::Default, &ranges_);
+  }
+
+  // Sample the analog input. Called from the scheduler thread.
+  int read() const {
+    TRACE_SCOPE("Graph::read");
+    int value = 0;
+    std::ifstream(Analog_Path() + "/" + name_) >> value;
+    return value;
   }
-  int shift = 0;
 
-  void update() {
-    int value;
-    std::ifstream(Analog_Path + "/" + name_) >> value;
-    data_vect.pop_back();
-    data_vect.insert(data_vect.begin(), value);
+  void update(int value) { data_.Push(value); }
+
+  size_t size() const { return data_.size(); }
+
+  // The |count| latest samples, oldest first, to |samples|.
+  void Latest(size_t count, float* samples) const {
+    size_t first = data_.size() - count;
+    for (size_t i = 0; i < count; ++i)
+      samples[i] = data_[first + i];
   }
 
   // Update name for graph page
   void set_name(std::string input) { name_ = input; }
 
-  // change the value for x-axis scale
-  void set_sample(int sample) { sample_ = sample; }
-
   // Clear all the stored data
-  void reset() {
-    for (auto& item : data_vect) {
-      item = 0;
-    }
-  }
+  void reset() { data_.Clear(); }
 
  private:
-  std::vector<int> data_vect = std::vector<int>(400, 0);
+  RingBuffer<int> data_{windows[std::size(windows) - 1]};
+  mutable std::vector<RingBuffer<int>::Range> ranges_;  // Of Draw().
   std::string name_;
-  int sample_;
-  int hScale_start_;
 };
 
 // graphImpl class handles the page UI for the graph
 class graphImpl : public ComponentBase {
  public:
-  graphImpl(std::string name, int* tab, ScreenInteractive* screen)
-      : name_(name), tab_(tab), screen_(screen) {
+  // |claim| is called before streaming, for the other views to stop streaming
+  // the device.
+  graphImpl(std::string name,
+            int* tab,
+            ScreenInteractive* screen,
+            Scheduler* scheduler,
+            PanelBase* panel,
+            std::function<void(graphImpl*)> claim)
+      : name_(name),
+        claim_(std::move(claim)),
+        tab_(tab),
+        screen_(screen),
+        scheduler_(scheduler),
+        panel_(panel) {
     my_graph.set_name(name_);
+    MenuOption modeOpt = MenuOption::Toggle();
+    modeOpt.on_change = [this] { Update(); };
+    mode_toggle_ = Menu(&modeEntries, &mode_, modeOpt);
     Add(Container::Vertical({
-        Container::Horizontal({
-            x_scaleDown_,
-            x_scaleUp_,
-        }),
+        mode_toggle_,
+        view_toggle_,
+        // The controls of the view displayed only.
+        Container::Tab(
+            {
+                window_toggle_,
+                Container::Vertical({
+                    fft_toggle_,
+                    fft_window_toggle_,
+                }),
+            },
+            &view_),
         Container::Horizontal({
             button_,
             reset_,
@@ -113,29 +311,35 @@ class graphImpl : public ComponentBase {
   }
 
   ~graphImpl() {
-    // Clear all actuive threads before exit
-    refresh_ui_continue_ = false;
-    graph_update_.join();
+    scheduler_->Remove(job_);
+    stream_.reset();
   };
 
   std::string label() const { return name_; }
 
+  // Go back to polling, for another view to stream the device.
+  void StopStream() {
+    if (mode_ == 0)
+      return;
+    mode_ = 0;
+    Update();
+  }
+
+  // Start streaming again, if Leave() stopped it.
+  void Resume() {
+    if (paused_)
+      Update();
+  }
+
   Element Render() override {
-    return vbox({
-        hbox({
-            vbox({
-                text("scale: " + std::to_string(sample_)),
-                hbox({
-                    x_scaleDown_->Render(),
-                    x_scaleUp_->Render(),
-                }),
-            }),
-        }),
+    scheduler_->Touch(job_);
+    if (view_ == 1)
+      return RenderFrame(RenderSpectrum());
+    return RenderFrame(vbox({
+        hbox(text("Window: "), window_toggle_->Render()),
+        RenderStream(),
         separator(),
-        hbox({
-            text(name_),
-            text(" [Hz]"),
-        }) | hcenter,
+        text(name_) | hcenter,
         hbox({
             vbox({
                 text("1.8v "),
@@ -144,15 +348,27 @@ class graphImpl : public ComponentBase {
                 filler(),
                 text("0.0v "),
             }),
-            graph(std::ref(my_graph)) | flex,
+            canvas([this](Canvas& c) {
+              my_graph.Draw(c, windows[window_]);
+            }) | flex,
+            separator(),
+            RenderStats(stats_, Color::Default),
         }) | flex,
         hbox({
-            text(std::to_string(0 / sample_) + "Hz "),
-            filler(),
-            text(std::to_string(150 / sample_) + "Hz "),
+            text("-" + windowEntries[window_] + " samples"),
             filler(),
-            text(std::to_string(300 / sample_) + "Hz "),
+            text("now"),
         }),
+    }));
+  }
+
+ private:
+  // The controls common to the views around |view|.
+  Element RenderFrame(Element view) {
+    return vbox({
+        hbox(text("Mode: "), mode_toggle_->Render()),
+        hbox(text("View: "), view_toggle_->Render()),
+        view | flex,
         separator(),
         hbox({
             button_->Render() | flex,
@@ -161,81 +377,559 @@ class graphImpl : public ComponentBase {
     });
   }
 
- private:
+  Element RenderSpectrum() {
+    Elements controls = {
+        hbox(text("FFT: "), fft_toggle_->Render(), text(" samples ")),
+        hbox(text("Window: "), fft_window_toggle_->Render()),
+    };
+    double rate = Rate();
+    size_t size = fftSizes[fft_size_];
+    Element readout;
+    if (UpdateSpectrum()) {
+      double peak = spectrum_->Peak();
+      float amplitude = spectrum_->amplitudes()[std::lround(peak)];
+      char line[96];
+      snprintf(line, sizeof(line), "Peak: %s, %.1f dBFS, THD: %.2f %%",
+               FormatFrequency(peak * rate / size).c_str(), Dbfs(amplitude),
+               100 * spectrum_->Thd(peak));
+      readout = text(line);
+    } else {
+      readout = text("Waiting for " + fftEntries[fft_size_] + " samples");
+    }
+
+    return vbox({
+        hbox(std::move(controls)),
+        RenderStream(),
+        separator(),
+        hbox(text(name_), text(" "), readout) | hcenter,
+        hbox({
+            vbox({
+                text("   0 dB "),
+                filler(),
+                text(" -60 dB "),
+                filler(),
+                text("-120 dB "),
+            }),
+            canvas([this](Canvas& c) {
+              if (spectrum_ && my_graph.size() >= spectrum_->size())
+                DrawSpectrum(c, spectrum_->amplitudes());
+            }) | flex,
+        }) | flex,
+        hbox({
+            text("0 Hz"),
+            filler(),
+            text(std::string("Kernel: ") + dsp::FftKernel()) | dim,
+            filler(),
+            text(FormatFrequency(rate / 2)),
+        }),
+    });
+  }
+
+  // Compute the spectrum of the latest samples, if any came since the last
+  // frame. Returns false while there are fewer than the size of the FFT.
+  bool UpdateSpectrum() {
+    size_t size = fftSizes[fft_size_];
+    dsp::Window window = fftWindows[fft_window_];
+    if (!spectrum_ || spectrum_->size() != size ||
+        spectrum_->window() != window) {
+      spectrum_ = std::make_unique<dsp::Spectrum>(size, window);
+      latest_.resize(size);
+      computed_ = ~uint64_t(0);
+    }
+    if (my_graph.size() < size)
+      return false;
+    if (computed_ != pushed_) {
+      my_graph.Latest(size, latest_.data());
+      spectrum_->Compute(latest_.data());
+      computed_ = pushed_;
+    }
+    return true;
+  }
+
+  // The samples per second of the graph.
+  double Rate() const {
+    if (!stream_)
+      return 1.0 / std::chrono::duration<double>(PollPeriod).count();
+    int64_t elapsed = stream_->elapsed_ns();
+    return elapsed ? stream_->scans() * 1e9 / elapsed : 0;
+  }
+
+  // Stop the stream when the page is left, rather than queueing scans nobody
+  // looks at. It starts again on Resume().
+  void Leave() {
+    if (!stream_)
+      return;
+    scheduler_->Remove(job_);
+    job_ = -1;
+    stream_.reset();
+    paused_ = true;
+  }
+
   // Handle auto refresh the page with custome event
   void Update() {
-    refresh_ui_continue_ = true;
+    if (job_ >= 0)
+      scheduler_->Remove(job_);
+    job_ = -1;
+    stream_.reset();
+    status_.clear();
+    paused_ = false;
+
+    if (mode_ == 1) {
+      claim_(this);
+      // The samples before are not contiguous with the stream.
+      my_graph.reset();
+      // eg. in_voltage0_raw -> voltage0
+      std::string channel = name_.substr(3, name_.size() - 7);
+      stream_ = std::make_unique<hw::iio::Stream>(
+          Analog_Path(), std::vector<std::string>{channel});
+      if (stream_->Start(&status_)) {
+        Drain();
+        return;
+      }
+      stream_.reset();
+      mode_ = 0;
+    }
 
-    graph_update_ = std::thread([&] {
-      while (refresh_ui_continue_) {
-        using namespace std::chrono_literals;
-        std::this_thread::sleep_for(1s);
-        screen_->Post([&] { my_graph.update(); });
-        screen_->Post(Event::Custom);
-        my_graph.set_sample(sample_);
+    job_ = scheduler_->Add(PollPeriod, [this] {
+      int value = my_graph.read();
+      screen_->Post([this, value] {
+        my_graph.update(value);
+        pushed_++;
+        int32_t sample = value;
+        stats_.Add(&sample, 1);
+        panel_->MarkDirty();
+      });
+      screen_->Post(Event::Custom);
+    });
+  }
+
+  // Move the scans streamed to the graph, in batches.
+  void Drain() {
+    hw::iio::Stream* stream = stream_.get();
+    dropped_ = 0;
+    job_ = scheduler_->Add(50ms, [this, stream] {
+      std::vector<int32_t> values;
+      hw::iio::Scan scan;
+      // Scans were dropped while the job was hidden or behind: the queue
+      // holds scans older than the gap, not worth plotting.
+      bool gap = stream->dropped() != dropped_;
+      dropped_ = stream->dropped();
+      while (stream->Pop(&scan)) {
+        if (!gap)
+          values.push_back(scan.values[0]);
       }
+      screen_->Post([this, gap, values = std::move(values)] {
+        if (gap)
+          my_graph.reset();
+        for (int value : values)
+          my_graph.update(value);
+        pushed_ += values.size();
+        // A block per batch, for the kernels to run over it.
+        stats_.Add(values.data(), values.size());
+        panel_->MarkDirty();
+      });
+      screen_->Post(Event::Custom);
     });
+    scheduler_->Touch(job_);
   }
 
-  // Update the x-axis scale
-  void updateSample(int value) {
-    if (value > 0 && value <= 10)
-      sample_ = value;
+  Element RenderStream() {
+    if (!stream_)
+      return text(status_);
+    char line[128];
+    snprintf(line, sizeof(line),
+             "Rate: %.1f kS/s, scans: %llu, overruns: %llu, dropped: %llu",
+             Rate() / 1e3, static_cast<unsigned long long>(stream_->scans()),
+             static_cast<unsigned long long>(stream_->overruns()),
+             static_cast<unsigned long long>(stream_->dropped()));
+    return text(stream_->running() ? line : "The stream stopped");
   }
 
+  static constexpr std::chrono::seconds PollPeriod{1};
+
   std::string name_;
+  std::function<void(graphImpl*)> claim_;
+  bool paused_ = false;   // By Leave().
+  uint64_t dropped_ = 0;  // Of stream_, seen by the drain job.
   Graph my_graph;
+  dsp::Stats stats_{Max_Analog};  // Of the samples since the last reset.
+  uint64_t pushed_ = 0;           // The samples pushed to my_graph.
+  std::unique_ptr<dsp::Spectrum> spectrum_;
+  std::vector<float> latest_;  // The input of spectrum_.
+  uint64_t computed_ = 0;      // pushed_ at the last spectrum.
+  int* tab_;
+  int window_ = 0;
+  int mode_ = 0;
+  int view_ = 0;
+  int fft_size_ = 0;
+  int fft_window_ = 0;
+  std::unique_ptr<hw::iio::Stream> stream_;
+  std::string status_;
+  ScreenInteractive* screen_;
+  Scheduler* scheduler_;
+  PanelBase* panel_;
+  Scheduler::JobId job_ = -1;
+  Component mode_toggle_;
+  Component button_ = Button("Back", [this] {
+    Leave();
+    *tab_ = 0;
+  });
+  Component window_toggle_ = Toggle(&windowEntries, &window_);
+  Component view_toggle_ = Toggle(&viewEntries, &view_);
+  Component fft_toggle_ = Toggle(&fftEntries, &fft_size_);
+  Component fft_window_toggle_ = Toggle(&fftWindowEntries, &fft_window_);
+  Component reset_ = Button("Reset", [&] {
+    my_graph.reset();
+    stats_.Reset();
+    spectrum_.reset();
+  });
+};
+
+// The samples of channels taken together: an array per channel, for drawing a
+// channel to scan its samples only, and the same index in every array for the
+// same scan.
+class ScanStore {
+ public:
+  ScanStore(size_t channels, size_t capacity)
+      : channels_(channels, RingBuffer<int>(capacity)) {}
+
+  // A value per channel.
+  void Push(const int32_t* values) {
+    for (size_t i = 0; i < channels_.size(); ++i)
+      channels_[i].Push(values[i]);
+  }
+
+  void Clear() {
+    for (auto& channel : channels_)
+      channel.Clear();
+  }
+
+  size_t channels() const { return channels_.size(); }
+  const RingBuffer<int>& channel(size_t index) const {
+    return channels_[index];
+  }
+
+ private:
+  std::vector<RingBuffer<int>> channels_;
+};
+
+// The colors of the channels overlaid.
+const Color channelColors[] = {
+    Color::Red,  Color::Green,   Color::Yellow, Color::Blue,
+    Color::Cyan, Color::Magenta, Color::White,  Color::GrayLight,
+};
+
+// The selected channels, sampled together by a single sampler, and overlaid on
+// a common time axis.
+class OverlayView : public ComponentBase {
+ public:
+  OverlayView(std::vector<std::string> names,
+              int* tab,
+              ScreenInteractive* screen,
+              Scheduler* scheduler,
+              PanelBase* panel)
+      : names_(names),
+        checked_(new bool[names.size()]()),
+        tab_(tab),
+        screen_(screen),
+        scheduler_(scheduler),
+        panel_(panel) {
+    auto lines = Container::Vertical({});
+    for (size_t i = 0; i < names_.size(); ++i)
+      lines->Add(Checkbox(&names_[i], &checked_[i]));
+    lines_ = lines;
+
+    Add(Container::Vertical({
+        lines_,
+        mode_toggle_,
+        window_toggle_,
+        Container::Horizontal({
+            start_,
+            stop_,
+            back_,
+        }),
+    }));
+  }
+
+  ~OverlayView() override { Stop(); }
+
+  // Stop sampling, eg. for another view to stream the device.
+  void Stop() {
+    if (job_ >= 0)
+      scheduler_->Remove(job_);
+    job_ = -1;
+    stream_.reset();
+  }
+
+  Element Render() override {
+    if (job_ >= 0)
+      scheduler_->Touch(job_);
+
+    Elements legend;
+    for (size_t i = 0; i < channels_.size(); ++i)
+      legend.push_back(text(channels_[i] + " ") | color(channelColors[i]));
+
+    Elements stats;
+    for (size_t i = 0; i < stats_.size(); ++i) {
+      stats.push_back(separator());
+      stats.push_back(vbox({
+          text(channels_[i]) | color(channelColors[i]),
+          RenderStats(stats_[i], channelColors[i]),
+      }));
+    }
+
+    double duration = rate_ > 0 ? windows[window_] / rate_ : 0;
+    char axis[32];
+    snprintf(axis, sizeof(axis), "-%.3g s", duration);
+
+    return vbox({
+        text("Channels"),
+        lines_->Render() | vscroll_indicator | frame |
+            size(HEIGHT, LESS_THAN, 8),
+        hbox(text("Mode: "), mode_toggle_->Render()),
+        hbox(text("Window: "), window_toggle_->Render()),
+        hbox({start_->Render(), stop_->Render(), back_->Render()}),
+        text(Status()),
+        separator(),
+        hbox(std::move(legend)) | hcenter,
+        hbox({
+            vbox({
+                text("1.8v "),
+                filler(),
+                text("0.9v "),
+                filler(),
+                text("0.0v "),
+            }),
+            canvas([this](Canvas& c) {
+              if (!store_)
+                return;
+              for (size_t i = 0; i < store_->channels(); ++i) {
+                DrawEnvelope(c, store_->channel(i), windows[window_],
+                             channelColors[i], &ranges_);
+              }
+            }) | flex,
+            hbox(std::move(stats)),
+        }) | flex,
+        hbox({
+            text(rate_ > 0 ? axis : "-" + windowEntries[window_] + " samples"),
+            filler(),
+            text("now"),
+        }),
+    });
+  }
+
+ private:
+  void Start() {
+    TRACE_SCOPE("OverlayView::Start");
+    Stop();
+    // The closures posted for the previous sampling are ignored.
+    uint64_t generation = ++generation_;
+    channels_.clear();
+    for (size_t i = 0; i < names_.size(); ++i) {
+      if (checked_[i] && channels_.size() < hw::iio::MaxChannels)
+        channels_.push_back(names_[i]);
+    }
+    status_.clear();
+    rate_ = 0;
+    store_.reset();
+    stats_.assign(channels_.size(), dsp::Stats(Max_Analog));
+    if (channels_.empty()) {
+      status_ = "Select the channels to sample";
+      return;
+    }
+    store_ = std::make_unique<ScanStore>(channels_.size(),
+                                         windows[std::size(windows) - 1]);
+
+    if (mode_ == 1) {
+      std::vector<std::string> iio_channels;
+      for (const auto& name : channels_)
+        iio_channels.push_back(name.substr(3, name.size() - 7));
+      stream_ = std::make_unique<hw::iio::Stream>(Analog_Path(), iio_channels);
+      if (!stream_->Start(&status_)) {
+        stream_.reset();
+        return;
+      }
+      // The scans of the buffer, sampled together by the device.
+      hw::iio::Stream* stream = stream_.get();
+      dropped_ = 0;
+      job_ = scheduler_->Add(50ms, [this, stream, generation] {
+        std::vector<hw::iio::Scan> scans;
+        hw::iio::Scan scan;
+        // Scans were dropped while the job was hidden or behind: the queue
+        // holds scans older than the gap, not worth plotting.
+        bool gap = stream->dropped() != dropped_;
+        dropped_ = stream->dropped();
+        while (stream->Pop(&scan)) {
+          if (!gap)
+            scans.push_back(scan);
+        }
+        screen_->Post([this, generation, gap, scans = std::move(scans)] {
+          if (generation != generation_)
+            return;
+          if (gap)
+            store_->Clear();
+          for (const auto& popped : scans)
+            store_->Push(popped.values);
+          AddStats(scans);
+          panel_->MarkDirty();
+        });
+        screen_->Post(Event::Custom);
+      });
+    } else {
+      // All the channels at each tick.
+      rate_ = 1000.0 / PollPeriod.count();
+      std::vector<std::string> paths;
+      for (const auto& name : channels_)
+        paths.push_back(Analog_Path() + "/" + name);
+      job_ = scheduler_->Add(PollPeriod, [this, paths, generation] {
+        TRACE_SCOPE("OverlayView::Poll");
+        hw::iio::Scan scan = {};
+        for (size_t i = 0; i < paths.size(); ++i) {
+          long long value = 0;
+          hw::ReadInt(paths[i], &value);
+          scan.values[i] = static_cast<int32_t>(value);
+        }
+        screen_->Post([this, generation, scan] {
+          if (generation != generation_)
+            return;
+          store_->Push(scan.values);
+          AddStats({scan});
+          panel_->MarkDirty();
+        });
+        screen_->Post(Event::Custom);
+      });
+    }
+    scheduler_->Touch(job_);
+  }
+
+  // Update the stats of each channel with its values in |scans|, as a block.
+  void AddStats(const std::vector<hw::iio::Scan>& scans) {
+    block_.resize(scans.size());
+    for (size_t channel = 0; channel < stats_.size(); ++channel) {
+      for (size_t i = 0; i < scans.size(); ++i)
+        block_[i] = scans[i].values[channel];
+      stats_[channel].Add(block_.data(), block_.size());
+    }
+  }
+
+  std::string Status() {
+    if (!stream_)
+      return status_;
+    int64_t elapsed = stream_->elapsed_ns();
+    if (elapsed)
+      rate_ = stream_->scans() * 1e9 / elapsed;
+    if (!stream_->running())
+      return "The stream stopped";
+    char line[128];
+    snprintf(line, sizeof(line),
+             "Rate: %.1f kS/s, scans: %llu, overruns: %llu, dropped: %llu",
+             rate_ / 1e3, static_cast<unsigned long long>(stream_->scans()),
+             static_cast<unsigned long long>(stream_->overruns()),
+             static_cast<unsigned long long>(stream_->dropped()));
+    return line;
+  }
+
+  static constexpr std::chrono::milliseconds PollPeriod{100};
+
+  std::vector<std::string> names_;
+  std::unique_ptr<bool[]> checked_;
   int* tab_;
-  int sample_ = 1;
-  std::thread graph_update_;
   ScreenInteractive* screen_;
-  std::atomic<bool> refresh_ui_continue_;
-  Component button_ = Button("Back", [this] { *tab_ = 0; });
-  Component x_scaleUp_ = Button("Increase", [&] { updateSample(sample_ + 1); });
-  Component x_scaleDown_ =
-      Button("Decress", [&] { updateSample(sample_ - 1); });
-  Component reset_ = Button("Reset", [&] { my_graph.reset(); });
+  Scheduler* scheduler_;
+  PanelBase* panel_;
+  Scheduler::JobId job_ = -1;
+
+  std::vector<std::string> channels_;  // Of store_.
+  std::unique_ptr<ScanStore> store_;
+  uint64_t generation_ = 0;        // Of store_, by Start().
+  uint64_t dropped_ = 0;           // Of stream_, seen by the drain job.
+  std::vector<dsp::Stats> stats_;  // Of channels_.
+  std::vector<int32_t> block_;     // Of AddStats(), reused.
+  std::unique_ptr<hw::iio::Stream> stream_;
+  double rate_ = 0;  // Scans per second.
+  std::string status_;
+  std::vector<RingBuffer<int>::Range> ranges_;  // Reused across frames.
+
+  int mode_ = 0;
+  int window_ = 0;
+  Component lines_;
+  Component mode_toggle_ = Toggle(&modeEntries, &mode_);
+  Component window_toggle_ = Toggle(&windowEntries, &window_);
+  Component start_ = Button("Start", [this] { Start(); });
+  Component stop_ = Button("Stop", [this] { Stop(); });
+  Component back_ = Button("Back", [this] { *tab_ = 0; });
 };
 
 class adcImpl : public PanelBase {
  public:
-  adcImpl(ScreenInteractive* screen) : screen_(screen) {
+  adcImpl(ScreenInteractive* screen, Scheduler* scheduler)
+      : screen_(screen), scheduler_(scheduler) {
     // Get all the analog pin and create a graph page
-    if (std::filesystem::exists(Analog_Path)) {
+    if (std::filesystem::exists(Analog_Path())) {
       for (auto name : FindAnalogs()) {
         // Store in a vector
         analog_pin_.push_back(name);
         // Create graph page
-        auto graph = std::make_shared<graphImpl>(name, &tab, screen_);
+        auto graph = std::make_shared<graphImpl>(
+            name, &tab, screen_, scheduler_, this,
+            [this](graphImpl* streaming) { Claim(streaming); });
         children_.push_back(graph);
         graph_tab_->Add(graph);
       }
     }
+    overlay_ = std::make_shared<OverlayView>(analog_pin_, &tab, screen_,
+                                             scheduler_, this);
 
     Add(Container::Tab(
         {
             // Home page (select pin)
             Container::Vertical({
                 radio_,
-                button_,
+                Container::Horizontal({
+                    button_,
+                    overlay_button_,
+                }),
             }),
             // Graph page
             graph_tab_,
+            overlay_,
         },
         &tab));
   }
 
-  ~adcImpl() override = default;
+  ~adcImpl() override { overlay_->Stop(); }
 
  private:
-  std::string Title() override { return "ADC"; }
+  // Stop the views streaming the device but |streaming|: the device streams
+  // to a single view at a time.
+  void Claim(graphImpl* streaming) {
+    overlay_->Stop();
+    for (const auto& child : children_) {
+      if (child.get() != streaming)
+        child->StopStream();
+    }
+  }
+
+  std::string Title() override { return panel::title::ADC; }
   int selected = 0;
   int tab = 0;
   std::vector<std::string> analog_pin_;
   std::vector<std::shared_ptr<graphImpl>> children_;
   ScreenInteractive* screen_;
-  std::thread graph_update_;
-  Component button_ = Button("Generate", [this] { tab = 1; });
+  Scheduler* scheduler_;
+  std::shared_ptr<OverlayView> overlay_;
+  // A device streams to a single view at a time.
+  Component button_ = Button("Generate", [this] {
+    overlay_->Stop();
+    if (selected < int(children_.size()))
+      children_[selected]->Resume();
+    tab = 1;
+  });
+  Component overlay_button_ = Button("Overlay", [this] {
+    for (const auto& child : children_)
+      child->StopStream();
+    tab = 2;
+  });
   Component radio_ = Radiobox(&analog_pin_, &selected);
   Component graph_tab_ = Container::Vertical({}, &selected);
 
@@ -245,6 +939,9 @@ class adcImpl : public PanelBase {
       analog_pin_.push_back(child->label());
     }
 
+    if (tab == 2)
+      return overlay_->Render();
+
     int i = 0;
     if (tab == 1) {
       for (const auto& child : children_) {
@@ -259,15 +956,15 @@ class adcImpl : public PanelBase {
                text("Select Analog Pin :"),
                radio_->Render(),
                separator(),
-               button_->Render(),
+               hbox(button_->Render(), overlay_button_->Render()),
            }) |
            vscroll_indicator | frame;
   }
 };
 
 namespace panel {
-Panel ADC(ScreenInteractive* screen) {
-  return Make<adcImpl>(screen);
+Panel ADC(ScreenInteractive* screen, Scheduler* scheduler) {
+  return Make<adcImpl>(screen, scheduler);
 }
 
 }  // namespace panel
@@ -1,40 +1,19 @@
-#include <filesystem>
-#include <fstream>
-#include <sstream>
 #include <string>
 #include <vector>
 
 #include "ftxui/component/component.hpp"
 #include "ftxui/dom/elements.hpp"
-#include "process.hpp"
+#include "hw/pwm.hpp"
+#include "trace.hpp"
 #include "ui/panel/panel.hpp"
 
 using namespace ftxui;
 
-std::vector<std::string> FindPWMs() {
-  std::vector<std::string> names;
-
-  for (const auto& it :
-       std::filesystem::directory_iterator("/sys/class/pwm/")) {
-    std::stringstream ss(it.path());
-    std::string name;
-
-    while (ss.good()) {
-      getline(ss, name, '/');
-    }
-
-    if (name[3] == '-')
-      names.push_back(name);
-  }
-
-  return names;
-}
-
 namespace ui {
 class DACImpl : public PanelBase {
  public:
   DACImpl() {
-    for (auto name : FindPWMs()) {
+    for (auto name : hw::pwm::FindPWMs()) {
       v_DAC_pin_.push_back(name);
     }
 
@@ -76,7 +55,7 @@ class DACImpl : public PanelBase {
 
   ~DACImpl() = default;
 
-  std::string Title() override { return "DAC"; }
+  std::string Title() override { return panel::title::DAC; }
 
  private:
   std::vector<std::string> v_DAC_pin_;
@@ -93,18 +72,17 @@ class DACImpl : public PanelBase {
   Component button = Button("Trigger", [this] { TriggerPWM(); });
 
   void TriggerPWM() {
+    TRACE_SCOPE("DACImpl::TriggerPWM");
     std::vector<long long> divider = {1000000000, 1000000, 1000, 1};
-    std::string path_name = "/sys/class/pwm/" + v_DAC_pin_[selected];
+    if (v_DAC_pin_.empty())
+      return;
+    const std::string& name = v_DAC_pin_[selected];
 
     long long period = value_period * divider[select_unit];
-    std::ofstream(path_name + "/period") << period;
-
-    float duty_cycle_f = (float)value_dutyCycle / 100 * (float)period;
-    int duty_cycle = (int)duty_cycle_f;
-    std::ofstream(path_name + "/duty_cycle") << duty_cycle;
-
-    std::ofstream(path_name + "/polarity") << v_polarity_[selected_polarity];
-    std::ofstream(path_name + "/enable") << "1";
+    long long duty_cycle = (long long)((float)value_dutyCycle / 100 * period);
+    hw::pwm::Configure(name, period, duty_cycle,
+                       v_polarity_[selected_polarity]);
+    hw::pwm::Enable(name, true);
   }
 };
 
@@ -6,6 +6,8 @@
 #include <sstream>
 #include "ftxui/component/component.hpp"
 #include "ftxui/dom/elements.hpp"
+#include "hw/root.hpp"
+#include "trace.hpp"
 #include "ui/panel/panel.hpp"
 #include "utils.hpp"
 
@@ -50,7 +52,7 @@ class EMMCImpl : public PanelBase {
     );
   }
   ~EMMCImpl() = default;
-  std::string Title() override { return "EMMC and MicroSD stats"; }
+  std::string Title() override { return panel::title::EMMC; }
   Element Render() override {
     updateBlocks();
 
@@ -61,7 +63,11 @@ class EMMCImpl : public PanelBase {
     Elements gauge_list = {text("Filled"), separator()};
 
     auto add = [&](std::string path) {
-      auto space = std::filesystem::space(path);
+      TRACE_SCOPE("filesystem::space");
+      std::error_code error;
+      auto space = std::filesystem::space(path, error);
+      if (error)
+        return;
       name_list.push_back(text(path));
       free_list.push_back(text(Format(space.free, unit)));
       capacity_list.push_back(text(Format(space.capacity, unit)));
@@ -119,7 +125,8 @@ class EMMCImpl : public PanelBase {
 
  private:
   void updateBlocks() {
-    std::string path = "/sys/block/";
+    TRACE_SCOPE("EMMCImpl::updateBlocks");
+    std::string path = hw::Rooted("/sys/block/");
     blocks.clear();
     for (const auto& entry : std::filesystem::directory_iterator(path)) {
       auto p = std::string(entry.path());
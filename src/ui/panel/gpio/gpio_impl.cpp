@@ -1,20 +1,32 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <ctime>
 #include <filesystem>
 #include <fstream>
-#include <regex>
-#include <sstream>
-#include <vector>
 #include <map>
-#include <cstdio>
 #include <memory>
 #include <stdexcept>
-#include <array>
-#include <unistd.h>  // for usleep
-#include <iostream>  // for debug
+#include <thread>
+#include <vector>
 #include "ftxui/component/component.hpp"
+#include "ftxui/component/screen_interactive.hpp"
 #include "ftxui/dom/elements.hpp"
+#include "hw/gpio.hpp"
+#include "hw/gpio_bus.hpp"
+#include "hw/gpio_capture.hpp"
+#include "hw/gpio_monitor.hpp"
+#include "hw/gpio_pattern.hpp"
+#include "log.hpp"
+#include "scheduler.hpp"
+#include "trace.hpp"
 #include "ui/panel/panel.hpp"
+#include "xdg_utils.hpp"
 
 using namespace ftxui;
+using namespace std::chrono_literals;
 
 namespace ui {
 
@@ -33,6 +45,35 @@ const std::vector<std::string> activeEntries = {
     "High",
 };
 
+// The refresh rates of the table of the lines, in Hz.
+const std::vector<std::string> rateEntries = {
+    "1 Hz",
+    "5 Hz",
+    "10 Hz",
+    "20 Hz",
+};
+const int rates[] = {1, 5, 10, 20};
+
+const std::vector<std::string> durationEntries = {
+    "10 ms",
+    "100 ms",
+    "1 s",
+    "5 s",
+};
+const std::chrono::milliseconds durations[] = {10ms, 100ms, 1000ms, 5000ms};
+
+const std::vector<std::string> repeatEntries = {
+    "Once",
+    "10 times",
+    "Forever",
+};
+const int repeats[] = {1, 10, 0};
+
+const std::vector<std::string> bitOrderEntries = {
+    "LSB first",
+    "MSB first",
+};
+
 const std::vector<std::string> edgeEntries = {
     "Pos (+ve)",
     "Neg (-ve)",
@@ -40,18 +81,138 @@ const std::vector<std::string> edgeEntries = {
     "None",
 };
 
+// The edges of the lines with an edge set, waited on by a hw::gpio::EdgeMonitor
+// thread. They are drained periodically while the panel is displayed, and the
+// statistics are updated on the UI thread.
+class EdgeView {
+ public:
+  EdgeView(ScreenInteractive* screen, Scheduler* scheduler, PanelBase* panel)
+      : screen_(screen), scheduler_(scheduler), panel_(panel) {
+    job_ = scheduler_->Add(50ms, [this] { Drain(); });
+  }
+
+  ~EdgeView() { Stop(); }
+
+  void Watch(int number) {
+    if (!monitor_)
+      return;
+    stats_.erase(number);
+    if (monitor_->Watch(number))
+      stats_[number];
+    watching_ = !stats_.empty();
+  }
+
+  void Unwatch(int number) {
+    if (monitor_)
+      monitor_->Unwatch(number);
+    stats_.erase(number);
+    watching_ = !stats_.empty();
+  }
+
+  // The statistics of |number|, or null if it isn't watched.
+  const hw::gpio::EdgeStats* Stats(int number) const {
+    auto it = stats_.find(number);
+    return it == stats_.end() ? nullptr : &it->second;
+  }
+
+  void Touch() { scheduler_->Touch(job_); }
+
+  // Stop waiting on the lines, before they are released.
+  void Stop() {
+    if (!monitor_)
+      return;
+    scheduler_->Remove(job_);
+    monitor_.reset();
+  }
+
+ private:
+  // Called from the scheduler thread, the single consumer of the monitor.
+  void Drain() {
+    std::vector<hw::gpio::Edge> edges;
+    hw::gpio::Edge edge;
+    while (monitor_->Pop(&edge))
+      edges.push_back(edge);
+    if (edges.empty()) {
+      // Keep the frames, and so the job, going while waiting for edges. The
+      // panel is not rebuilt.
+      if (watching_)
+        screen_->Post(Event::Custom);
+      return;
+    }
+
+    screen_->Post([this, edges = std::move(edges)] {
+      for (const auto& popped : edges) {
+        auto it = stats_.find(popped.number);
+        if (it != stats_.end())
+          it->second.Add(popped);
+      }
+      panel_->MarkDirty();
+    });
+    screen_->Post(Event::Custom);
+  }
+
+  ScreenInteractive* screen_;
+  Scheduler* scheduler_;
+  PanelBase* panel_;
+  Scheduler::JobId job_;
+  std::unique_ptr<hw::gpio::EdgeMonitor> monitor_ =
+      std::make_unique<hw::gpio::EdgeMonitor>();
+  std::map<int, hw::gpio::EdgeStats> stats_;
+  std::atomic<bool> watching_{false};  // Whether stats_ has lines.
+};
+
+namespace {
+
+// eg. 1.25 kHz
+std::string FormatFrequency(double hz) {
+  char buffer[32];
+  if (hz >= 1000)
+    snprintf(buffer, sizeof(buffer), "%.2f kHz", hz / 1000);
+  else
+    snprintf(buffer, sizeof(buffer), "%.2f Hz", hz);
+  return buffer;
+}
+
+// eg. 12.5 us
+std::string FormatDuration(int64_t ns) {
+  char buffer[32];
+  if (ns >= 1000000)
+    snprintf(buffer, sizeof(buffer), "%.2f ms", ns / 1e6);
+  else
+    snprintf(buffer, sizeof(buffer), "%.2f us", ns / 1e3);
+  return buffer;
+}
+
+int64_t MonotonicNs() {
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000000000ll + now.tv_nsec;
+}
+
+}  // namespace
+
 class Gpio : public ComponentBase {
  public:
-  Gpio(std::string gpio_num, std::string label, int* tab, int* next, int* limit) 
-      : gpio_num_(gpio_num), label_(label) {
+  Gpio(int number,
+       std::string label,
+       int* tab,
+       int* next,
+       int* limit,
+       EdgeView* edges)
+      : number_(number),
+        gpio_num_(std::to_string(number)),
+        label_(label),
+        edges_(edges) {
     limit_ = limit;
     tab_ = tab;
     next_ = next;
-    path_ = "/sys/class/gpio/gpio" + gpio_num;
     Fetch();
     BuildUI();
+    if (edge_ != "none")
+      edges_->Watch(number_);
   }
 
+  int number() const { return number_; }
   std::string label() const { return label_; }
   std::string direction() const { return direction_; }
   std::string edge() const { return edge_; }
@@ -60,56 +221,66 @@ class Gpio : public ComponentBase {
 
  private:
   void Fetch() {
-    // Read direction
-    std::ifstream direction_file(path_ + "/direction");
-    if (direction_file.is_open()) {
-      std::getline(direction_file, direction_);
-    } else {
-      direction_ = "in";
-    }
-    
-    // Read edge
-    std::ifstream edge_file(path_ + "/edge");
-    if (edge_file.is_open()) {
-      std::getline(edge_file, edge_);
-    } else {
-      edge_ = "none";
-    }
-    
-    // Read value
-    std::ifstream value_file(path_ + "/value");
-    if (value_file.is_open()) {
-      std::getline(value_file, value_);
-    } else {
-      value_ = "0";
-    }
-    
-    // Read active_low
-    std::ifstream active_low_file(path_ + "/active_low");
-    if (active_low_file.is_open()) {
-      std::getline(active_low_file, active_low_);
-    } else {
-      active_low_ = "0";
-    }
+    TRACE_SCOPE("Gpio::Fetch");
+    auto state = hw::gpio::Read(number_);
+    direction_ = state.direction;
+    edge_ = state.edge;
+    value_ = state.value;
+    active_low_ = state.active_low;
   }
 
   void StoreDirection(std::string direction) {
-    std::ofstream(path_ + "/direction") << direction;
+    TRACE_SCOPE("Gpio::StoreDirection");
+    hw::gpio::SetDirection(number_, direction);
     Fetch();
   };
 
   void StoreEdge(std::string edge) {
-    std::ofstream(path_ + "/edge") << edge;
+    TRACE_SCOPE("Gpio::StoreEdge");
+    hw::gpio::SetEdge(number_, edge);
     Fetch();
+    if (edge_ == "none")
+      edges_->Unwatch(number_);
+    else
+      edges_->Watch(number_);
   };
 
+  Element RenderMonitor() {
+    const hw::gpio::EdgeStats* stats = edges_->Stats(number_);
+    if (!stats) {
+      return hbox(text(" * "), text("Set an edge to monitor the line") | dim);
+    }
+
+    std::string level = "-";
+    if (stats->level >= 0)
+      level = std::to_string(stats->level);
+    // Without a recent edge, the signal stopped.
+    double frequency = stats->frequency;
+    if (stats->last_edge_ns < 0 ||
+        MonotonicNs() - stats->last_edge_ns > 1000000000)
+      frequency = 0;
+
+    return vbox({
+        hbox(text(" * Level           : "), text(level)),
+        hbox(text(" * Edges           : "),
+             text(std::to_string(stats->rising) + " rising, " +
+                  std::to_string(stats->falling) + " falling")),
+        hbox(text(" * Frequency       : "), text(FormatFrequency(frequency))),
+        hbox(text(" * High / Low      : "),
+             text(FormatDuration(stats->high_ns) + " / " +
+                  FormatDuration(stats->low_ns))),
+    });
+  }
+
   void StoreValue(std::string value) {
-    std::ofstream(path_ + "/value") << value;
+    TRACE_SCOPE("Gpio::StoreValue");
+    hw::gpio::SetValue(number_, value);
     Fetch();
   };
 
   void StoreActiveLow(std::string active_low) {
-    std::ofstream(path_ + "/active_low") << active_low;
+    TRACE_SCOPE("Gpio::StoreActiveLow");
+    hw::gpio::SetActiveLow(number_, active_low);
     Fetch();
   };
 
@@ -189,6 +360,8 @@ class Gpio : public ComponentBase {
               hbox(text(" * Value           : "), text(value_)),
               hbox(text(" * Active Low      : "), text(active_low_)),
               hbox(text(" * Edge            : "), text(edge_)),
+              text(" Monitor "),
+              RenderMonitor(),
               text(" Actions "),
               hbox(text(" * Direction       : "), ioToggle->Render()),
               hbox(text(" * Value           : "), valToggle->Render()),
@@ -216,13 +389,14 @@ class Gpio : public ComponentBase {
                   })}));
   }
 
-  std::string path_;
+  int number_;
   std::string gpio_num_;
   std::string label_;
   std::string direction_;
   std::string edge_;
   std::string value_;
   std::string active_low_;
+  EdgeView* edges_;
   int* tab_;
   int* next_;
   int* limit_;
@@ -236,305 +410,697 @@ class Gpio : public ComponentBase {
   Component edgeToggle;
 };
 
-// Helper function to execute shell command and get output
-std::string exec(const char* cmd) {
-    std::array<char, 128> buffer;
-    std::string result;
-    std::unique_ptr<FILE, int(*)(FILE*)> pipe(popen(cmd, "r"), pclose);
-    if (!pipe) {
-        return "";
-    }
-    while (fgets(buffer.data(), buffer.size(), pipe.get()) != nullptr) {
-        result += buffer.data();
+// Capture the selected lines with a hw::gpio::Capture, as a timing diagram.
+class CaptureView : public ComponentBase {
+ public:
+  CaptureView(std::vector<int> numbers,
+              std::vector<std::string> labels,
+              int* tab,
+              ScreenInteractive* screen,
+              Scheduler* scheduler,
+              PanelBase* panel)
+      : numbers_(numbers),
+        labels_(labels),
+        checked_(new bool[numbers.size()]()),
+        tab_(tab),
+        screen_(screen),
+        scheduler_(scheduler),
+        panel_(panel) {
+    auto lines = Container::Vertical({});
+    for (size_t i = 0; i < labels_.size(); ++i)
+      lines->Add(Checkbox(&labels_[i], &checked_[i]));
+    lines_ = lines;
+
+    Add(Container::Vertical({
+        lines_,
+        duration_toggle_,
+        Container::Horizontal({
+            start_,
+            stop_,
+            export_,
+            back_,
+        }),
+        Container::Horizontal({
+            zoom_in_,
+            zoom_out_,
+            left_,
+            right_,
+        }),
+    }));
+  }
+
+  ~CaptureView() override { Stop(); }
+
+  // Stop capturing, before the lines are released.
+  void Stop() {
+    if (job_ >= 0)
+      scheduler_->Remove(job_);
+    job_ = -1;
+    capture_.reset();
+  }
+
+  Element Render() override {
+    if (job_ >= 0)
+      scheduler_->Touch(job_);
+
+    Elements rows;
+    for (size_t i = 0; i < capture_labels_.size(); ++i) {
+      std::string label = capture_labels_[i];
+      label.resize(8, ' ');
+      rows.push_back(hbox({
+          text(label),
+          graph([this, i](int width, int height) {
+            return Levels(i, width, height);
+          }) | size(HEIGHT, EQUAL, 2) |
+              flex,
+      }));
     }
-    return result;
-}
+    if (rows.empty())
+      rows.push_back(text("Select lines and start a capture") | dim);
 
-class GPIOImpl : public PanelBase {
- public:
-  GPIOImpl() { BuildUI(); }
-  std::string Title() override { return "GPIO"; }
+    return vbox({
+        text("Lines (up to 64)"),
+        lines_->Render() | vscroll_indicator | frame |
+            size(HEIGHT, LESS_THAN, 8),
+        hbox(text("Duration: "), duration_toggle_->Render()),
+        hbox({start_->Render(), stop_->Render(), export_->Render(),
+              back_->Render()}),
+        separator(),
+        vbox(std::move(rows)) | flex,
+        hbox({
+            text(FormatDuration(window_ns_) + " "),
+            zoom_in_->Render(),
+            zoom_out_->Render(),
+            left_->Render(),
+            right_->Render(),
+        }),
+        separator(),
+        RenderStats(),
+    });
+  }
 
  private:
-  // Get GPIO pin information using gpioinfo - ONLY P pins
-  std::vector<std::pair<int, std::string>> getGpioPins() {
-    std::vector<std::pair<int, std::string>> pins;
-    
-    // First try with sudo
-    std::string output = exec("sudo gpioinfo 2>/dev/null");
-    
-    // If empty, try without sudo
-    if (output.empty()) {
-      output = exec("gpioinfo 2>/dev/null");
-    }
-    
-    if (output.empty()) {
-      std::cerr << "ERROR: gpioinfo command failed or returned empty output\n";
-      return pins;
+  void Start() {
+    TRACE_SCOPE("CaptureView::Start");
+    if (capture_ && capture_->running())
+      return;
+    if (job_ >= 0)
+      scheduler_->Remove(job_);
+    job_ = -1;
+
+    std::vector<int> numbers;
+    capture_labels_.clear();
+    for (size_t i = 0; i < numbers_.size() && numbers.size() < 64; ++i) {
+      if (checked_[i]) {
+        numbers.push_back(numbers_[i]);
+        capture_labels_.push_back(labels_[i]);
+      }
     }
-    
-    std::istringstream iss(output);
-    std::string line;
-    
-    // Map to store chip number to base GPIO number
-    std::map<int, int> chip_to_base;
-    
-    // First pass: Collect chip base numbers from /sys
-    for (int chip_num = 0; chip_num < 10; chip_num++) {
-        std::string base_path = "/sys/class/gpio/gpiochip" + std::to_string(chip_num) + "/base";
-        std::ifstream base_file(base_path);
-        if (base_file.is_open()) {
-            std::string base_str;
-            if (std::getline(base_file, base_str)) {
-                try {
-                    int base = std::stoi(base_str);
-                    chip_to_base[chip_num] = base;
-                    std::cerr << "DEBUG: Chip " << chip_num << " base = " << base << "\n";
-                } catch (...) {
-                    // Ignore conversion errors
-                }
-            }
-        }
+    samples_.clear();
+    dropped_ = 0;
+    offset_ns_ = 0;
+    status_.clear();
+    window_ns_ = durations[duration_].count() * 1000000ll;
+    capture_ = std::make_unique<hw::gpio::Capture>(numbers);
+    if (!capture_->Start(durations[duration_])) {
+      status_ = "Select the lines to capture";
+      return;
     }
-    
-    int current_chip = -1;
-    bool reading_chip = false;
-    
-    // Second pass: Parse gpioinfo output
-    while (std::getline(iss, line)) {
-        // Trim leading/trailing whitespace
-        line.erase(0, line.find_first_not_of(" \t"));
-        line.erase(line.find_last_not_of(" \t") + 1);
-        
-        // Check for chip header
-        if (line.find("gpiochip") == 0) {
-            // Extract chip number from "gpiochipX"
-            std::string chip_str = line.substr(8); // Skip "gpiochip"
-            size_t space_pos = chip_str.find_first_of(" :");
-            if (space_pos != std::string::npos) {
-                chip_str = chip_str.substr(0, space_pos);
-            }
-            
-            try {
-                current_chip = std::stoi(chip_str);
-                std::cerr << "DEBUG: Found chip " << current_chip << "\n";
-                reading_chip = true;
-            } catch (...) {
-                current_chip = -1;
-                reading_chip = false;
-            }
-            continue;
-        }
-        
-        // Skip if we're not reading a chip or line doesn't contain "line"
-        if (!reading_chip || line.find("line") == std::string::npos) {
-            continue;
-        }
-        
-        // Parse line: "line   X:"
-        size_t line_pos = line.find("line");
-        if (line_pos == std::string::npos) continue;
-        
-        // Extract line number
-        size_t num_start = line_pos + 4;
-        while (num_start < line.size() && (line[num_start] == ' ' || line[num_start] == '\t')) {
-            num_start++;
+
+    // Drain the changes while the capture runs, then once more for those
+    // queued before it stopped.
+    hw::gpio::Capture* capture = capture_.get();
+    job_ = scheduler_->Add(50ms, [this, capture] {
+      bool finished = !capture->running();
+      std::vector<hw::gpio::Sample> samples;
+      hw::gpio::Sample sample;
+      while (capture->Pop(&sample))
+        samples.push_back(sample);
+      screen_->Post([this, capture, finished, samples = std::move(samples)] {
+        for (const auto& popped : samples) {
+          if (samples_.size() < MaxSamples)
+            samples_.push_back(popped);
+          else
+            dropped_++;
         }
-        
-        size_t num_end = num_start;
-        while (num_end < line.size() && isdigit(line[num_end])) {
-            num_end++;
+        if (finished && capture_.get() == capture && job_ >= 0) {
+          scheduler_->Remove(job_);
+          job_ = -1;
         }
-        
-        if (num_end == num_start) continue;
-        
-        try {
-            int line_num = std::stoi(line.substr(num_start, num_end - num_start));
-            
-            // Now look for P pin in the line
-            // First check in quotes
-            std::string pin_name = "";
-            size_t quote_start = line.find('\"');
-            if (quote_start != std::string::npos) {
-                size_t quote_end = line.find('\"', quote_start + 1);
-                if (quote_end != std::string::npos) {
-                    std::string quoted = line.substr(quote_start + 1, quote_end - quote_start - 1);
-                    
-                    // Check if quoted text starts with P followed by a digit
-                    if (quoted.size() >= 2 && 
-                        (quoted[0] == 'P' || quoted[0] == 'p') && 
-                        isdigit(quoted[1])) {
-                        pin_name = quoted;
-                    }
-                }
-            }
-            
-            // If not found in quotes, search entire line for P followed by digit
-            if (pin_name.empty()) {
-                // Search for P or p followed by digit
-                for (size_t i = 0; i < line.size(); i++) {
-                    if ((line[i] == 'P' || line[i] == 'p') && 
-                        i + 1 < line.size() && isdigit(line[i + 1])) {
-                        
-                        // Extract the pin name
-                        size_t start = i;
-                        size_t end = i + 1;
-                        while (end < line.size() && 
-                               (isdigit(line[end]) || line[end] == '.' || 
-                                line[end] == '_' || line[end] == '(')) {
-                            end++;
-                        }
-                        
-                        pin_name = line.substr(start, end - start);
-                        
-                        // Clean up trailing special characters
-                        while (!pin_name.empty() && 
-                               (pin_name.back() == '(' || pin_name.back() == ' ' || 
-                                pin_name.back() == '\t')) {
-                            pin_name.pop_back();
-                        }
-                        
-                        break;
-                    }
-                }
-            }
-            
-            // If we found a P pin, add it
-            if (!pin_name.empty()) {
-                // Calculate GPIO number
-                int gpio_num = -1;
-                
-                if (chip_to_base.find(current_chip) != chip_to_base.end()) {
-                    gpio_num = chip_to_base[current_chip] + line_num;
-                } else {
-                    // Estimate: assume chips are numbered sequentially with 32 lines each
-                    // This is a common pattern for many boards
-                    gpio_num = current_chip * 32 + line_num;
-                }
-                
-                std::cerr << "DEBUG: Found P pin - Chip " << current_chip 
-                          << ", Line " << line_num << ", GPIO " << gpio_num 
-                          << ", Name: " << pin_name << "\n";
-                
-                pins.push_back({gpio_num, pin_name});
-            }
-            
-        } catch (...) {
-            // Skip lines with conversion errors
-            continue;
+        panel_->MarkDirty();
+      });
+      screen_->Post(Event::Custom);
+    });
+    scheduler_->Touch(job_);
+  }
+
+  // To $XDG_STATE_HOME/bb-config/capture-<date>-<time>.vcd, or the
+  // temporary directory without a home.
+  void Export() {
+    if (samples_.empty())
+      return;
+    std::string home;
+    try {
+      home = xdg_utils::state::home();
+    } catch (const std::runtime_error&) {
+    }
+    std::error_code error;
+    std::filesystem::path directory =
+        home.empty() ? std::filesystem::temp_directory_path(error)
+                     : std::filesystem::path(home) / "bb-config";
+    std::filesystem::create_directories(directory, error);
+
+    time_t now = time(nullptr);
+    tm local;
+    localtime_r(&now, &local);
+    char name[64];
+    std::strftime(name, sizeof(name), "capture-%Y%m%d-%H%M%S.vcd", &local);
+    std::string path = (directory / name).string();
+
+    std::ofstream file(path);
+    if (file && hw::gpio::WriteVcd(file, capture_labels_, samples_))
+      status_ = "Wrote " + path;
+    else
+      status_ = "Failed to write " + path;
+  }
+
+  // The levels of the line |line| over the columns of the window: high when
+  // it is high for any part of a column.
+  std::vector<int> Levels(size_t line, int width, int height) const {
+    std::vector<int> levels(width, 0);
+    if (samples_.empty() || width <= 0)
+      return levels;
+
+    int64_t end = samples_.back().timestamp_ns - offset_ns_;
+    int64_t begin = end - window_ns_;
+    auto later = [](int64_t time, const hw::gpio::Sample& sample) {
+      return time < sample.timestamp_ns;
+    };
+    for (int x = 0; x < width; ++x) {
+      int64_t from = begin + window_ns_ * x / width;
+      int64_t to = begin + window_ns_ * (x + 1) / width;
+      if (to < samples_.front().timestamp_ns)
+        continue;
+      // The sample in effect at |from|, and those until |to|.
+      auto it = std::upper_bound(samples_.begin(), samples_.end(), from, later);
+      if (it != samples_.begin())
+        --it;
+      for (; it != samples_.end() && it->timestamp_ns < to; ++it) {
+        if ((it->bits >> line) & 1) {
+          levels[x] = height;
+          break;
         }
+      }
     }
-    
-    // Sort by GPIO number
-    std::sort(pins.begin(), pins.end(), 
-              [](const auto& a, const auto& b) { return a.first < b.first; });
-    
-    // Remove duplicates
-    pins.erase(std::unique(pins.begin(), pins.end(),
-               [](const auto& a, const auto& b) { return a.first == b.first; }),
-               pins.end());
-    
-    std::cerr << "DEBUG: Total P pins found: " << pins.size() << "\n";
-    for (const auto& pin : pins) {
-        std::cerr << "  GPIO " << pin.first << ": " << pin.second << "\n";
+    return levels;
+  }
+
+  Element RenderStats() {
+    if (!capture_)
+      return text(status_);
+    uint64_t samples = capture_->samples();
+    int64_t elapsed = capture_->elapsed_ns();
+    double rate = elapsed ? samples * 1e9 / elapsed : 0;
+    return vbox({
+        text(std::string(capture_->running() ? "Capturing" : "Captured") +
+             ": " + std::to_string(samples) + " samples in " +
+             FormatDuration(elapsed)),
+        text("Sample rate: " + FormatFrequency(rate) + ", " +
+             FormatDuration(samples ? elapsed / samples : 0) +
+             " per sample"),
+        text("Changes: " + std::to_string(samples_.size()) +
+             ", lost: " + std::to_string(capture_->lost() + dropped_) +
+             ", samples missed: " + std::to_string(capture_->missed())),
+        text(capture_->realtime()
+                 ? "Priority: SCHED_FIFO"
+                 : "Priority: normal, SCHED_FIFO needs CAP_SYS_NICE"),
+        text(status_),
+    });
+  }
+
+  // The changes kept for the diagram, of 16 bytes each.
+  static constexpr size_t MaxSamples = 1 << 20;
+
+  std::vector<int> numbers_;
+  std::vector<std::string> labels_;
+  std::unique_ptr<bool[]> checked_;
+  int* tab_;
+  ScreenInteractive* screen_;
+  Scheduler* scheduler_;
+  PanelBase* panel_;
+  Scheduler::JobId job_ = -1;
+
+  std::unique_ptr<hw::gpio::Capture> capture_;
+  std::vector<std::string> capture_labels_;
+  std::vector<hw::gpio::Sample> samples_;
+  uint64_t dropped_ = 0;
+  std::string status_;
+
+  // The diagram shows |window_ns_| until |offset_ns_| before the last change.
+  int64_t window_ns_ = 1000000000;
+  int64_t offset_ns_ = 0;
+
+  int duration_ = 2;
+  Component lines_;
+  Component duration_toggle_ = Toggle(&durationEntries, &duration_);
+  Component start_ = Button("Start", [this] { Start(); });
+  Component stop_ = Button("Stop", [this] {
+    if (capture_)
+      capture_->Stop();
+  });
+  Component export_ = Button("Export VCD", [this] { Export(); });
+  Component back_ = Button("Back", [this] { *tab_ = 0; });
+  Component zoom_in_ = Button("Zoom in", [this] {
+    window_ns_ = std::max<int64_t>(window_ns_ / 2, 1000);
+  });
+  Component zoom_out_ = Button("Zoom out", [this] { window_ns_ *= 2; });
+  Component left_ = Button("<", [this] { offset_ns_ += window_ns_ / 2; });
+  Component right_ = Button(">", [this] {
+    offset_ns_ = std::max<int64_t>(offset_ns_ - window_ns_ / 2, 0);
+  });
+};
+
+// Play a pattern typed by the user with a hw::gpio::PatternPlayer, and show how
+// late its steps were.
+class PatternView : public ComponentBase {
+ public:
+  PatternView(int* tab,
+              ScreenInteractive* screen,
+              Scheduler* scheduler,
+              PanelBase* panel)
+      : tab_(tab), screen_(screen), scheduler_(scheduler), panel_(panel) {
+    Add(Container::Vertical({
+        input_,
+        repeat_toggle_,
+        Container::Horizontal({
+            start_,
+            stop_,
+            back_,
+        }),
+    }));
+    // Refresh the statistics while it plays.
+    job_ = scheduler_->Add(200ms, [this] {
+      panel_->MarkDirty();
+      screen_->PostEvent(Event::Custom);
+    });
+  }
+
+  ~PatternView() override { Stop(); }
+
+  // Stop playing, before the lines are released.
+  void Stop() {
+    if (job_ >= 0)
+      scheduler_->Remove(job_);
+    job_ = -1;
+    player_.reset();
+  }
+
+  Element Render() override {
+    if (job_ >= 0 && player_ && player_->running())
+      scheduler_->Touch(job_);
+
+    return vbox({
+        text("Steps, eg. P9_12=1 P9_15=0 10ms; P9_12=0 500us"),
+        input_->Render() | border,
+        hbox(text("Repeat: "), repeat_toggle_->Render()),
+        hbox({start_->Render(), stop_->Render(), back_->Render()}),
+        separator(),
+        RenderJitter(),
+    });
+  }
+
+ private:
+  void Start() {
+    TRACE_SCOPE("PatternView::Start");
+    if (player_ && player_->running())
+      return;
+    std::vector<int> numbers;
+    std::vector<hw::gpio::Step> steps;
+    if (!hw::gpio::ParsePattern(pattern_, &numbers, &steps, &status_)) {
+      player_.reset();
+      return;
     }
-    
-    return pins;
+    status_.clear();
+    player_ = std::make_unique<hw::gpio::PatternPlayer>(numbers);
+    if (!player_->Start(std::move(steps), repeats[repeat_])) {
+      player_.reset();
+      status_ = "Failed to make the lines outputs";
+    }
+    scheduler_->Touch(job_);
   }
 
-  // Alternative method if gpioinfo doesn't work
-  std::vector<std::pair<int, std::string>> getGpioPinsFallback() {
-    std::vector<std::pair<int, std::string>> pins;
-    
-    // Look for already exported GPIOs
-    std::string cmd = "ls -d /sys/class/gpio/gpio[0-9]* 2>/dev/null";
-    std::string result = exec(cmd.c_str());
-    
-    if (!result.empty()) {
-        std::istringstream iss(result);
-        std::string gpio_path;
-        while (std::getline(iss, gpio_path)) {
-            // Extract GPIO number
-            size_t gpio_pos = gpio_path.find("gpio");
-            if (gpio_pos != std::string::npos) {
-                std::string num_str;
-                for (size_t i = gpio_pos + 4; i < gpio_path.size() && isdigit(gpio_path[i]); i++) {
-                    num_str += gpio_path[i];
-                }
-                
-                if (!num_str.empty()) {
-                    try {
-                        int gpio_num = std::stoi(num_str);
-                        pins.push_back({gpio_num, "GPIO" + num_str});
-                    } catch (...) {
-                        // Skip
-                    }
-                }
-            }
-        }
+  Element RenderJitter() {
+    if (!player_)
+      return text(status_);
+    hw::gpio::Jitter jitter = player_->jitter();
+    auto us = [](double ns) { return FormatDuration(int64_t(ns)); };
+    return vbox({
+        text(std::string(player_->running() ? "Playing" : "Played") + ": " +
+             std::to_string(jitter.steps) + " steps"),
+        text("Late by: min " + us(jitter.min_ns) + ", mean " +
+             us(jitter.mean_ns) + ", p99 " + us(jitter.p99_ns) + ", max " +
+             us(jitter.max_ns)),
+        text("Overruns: " + std::to_string(jitter.late) +
+             ", failed writes: " + std::to_string(jitter.failed)),
+        text(std::string("Priority: ") +
+             (player_->realtime() ? "SCHED_FIFO" : "normal") +
+             ", memory: " + (player_->locked() ? "locked" : "not locked")),
+        text(status_),
+    });
+  }
+
+  int* tab_;
+  ScreenInteractive* screen_;
+  Scheduler* scheduler_;
+  PanelBase* panel_;
+  Scheduler::JobId job_ = -1;
+  std::unique_ptr<hw::gpio::PatternPlayer> player_;
+  std::string pattern_;
+  std::string status_;
+  int repeat_ = 0;
+  Component input_ = Input(&pattern_, "P9_12=1 1ms; P9_12=0 1ms");
+  Component repeat_toggle_ = Toggle(&repeatEntries, &repeat_);
+  Component start_ = Button("Start", [this] { Start(); });
+  Component stop_ = Button("Stop", [this] {
+    if (player_)
+      player_->Stop();
+  });
+  Component back_ = Button("Back", [this] { *tab_ = 0; });
+};
+
+// Read and write a group of lines as a word with a hw::gpio::Bus, and measure
+// how many words per second it takes.
+class BusView : public ComponentBase {
+ public:
+  BusView(std::map<int, std::string> labels,
+          int* tab,
+          ScreenInteractive* screen,
+          Scheduler* scheduler,
+          PanelBase* panel)
+      : labels_(std::move(labels)),
+        tab_(tab),
+        screen_(screen),
+        scheduler_(scheduler),
+        panel_(panel) {
+    Add(Container::Vertical({
+        lines_input_,
+        Container::Horizontal({
+            order_toggle_,
+            direction_toggle_,
+            apply_,
+        }),
+        Container::Horizontal({
+            word_input_,
+            write_,
+            test_,
+            back_,
+        }),
+    }));
+    // Read the word while the view is displayed.
+    job_ = scheduler_->Add(100ms, [this] {
+      auto bus = std::atomic_load(&bus_);
+      uint64_t word = 0;
+      if (!bus || !bus->Read(&word))
+        return;
+      screen_->Post([this, word] {
+        word_ = word;
+        panel_->MarkDirty();
+      });
+      screen_->Post(Event::Custom);
+    });
+  }
+
+  ~BusView() override { Stop(); }
+
+  // Stop using the lines, before they are released.
+  void Stop() {
+    if (job_ >= 0)
+      scheduler_->Remove(job_);
+    job_ = -1;
+    if (test_thread_.joinable())
+      test_thread_.join();
+    std::atomic_store(&bus_, std::shared_ptr<hw::gpio::Bus>());
+  }
+
+  Element Render() override {
+    if (job_ >= 0 && bus_)
+      scheduler_->Touch(job_);
+
+    return vbox({
+        text("Lines, eg. P8_45 P8_46 P8_43 P8_44 P8_41 P8_42 P8_39 P8_40"),
+        lines_input_->Render() | border,
+        hbox({
+            text("Bit order: "),
+            order_toggle_->Render(),
+            text("  Direction: "),
+            direction_toggle_->Render(),
+            text("  "),
+            apply_->Render(),
+        }),
+        hbox({
+            text("Word: "),
+            word_input_->Render() | size(WIDTH, EQUAL, 20) | border,
+            write_->Render(),
+            test_->Render(),
+            back_->Render(),
+        }),
+        separator(),
+        RenderWord(),
+        text(status_),
+    });
+  }
+
+ private:
+  void Apply() {
+    TRACE_SCOPE("BusView::Apply");
+    if (testing_)
+      return;
+    std::vector<int> numbers;
+    uint64_t word = 0;
+    if (!hw::gpio::ParseBus(lines_text_, &numbers, &status_) ||
+        (!word_text_.empty() && !ParseWord(&word))) {
+      return;
     }
-    
-    return pins;
+    status_.clear();
+    throughput_ = hw::gpio::Throughput();
+    tested_ = false;
+    auto order = order_ ? hw::gpio::BitOrder::MsbFirst
+                        : hw::gpio::BitOrder::LsbFirst;
+    // Keep the values written with the previous bus before configuring the
+    // lines again, as they may be shared.
+    std::atomic_store(&bus_, std::shared_ptr<hw::gpio::Bus>());
+    auto bus = std::make_shared<hw::gpio::Bus>(numbers, order);
+    output_ = direction_ == 1;
+    if (!bus->SetOutput(output_, word))
+      status_ = "Failed to set the direction of the lines";
+    std::atomic_store(&bus_, bus);
+    scheduler_->Touch(job_);
   }
 
-  // Export a GPIO if not already exported
-  bool exportGpio(int gpio_num) {
-    std::string gpio_path = "/sys/class/gpio/gpio" + std::to_string(gpio_num);
-    
-    // Check if already exported
-    if (std::filesystem::exists(gpio_path)) {
-      return true;
+  void Write() {
+    if (!bus_ || testing_)
+      return;
+    uint64_t word = 0;
+    if (!ParseWord(&word))
+      return;
+    if (!output_)
+      status_ = "Apply the OUT direction first";
+    else if (!bus_->Write(word))
+      status_ = "Failed to write the word";
+    else
+      status_.clear();
+  }
+
+  // eg. "0x5a", "90" or "0b01011010"
+  bool ParseWord(uint64_t* word) {
+    std::string digits = word_text_;
+    int base = 0;
+    if (digits.rfind("0b", 0) == 0) {
+      digits = digits.substr(2);
+      base = 2;
     }
-    
-    // Try to export
-    std::ofstream export_file("/sys/class/gpio/export");
-    if (export_file.is_open()) {
-      export_file << gpio_num;
-      export_file.close();
-      
-      // Wait for export to complete
-      usleep(50000); // 50ms
-      
-      return std::filesystem::exists(gpio_path);
+    char* end = nullptr;
+    *word = std::strtoull(digits.c_str(), &end, base);
+    if (digits.empty() || *end) {
+      status_ = "Invalid word: " + word_text_;
+      return false;
     }
-    
-    return false;
+    return true;
   }
 
-  void BuildUI() {
-    // Get list of GPIO pins from gpioinfo
-    auto gpio_pins = getGpioPins();
-    
-    // If no P pins found, try fallback
-    if (gpio_pins.empty()) {
-        std::cerr << "WARNING: No P pins found with gpioinfo, trying fallback\n";
-        gpio_pins = getGpioPinsFallback();
+  // Measure from a thread of its own, for the UI to keep running.
+  void Test() {
+    if (!bus_ || testing_)
+      return;
+    if (!output_) {
+      status_ = "Apply the OUT direction first";
+      return;
     }
-    
+    if (test_thread_.joinable())
+      test_thread_.join();
+    testing_ = true;
+    status_ = "Testing...";
+    auto bus = bus_;
+    test_thread_ = std::thread([this, bus] {
+      trace::SetThreadName("bus test");
+      auto throughput = hw::gpio::MeasureThroughput(bus.get(), 1s);
+      screen_->Post([this, throughput] {
+        throughput_ = throughput;
+        tested_ = true;
+        testing_ = false;
+        status_.clear();
+        panel_->MarkDirty();
+      });
+      screen_->Post(Event::Custom);
+    });
+  }
+
+  Element RenderWord() {
+    if (!bus_)
+      return text("Enter the lines of the bus and apply") | dim;
+
+    // The lines from the most significant bit, as on a diagram.
+    const auto& numbers = bus_->numbers();
+    Elements columns;
+    std::string binary;
+    for (size_t i = numbers.size(); i-- > 0;) {
+      auto it = labels_.find(numbers[i]);
+      std::string label =
+          it != labels_.end() ? it->second : std::to_string(numbers[i]);
+      int bit = (word_ >> i) & 1;
+      columns.push_back(vbox({
+                            text("b" + std::to_string(i)) | dim,
+                            text(label),
+                            text(std::to_string(bit)) | bold,
+                        }) |
+                        border);
+      binary += '0' + bit;
+    }
+    char value[64];
+    snprintf(value, sizeof(value), "0x%llx (%llu)",
+             static_cast<unsigned long long>(word_),
+             static_cast<unsigned long long>(word_));
+
+    size_t requests = bus_->requests();
+    std::string atomicity =
+        hw::gpio::CurrentBackend() != hw::gpio::Backend::Chardev
+            ? ", one line after the other through sysfs"
+        : requests > 1 ? ", the lines of each chip at once"
+                       : ", all the lines at once";
+    Elements lines = {
+        hbox(std::move(columns)) | xframe,
+        text(std::string("Value: ") + value + " 0b" + binary),
+        text("Writes per word: " + std::to_string(requests) + atomicity),
+    };
+    if (tested_) {
+      lines.push_back(text(
+          "Throughput: " + FormatRate(throughput_.writes_per_second) +
+          " written, " + FormatRate(throughput_.reads_per_second) +
+          " read, " + std::to_string(throughput_.failed) + " failed"));
+    }
+    return vbox(std::move(lines));
+  }
+
+  // eg. "123.4 k words/s"
+  static std::string FormatRate(double rate) {
+    char buffer[32];
+    if (rate >= 1e6)
+      snprintf(buffer, sizeof(buffer), "%.2f M words/s", rate / 1e6);
+    else if (rate >= 1e3)
+      snprintf(buffer, sizeof(buffer), "%.1f k words/s", rate / 1e3);
+    else
+      snprintf(buffer, sizeof(buffer), "%.0f words/s", rate);
+    return buffer;
+  }
+
+  std::map<int, std::string> labels_;  // Of the header pins, by number.
+  int* tab_;
+  ScreenInteractive* screen_;
+  Scheduler* scheduler_;
+  PanelBase* panel_;
+  Scheduler::JobId job_ = -1;
+
+  // Read by job_ and the test thread, replaced on the UI thread.
+  std::shared_ptr<hw::gpio::Bus> bus_;
+  bool output_ = false;
+  uint64_t word_ = 0;  // As last read.
+  std::thread test_thread_;
+  bool testing_ = false;
+  bool tested_ = false;
+  hw::gpio::Throughput throughput_;
+  std::string status_;
+
+  std::string lines_text_;
+  std::string word_text_;
+  int order_ = 0;
+  int direction_ = 0;
+  Component lines_input_ = Input(&lines_text_, "P8_45 P8_46 P8_43 P8_44");
+  Component order_toggle_ = Toggle(&bitOrderEntries, &order_);
+  Component direction_toggle_ = Toggle(&iOentries, &direction_);
+  Component apply_ = Button("Apply", [this] { Apply(); });
+  Component word_input_ = Input(&word_text_, "0x5a");
+  Component write_ = Button("Write", [this] { Write(); });
+  Component test_ = Button("Throughput", [this] { Test(); });
+  Component back_ = Button("Back", [this] { *tab_ = 0; });
+};
+
+class GPIOImpl : public PanelBase {
+ public:
+  GPIOImpl(ScreenInteractive* screen, Scheduler* scheduler)
+      : screen_(screen),
+        scheduler_(scheduler),
+        edges_(screen, scheduler, this) {
+    BuildUI();
+    Schedule();
+  }
+  // Don't leave the lines exported for bb-config behind.
+  ~GPIOImpl() override {
+    scheduler_->Remove(job_);
+    capture_view_->Stop();
+    pattern_view_->Stop();
+    bus_view_->Stop();
+    edges_.Stop();
+    hw::gpio::UnexportAll();
+  }
+  std::string Title() override { return panel::title::GPIO; }
+
+ private:
+  void BuildUI() {
+    // Get the list of GPIO pins
+    auto gpio_pins = hw::gpio::FindPins();
+
     MenuOption menuOpt;
     menuOpt.on_enter = [&] { tab = 1; };
     gpio_menu = Menu(&gpio_names, &selected, menuOpt);
+    MenuOption rateOpt = MenuOption::Toggle();
+    rateOpt.on_change = [&] { Schedule(); };
+    rate_toggle_ = Menu(&rateEntries, &rate_, rateOpt);
     gpio_individual = Container::Vertical({}, &selected);
     
     if (!gpio_pins.empty()) {
-      // Process pins from gpioinfo
+      // Export them together, which takes a single request per chip with the
+      // character devices.
+      std::vector<int> numbers;
+      for (const auto& pin : gpio_pins)
+        numbers.push_back(pin.number);
+      hw::gpio::Export(numbers);
+
       for (const auto& pin : gpio_pins) {
-        int gpio_num = pin.first;
-        std::string label = pin.second;
-        
         // Try to export the GPIO
-        if (exportGpio(gpio_num)) {
-          std::string gpio_num_str = std::to_string(gpio_num);
-          auto gpio = std::make_shared<Gpio>(gpio_num_str, label, &tab, &selected, &limit);
+        if (hw::gpio::Export(pin.number)) {
+          auto gpio = std::make_shared<Gpio>(pin.number, pin.label, &tab,
+                                             &selected, &limit, &edges_);
           children_.push_back(gpio);
+          numbers_.push_back(pin.number);
           gpio_individual->Add(gpio);
           limit++;
         } else {
-          std::cerr << "WARNING: Failed to export GPIO " << gpio_num << " (" << label << ")\n";
+          LOG_WARNING << "Failed to export GPIO " << pin.number << " ("
+                      << pin.label << ")";
         }
       }
     }
-    
+
     // If no pins found, show error message
     if (children_.empty()) {
       error_message_ = "No GPIO pins found. Make sure:\n"
@@ -543,20 +1109,87 @@ class GPIOImpl : public PanelBase {
                        "3. GPIOs are accessible";
     }
 
+    std::vector<std::string> labels;
+    for (const auto& child : children_)
+      labels.push_back(child->label());
+    capture_view_ = std::make_shared<CaptureView>(
+        numbers_, labels, &tab, screen_, scheduler_, this);
+    capture_button_ = Button("Capture", [&] { tab = 2; });
+    pattern_view_ =
+        std::make_shared<PatternView>(&tab, screen_, scheduler_, this);
+    pattern_button_ = Button("Pattern", [&] { tab = 3; });
+    std::map<int, std::string> pin_labels;
+    for (const auto& child : children_)
+      pin_labels[child->number()] = child->label();
+    bus_view_ = std::make_shared<BusView>(std::move(pin_labels), &tab,
+                                          screen_, scheduler_, this);
+    bus_button_ = Button("Bus", [&] { tab = 4; });
+
     Add(Container::Tab(
         {
-            gpio_menu,
+            Container::Vertical({
+                Container::Horizontal({
+                    rate_toggle_,
+                    capture_button_,
+                    pattern_button_,
+                    bus_button_,
+                }),
+                gpio_menu,
+            }),
             gpio_individual,
+            capture_view_,
+            pattern_view_,
+            bus_view_,
         },
         &tab));
   }
 
+  // Refresh the table of the lines at the selected rate, with a single read
+  // of all of them.
+  void Schedule() {
+    if (job_ >= 0)
+      scheduler_->Remove(job_);
+    job_ = scheduler_->Add(std::chrono::milliseconds(1000 / rates[rate_]),
+                           [this] {
+                             auto states = hw::gpio::ReadAll(numbers_);
+                             screen_->Post([this, states] {
+                               states_ = states;
+                               MarkDirty();
+                             });
+                             screen_->Post(Event::Custom);
+                           });
+  }
+
+  // eg. "P9_12     60  out  1  0  none"
+  std::string Row(size_t index) const {
+    const hw::gpio::State* state =
+        index < states_.size() ? &states_[index] : nullptr;
+    char row[80];
+    snprintf(row, sizeof(row), "%-8s %4d  %-3s  %-5s  %-3s  %-7s",
+             children_[index]->label().c_str(), children_[index]->number(),
+             state ? state->direction.c_str() : "-",
+             state ? state->value.c_str() : "-",
+             state ? state->active_low.c_str() : "-",
+             state ? state->edge.c_str() : "-");
+    return row;
+  }
+
+  // The edges are drained only while the panel is displayed.
+  void OnDisplay() override { edges_.Touch(); }
+
   Element Render() override {
     gpio_names.clear();
-    for (const auto& child : children_) {
-      gpio_names.push_back(child->label());
+    for (size_t i = 0; i < children_.size(); ++i) {
+      gpio_names.push_back(Row(i));
     }
 
+    if (tab == 2)
+      return window(text("GPIO Capture"), capture_view_->Render());
+    if (tab == 3)
+      return window(text("GPIO Pattern"), pattern_view_->Render());
+    if (tab == 4)
+      return window(text("GPIO Bus"), bus_view_->Render());
+
     if (tab == 1) {
       if (children_.empty()) {
         return window(text("GPIO Control"),
@@ -570,7 +1203,7 @@ class GPIOImpl : public PanelBase {
                           text(""),
                           text("Debug info:"),
                           text("Tried to find P pins from gpioinfo"),
-                          text("Check terminal for debug output")
+                          text("Check the Log panel")
                       }) | center | flex);
       }
       
@@ -600,11 +1233,41 @@ class GPIOImpl : public PanelBase {
                     }) | center | flex);
     }
 
-    return window(text("GPIO Menu - " + std::to_string(children_.size()) + " P pins"),
-                  gpio_menu->Render() | vscroll_indicator | frame | flex);
+    // The table is read only while it is displayed.
+    scheduler_->Touch(job_);
+    return window(
+        text("GPIO Menu - " + std::to_string(children_.size()) + " P pins"),
+        vbox({
+            hbox({
+                text("Refresh: "),
+                rate_toggle_->Render(),
+                filler(),
+                capture_button_->Render(),
+                pattern_button_->Render(),
+                bus_button_->Render(),
+            }),
+            separator(),
+            // Aligned with the entries, after their "> " prefix.
+            text("  Pin      GPIO  Dir  Value  Low  Edge") | bold,
+            gpio_menu->Render() | vscroll_indicator | frame | flex,
+        }));
   }
 
+  ScreenInteractive* screen_;
+  Scheduler* scheduler_;
+  Scheduler::JobId job_ = -1;
+  EdgeView edges_;
   std::vector<std::shared_ptr<Gpio>> children_;
+  std::vector<int> numbers_;
+  std::vector<hw::gpio::State> states_;  // Of numbers_, read by job_.
+  Component rate_toggle_;
+  Component capture_button_;
+  std::shared_ptr<CaptureView> capture_view_;
+  Component pattern_button_;
+  std::shared_ptr<PatternView> pattern_view_;
+  Component bus_button_;
+  std::shared_ptr<BusView> bus_view_;
+  int rate_ = 2;
   std::vector<std::string> gpio_names;
   Component gpio_menu;
   Component gpio_individual;
@@ -615,8 +1278,8 @@ class GPIOImpl : public PanelBase {
 };
 
 namespace panel {
-Panel GPIO() {
-  return Make<GPIOImpl>();
+Panel GPIO(ScreenInteractive* screen, Scheduler* scheduler) {
+  return Make<GPIOImpl>(screen, scheduler);
 }
 }  // namespace panel
 }  // namespace ui
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include <fstream>
 #include "ftxui/component/component.hpp"
 #include "ftxui/dom/elements.hpp"
+#include "hw/root.hpp"
 #include "ui/panel/panel.hpp"
 #include "xdg_utils.hpp"
 
@@ -26,7 +27,7 @@ std::string BeagleConfigPath() {
 
 int CountNameserver() {
   size_t count = 0;
-  std::ifstream file("/etc/resolv.conf");
+  std::ifstream file(hw::Rooted("/etc/resolv.conf"));
 
   std::string line;
   while (std::getline(file, line)) {
@@ -68,9 +69,7 @@ class ICSImpl : public PanelBase {
     }));
   }
   ~ICSImpl() = default;
-  std::string Title() override {
-    return "Internet Sharing and Client Configuration";
-  }
+  std::string Title() override { return panel::title::ICS; }
 
  private:
   bool route_add_ = true;
@@ -129,7 +128,7 @@ class ICSImpl : public PanelBase {
     }
 
     /* Check if it has the access */
-    std::ofstream file("/etc/resolv.conf", std::ofstream::app);
+    std::ofstream file(hw::Rooted("/etc/resolv.conf"), std::ofstream::app);
 
     if (!file.good()) {
       shutdown(socket_file_descriptor, SHUT_RDWR);
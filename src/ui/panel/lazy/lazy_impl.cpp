@@ -0,0 +1,126 @@
+#include <atomic>
+#include <functional>
+#include "ftxui/dom/elements.hpp"
+#include "thread_pool.hpp"
+#include "trace.hpp"
+#include "ui/panel/panel.hpp"
+
+using namespace ftxui;
+
+namespace ui {
+
+namespace {
+
+// A panel whose body is only built the first time it is needed. Until then,
+// only its title is known.
+class LazyImpl : public PanelBase {
+ public:
+  LazyImpl(std::string title, std::function<Panel()> factory)
+      : title_(std::move(title)), state_(std::make_shared<State>()) {
+    state_->factory = std::move(factory);
+    state_->trace_name =
+        trace::Enabled() ? trace::Intern("Build " + title_) : nullptr;
+  }
+  ~LazyImpl() = default;
+
+  std::string Title() override { return title_; }
+
+  // Build the panel on |pool|. It is handed back to the UI thread through
+  // |screen| once ready.
+  void Prefetch(ScreenInteractive* screen, ThreadPool* pool) {
+    pool->Post([state = state_, screen] {
+      if (state->claimed.exchange(true))
+        return;
+      Panel panel = state->Build();
+      screen->Post([state, panel] { state->ready = panel; });
+      screen->PostEvent(Event::Custom);
+    });
+  }
+
+  Element Render() override {
+    if (!Get()) {
+      return hbox({
+                 spinner(2, loading_iteration_++),
+                 text(" Loading " + title_ + "..."),
+             }) |
+             center;
+    }
+    return panel_->Render();
+  }
+
+  bool OnEvent(Event event) override {
+    if (!Get())
+      return false;
+    return panel_->OnEvent(event);
+  }
+
+  void OnDisplay() override {
+    if (panel_)
+      panel_->OnDisplay();
+  }
+
+  bool TakeDirty() override {
+    // Keep animating the loading indicator until the panel is ready.
+    if (!panel_)
+      return true;
+    bool dirty = PanelBase::TakeDirty();
+    return panel_->TakeDirty() || dirty;
+  }
+
+ private:
+  struct State {
+    Panel Build() {
+      TRACE_SCOPE(trace_name);
+      return factory();
+    }
+
+    std::function<Panel()> factory;
+    const char* trace_name;
+    // Set by whichever of the UI thread or the pool builds the panel.
+    std::atomic<bool> claimed{false};
+    // Only accessed from the UI thread.
+    Panel ready;
+  };
+
+  // Returns the panel, building it synchronously if nobody started yet.
+  // Returns null while it is being built in the background.
+  Panel Get() {
+    if (panel_)
+      return panel_;
+
+    if (!state_->claimed.exchange(true))
+      state_->ready = state_->Build();
+
+    if (!state_->ready)
+      return nullptr;
+
+    panel_ = std::move(state_->ready);
+    state_->factory = nullptr;
+    Add(panel_);
+    return panel_;
+  }
+
+  std::string title_;
+  std::shared_ptr<State> state_;
+  Panel panel_;
+  size_t loading_iteration_ = 0;
+};
+
+}  // namespace
+
+namespace panel {
+Panel Lazy(const std::string& title, std::function<Panel()> factory) {
+  return Make<LazyImpl>(title, std::move(factory));
+}
+
+Panel Background(const std::string& title,
+                 std::function<Panel()> factory,
+                 ScreenInteractive* screen,
+                 ThreadPool* pool) {
+  auto panel = Make<LazyImpl>(title, std::move(factory));
+  panel->Prefetch(screen, pool);
+  return panel;
+}
+
+}  // namespace panel
+}  // namespace ui
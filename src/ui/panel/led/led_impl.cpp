@@ -1,34 +1,18 @@
-#include <fstream>
-#include <sstream>
+#include <utility>
 #include "ftxui/component/component.hpp"
 #include "ftxui/dom/elements.hpp"
-#include "process.hpp"
+#include "hw/led.hpp"
+#include "trace.hpp"
 #include "ui/panel/panel.hpp"
 
-#define LEDS_PATH "/sys/class/leds/"
-
 using namespace ftxui;
 
 namespace ui {
 
-std::vector<std::string> FindLEDs() {
-  std::vector<std::string> names;
-
-  procxx::process ls{"ls"};
-  ls.add_argument("-C1");
-  ls.add_argument("/sys/class/leds/");
-  ls.exec();
-
-  std::string name;
-  while (std::getline(ls.output(), name))
-    names.push_back(name);
-  return names;
-}
-
 // A component displaying an individual LED.
 class Led : public ComponentBase {
  public:
-  Led(std::string name) : name_(name), file_path_("/sys/class/leds/" + name) {
+  Led(std::string name) : name_(name) {
     FetchState();
 
     Add(Container::Vertical({
@@ -44,43 +28,26 @@ class Led : public ComponentBase {
 
  private:
   void FetchState() {
-    std::ifstream(file_path_ + "/brightness") >> brightness_;
-    trigger_entries_.clear();
-    trigger_selected_ = 0;
-
-    std::ifstream file(file_path_ + "/trigger");
-    std::string trigger;
-    std::getline(file, trigger);
-
-    std::string entry;
-    std::stringstream ss(trigger);
-    while (std::getline(ss, entry, ' ')) {
-      if (entry.front() == '[')
-        trigger_selected_ = trigger_entries_.size();
-      trigger_entries_.push_back(entry);
-    }
-
-    size_t left = trigger.find('[');
-    size_t right = trigger.find(']');
-    if (left < right && left != std::string::npos && right != std::string::npos)
-      trigger_ = trigger.substr(left + 1, right - left - 1);
-    else
-      trigger_ = "error";
+    TRACE_SCOPE("Led::FetchState");
+    auto state = hw::led::Read(name_);
+    brightness_ = state.brightness;
+    trigger_entries_ = std::move(state.triggers);
+    trigger_selected_ = state.trigger_selected;
+    trigger_ = state.trigger;
   }
 
   void Toggle() {
+    TRACE_SCOPE("Led::Toggle");
     brightness_ = !brightness_;
-    std::ofstream(file_path_ + "/brightness") << brightness_;
-    std::ofstream(file_path_ + "/trigger") << "none";
+    hw::led::SetBrightness(name_, brightness_);
+    hw::led::SetTrigger(name_, "none");
     FetchState();
   }
 
   void TriggerTimer() {
-    std::ofstream(file_path_ + "/trigger") << "timer";
-    std::ofstream(file_path_ + "/delay_on")
-        << std::to_string(int(ratio_ * period_));
-    std::ofstream(file_path_ + "/delay_off")
-        << std::to_string(int((1.f - ratio_) * period_));
+    TRACE_SCOPE("Led::TriggerTimer");
+    hw::led::SetTimer(name_, int(ratio_ * period_),
+                      int((1.f - ratio_) * period_));
     FetchState();
   }
 
@@ -111,15 +78,13 @@ class Led : public ComponentBase {
     int trigger_selected = trigger_selected_;
     bool ret = ComponentBase::OnEvent(event);
     if (trigger_selected != trigger_selected_) {
-      std::ofstream(file_path_ + "/trigger")
-          << trigger_entries_[trigger_selected_];
+      hw::led::SetTrigger(name_, trigger_entries_[trigger_selected_]);
       FetchState();
     }
     return ret;
   }
 
   const std::string name_;
-  const std::string file_path_;
   int brightness_ = 0;
   int period_ = 20;
   float ratio_ = 0.5f;
@@ -140,7 +105,7 @@ class Led : public ComponentBase {
 class LedPanel : public PanelBase {
  public:
   LedPanel() {
-    for (auto name : FindLEDs()) {
+    for (auto name : hw::led::FindLEDs()) {
       names_.push_back(name);
       led_tab_->Add(Make<Led>(name));
     }
@@ -163,7 +128,7 @@ class LedPanel : public PanelBase {
            vscroll_indicator | frame;
   }
 
-  std::string Title() override { return "LEDs"; }
+  std::string Title() override { return panel::title::Led; }
 
   int selected_led_ = 0;
   std::vector<std::string> names_;
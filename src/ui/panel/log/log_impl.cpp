@@ -0,0 +1,125 @@
+#include <chrono>
+#include <ctime>
+#include <string>
+#include <vector>
+#include "ftxui/component/component.hpp"
+#include "ftxui/dom/elements.hpp"
+#include "log.hpp"
+#include "scheduler.hpp"
+#include "ui/panel/panel.hpp"
+
+using namespace ftxui;
+using namespace std::chrono_literals;
+
+namespace ui {
+
+namespace {
+
+// The lowest level displayed, as the entries of the filter.
+const std::vector<std::string> levelEntries = {
+    "Debug",
+    "Info",
+    "Warning",
+    "Error",
+};
+
+// eg. 12:34:56
+std::string FormatTime(int64_t time_ns) {
+  time_t seconds = time_ns / 1000000000;
+  tm local;
+  localtime_r(&seconds, &local);
+  char buffer[16];
+  std::strftime(buffer, sizeof(buffer), "%T", &local);
+  return buffer;
+}
+
+Decorator LevelColor(logging::Level level) {
+  switch (level) {
+    case logging::Level::Debug:
+      return dim;
+    case logging::Level::Warning:
+      return color(Color::Yellow);
+    case logging::Level::Error:
+      return color(Color::Red);
+    default:
+      return nothing;
+  }
+}
+
+}  // namespace
+
+class LogImpl : public PanelBase {
+ public:
+  LogImpl(ScreenInteractive* screen, Scheduler* scheduler)
+      : screen_(screen), scheduler_(scheduler) {
+    Add(Container::Vertical({level_toggle_}));
+    // Follow the messages as they are written, while the panel is displayed.
+    job_ = scheduler_->Add(500ms, [this] {
+      uint64_t generation = logging::Generation();
+      if (generation != generation_) {
+        generation_ = generation;
+        MarkDirty();
+      }
+      // A frame even without messages, for OnDisplay() to keep the job going.
+      screen_->PostEvent(Event::Custom);
+    });
+  }
+
+  ~LogImpl() override { scheduler_->Remove(job_); }
+
+  std::string Title() override { return panel::title::Log; }
+
+  void OnDisplay() override { scheduler_->Touch(job_); }
+
+  Element Render() override {
+    auto recent = logging::Recent();
+    Elements lines;
+    for (const auto& entry : recent) {
+      if (static_cast<int>(entry.level) < level_)
+        continue;
+      std::string level(1, logging::LevelLetter(entry.level));
+      lines.push_back(hbox({
+                          text(FormatTime(entry.time_ns) + " " + level + " "),
+                          text(entry.source + " ") | dim,
+                          text(entry.text),
+                      }) |
+                      LevelColor(entry.level));
+    }
+    if (lines.empty())
+      lines.push_back(text("No messages") | dim);
+    // Keep the latest message in view.
+    lines.back() = lines.back() | focus;
+
+    std::string dropped;
+    if (logging::Dropped())
+      dropped = ", " + std::to_string(logging::Dropped()) + " dropped";
+
+    return window(text("Log"),
+                  vbox({
+                      hbox(text("Level: "), level_toggle_->Render()),
+                      separator(),
+                      vbox(std::move(lines)) | vscroll_indicator | yframe |
+                          flex,
+                      separator(),
+                      text(std::to_string(recent.size()) +
+                           " recent messages" + dropped) |
+                          dim,
+                  }));
+  }
+
+ private:
+  ScreenInteractive* screen_;
+  Scheduler* scheduler_;
+  Scheduler::JobId job_;
+  uint64_t generation_ = 0;  // Scheduler thread only.
+  int level_ = 0;
+  Component level_toggle_ = Toggle(&levelEntries, &level_);
+};
+
+namespace panel {
+Panel Log(ScreenInteractive* screen, Scheduler* scheduler) {
+  return Make<LogImpl>(screen, scheduler);
+}
+}  // namespace panel
+
+}  // namespace ui
@@ -1,27 +1,60 @@
 #ifndef BEAGLE_CONFIG_PANEL_HPP
 #define BEAGLE_CONFIG_PANEL_HPP
 
+#include <atomic>
+#include <functional>
 #include <memory>
 #include "ftxui/component/component.hpp"
 #include "ftxui/component/screen_interactive.hpp"
 
+class Scheduler;
+class ThreadPool;
+
 namespace ui {
 using namespace ftxui;
 
 // A PanelBase is a Component with an associated title.
+//
+// The element it renders is cached, and reused until the panel receives an
+// event or is displayed again. Panels whose state is changed from elsewhere,
+// e.g. a background thread, must call MarkDirty() before posting an event to
+// the screen. The scheduler jobs feeding a panel are kept visible from
+// OnDisplay(), which runs even when the cached element is reused.
 class PanelBase : public ftxui::ComponentBase {
  public:
   virtual ~PanelBase() {}
   virtual std::string Title() = 0;
+
+  // Thread-safe.
+  void MarkDirty() { dirty_ = true; }
+
+  // Returns whether MarkDirty() was called since the last call.
+  virtual bool TakeDirty() { return dirty_.exchange(false); }
+
+  // Called at every frame the panel is displayed, before Render() if it is
+  // rendered again.
+  virtual void OnDisplay() {}
+
+ private:
+  std::atomic<bool> dirty_{false};
 };
 
 using Panel = std::shared_ptr<PanelBase>;
 
 namespace panel {
+// Defer building the panel until it is displayed for the first time.
+Panel Lazy(const std::string& title, std::function<Panel()> factory);
+// Start building the panel on |pool| right away. A loading indicator is
+// displayed if it is shown before being ready.
+Panel Background(const std::string& title,
+                 std::function<Panel()> factory,
+                 ScreenInteractive* screen,
+                 ThreadPool* pool);
+
 Panel PlaceHolder(const std::string& title);
 Panel PRU();
-Panel GPIO();
-Panel ADC(ScreenInteractive*);
+Panel GPIO(ScreenInteractive*, Scheduler*);
+Panel ADC(ScreenInteractive*, Scheduler*);
 Panel DAC();
 Panel ICS();
 Panel EMMC();
@@ -32,8 +65,28 @@ Panel BackgroundWorker(ScreenInteractive*);
 Panel service(ScreenInteractive*);
 Panel PinMux();
 Panel About();
+Panel Log(ScreenInteractive*, Scheduler*);
 Panel passwd();
 Panel ssh();
+
+// The titles of the panels above, known before they are built.
+namespace title {
+constexpr char PRU[] = "PRU enable/disable";
+constexpr char GPIO[] = "GPIO";
+constexpr char DAC[] = "DAC";
+constexpr char EMMC[] = "EMMC and MicroSD stats";
+constexpr char Led[] = "LEDs";
+constexpr char uEnv[] = "uEnv";
+constexpr char passwd[] = "Password";
+constexpr char ssh[] = "SSH";
+constexpr char PinMux[] = "PinMux";
+constexpr char service[] = "Services";
+constexpr char ADC[] = "ADC";
+constexpr char WiFi[] = "WiFi";
+constexpr char ICS[] = "Internet Sharing and Client Configuration";
+constexpr char Log[] = "Log";
+constexpr char About[] = "About";
+}  // namespace title
 }  // namespace panel
 }  // namespace ui
 
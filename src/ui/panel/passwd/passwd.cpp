@@ -48,7 +48,7 @@ class passwdImpl : public PanelBase {
     Add(layout);
   }
   ~passwdImpl() = default;
-  std::string Title() override { return "Password"; }
+  std::string Title() override { return panel::title::passwd; }
 
  private:
   std::string password_old_;
@@ -1,5 +1,8 @@
 #include "ftxui/component/component.hpp"
 #include "ftxui/dom/elements.hpp"
+#include "hw/pinmux.hpp"
+#include "hw/root.hpp"
+#include "trace.hpp"
 #include "ui/panel/panel.hpp"
 #include "utils.hpp"
 
@@ -16,28 +19,16 @@ namespace ui {
 
 namespace {
 
-const std::string PinConfigPath = "/sys/devices/platform/ocp";
-const std::string DeviceNamePath = "/proc/device-tree/model";
-
-const std::string PocketName = "TI AM335x PocketBeagle";
-const std::string BlackName = "TI AM335x BeagleBone Black";
-const std::string BlueName = "TI AM335x BeagleBone Blue";
-const std::string AI_Name = "BeagleBoard.org BeagleBone AI";
-
-struct PinDetail {
-  std::string header;        // eg. P9_22
-  std::string name;          // eg. gpio
-  std::string info;          // Pin info
-  std::string pru;           // Pru pin
-  std::string gpio;          // gpio pin
-  std::string pinmux;        // List of Pinmux which can config
-  std::string pinmux_value;  // Pinmux Current mode
-  bool config = false;       // Support PINMUX
-};
+std::string PinConfigPath() {
+  return hw::Rooted("/sys/devices/platform/ocp");
+}
+
+using hw::pinmux::BlueName;
+using hw::pinmux::PocketName;
 
 class ConfigPinMux : public ComponentBase {
  public:
-  ConfigPinMux(struct PinDetail pin) : pin_(pin) {
+  ConfigPinMux(hw::pinmux::PinDetail pin) : pin_(pin) {
     update_configDropdown();
 
     Add(Container::Vertical({
@@ -52,7 +43,7 @@ class ConfigPinMux : public ComponentBase {
   Element Render() override {
     return vbox({
                text(pin_.header),
-               text(PinConfigPath + "/ocp:" + pin_.header + "_pinmux/state"),
+               text(hw::pinmux::StatePath(pin_.header)),
                separator(),
                configDropdwon_->Render() | flex,
                separator(),
@@ -73,12 +64,11 @@ class ConfigPinMux : public ComponentBase {
   }
 
   void config_apply() {
-    std::ofstream file(PinConfigPath + "/ocp:" + pin_.header + "_pinmux/state");
-    file << configValues[configSelected_];
-    file.close();
+    TRACE_SCOPE("ConfigPinMux::config_apply");
+    hw::pinmux::SetState(pin_.header, configValues[configSelected_]);
   }
 
-  struct PinDetail pin_;
+  hw::pinmux::PinDetail pin_;
   int configSelected_ = 0;
   std::vector<std::string> configValues;
   Component configDropdwon_ = Dropdown(&configValues, &configSelected_);
@@ -103,84 +93,31 @@ class PinMuxImpl : public PanelBase {
 
   ~PinMuxImpl() = default;
 
-  std::string Title() override { return "PinMux"; }
+  std::string Title() override { return panel::title::PinMux; }
 
  private:
   // Get device name
-  void get_device_name() { std::ifstream(DeviceNamePath) >> device_name_; }
+  void get_device_name() { device_name_ = hw::pinmux::BoardModel(); }
 
   // Get pin detail from file
   void get_pin_detail() {
-    std::ifstream inFile;
-    std::string pin_header_selection;
-    if (!device_name_.compare(PocketName)) {
-      inFile.open("../src/ui/panel/pinmux/pin_info_pocket");
-      pin_header_selection = "P1";
-    } else {
-      inFile.open("../src/ui/panel/pinmux/pin_info");
-      pin_header_selection = "P8";
-    }
-
-    std::string file_line;
-    pin_P1_P8_.clear();
-    pin_P2_P9_.clear();
-
-    while (getline(inFile, file_line)) {
-      if (file_line.compare("") == 0)
-        continue;
-
-      std::string head, tail, info, func, last;
-
-      struct PinDetail temp_pin;
-
-      do {
-        std::stringstream str(file_line);
-        getline(str, head, '_');
-        getline(str, tail, '_');
-        getline(str, last, '_');
-        std::stringstream str2(last);
-        getline(str2, info, '=');
-        std::stringstream str3(file_line);
-        while (str3.good()) {
-          getline(str3, func, '=');
-        }
-
-        temp_pin.header = head + "_" + tail;
-        func = func.substr(1, func.size() - 2);
-        if (!info.compare("INFO")) {
-          temp_pin.info = func;
-        } else if (!info.compare("PIN")) {
-          temp_pin.name = func;
-        } else if (!info.compare("PRU")) {
-          temp_pin.pru = func;
-        } else if (!info.compare("GPIO")) {
-          temp_pin.gpio = func;
-        } else if (!info.compare("PINMUX")) {
-          temp_pin.pinmux = func;
-        } else if (!info.compare("CAPE")) {
-          if (!head.compare(pin_header_selection)) {
-            pin_P1_P8_.push_back(temp_pin);
-          } else {
-            pin_P2_P9_.push_back(temp_pin);
-          }
-
-          break;
-        }
-      } while (getline(inFile, file_line));
-    }
-
-    inFile.close();
+    TRACE_SCOPE("PinMuxImpl::get_pin_detail");
+    auto headers = hw::pinmux::LoadPins(device_name_);
+    pin_P1_P8_ = std::move(headers.p1_p8);
+    pin_P2_P9_ = std::move(headers.p2_p9);
   }
 
   // Get pinmux info current state
   void get_pinmux_status() {
-    const std::filesystem::path p = PinConfigPath;
+    TRACE_SCOPE("PinMuxImpl::get_pinmux_status");
+    const std::filesystem::path p = PinConfigPath();
     if (!std::filesystem::exists(p)) {
       config_features = false;
       return;
     }
 
-    for (const auto& it : std::filesystem::directory_iterator(PinConfigPath)) {
+    for (const auto& it :
+         std::filesystem::directory_iterator(PinConfigPath())) {
       std::string path = it.path();
       std::stringstream ss(path);
       std::string name;
@@ -214,21 +151,18 @@ class PinMuxImpl : public PanelBase {
       }
 
       std::stringstream ss4(pin);
-      int pin_num;
+      int pin_num = 0;
 
       ss4 >> pin_num;
 
-      if (pin_num - 1 >= 46)
+      auto& pins =
+          head.compare(pin_header_selection) ? pin_P2_P9_ : pin_P1_P8_;
+      if (pin_num < 1 || pin_num > (int)pins.size())
         continue;
 
       if (!name.compare("pinmux")) {
-        if (!head.compare(pin_header_selection)) {
-          pin_P1_P8_[pin_num - 1].config = true;
-          pin_P1_P8_[pin_num - 1].pinmux_value = pinmux_value;
-        } else {
-          pin_P2_P9_[pin_num - 1].config = true;
-          pin_P2_P9_[pin_num - 1].pinmux_value = pinmux_value;
-        }
+        pins[pin_num - 1].config = true;
+        pins[pin_num - 1].pinmux_value = pinmux_value;
       }
     }
   };
@@ -585,8 +519,8 @@ class PinMuxImpl : public PanelBase {
   int config_selected_[2] = {0, 0};
   int head_selected_[4] = {0, 0, 0, 0};
   std::string device_name_;
-  std::vector<struct PinDetail> pin_P1_P8_;
-  std::vector<struct PinDetail> pin_P2_P9_;
+  std::vector<hw::pinmux::PinDetail> pin_P1_P8_;
+  std::vector<hw::pinmux::PinDetail> pin_P2_P9_;
   std::vector<std::string> tab_names_ = {"Hardware", "Pin Detail", "PINMUX"};
   Component tabMenu_ =
       Menu(&tab_names_, &tab_selected_, MenuOption::HorizontalAnimated());
@@ -2,6 +2,8 @@
 #include <fstream>
 #include <unordered_map>
 #include "ftxui/dom/elements.hpp"
+#include "hw/root.hpp"
+#include "trace.hpp"
 #include "ui/panel/panel.hpp"
 
 using namespace ftxui;
@@ -22,6 +24,7 @@ class Pru : public ComponentBase {
 
  private:
   void Fetch() {
+    TRACE_SCOPE("Pru::Fetch");
     std::ifstream(path_ + "/name") >> name_;
     std::ifstream(path_ + "/firmware") >> firmware_;
     std::ifstream(path_ + "/state") >> state_;
@@ -37,6 +40,7 @@ class Pru : public ComponentBase {
   }
 
   void StoreState(std::string state) {
+    TRACE_SCOPE("Pru::StoreState");
     std::ofstream(path_ + "/state") << state;
     Fetch();
   };
@@ -61,15 +65,15 @@ class Pru : public ComponentBase {
 class PRUPanel : public PanelBase {
  public:
   PRUPanel() { BuildUI(); }
-  std::string Title() override { return "PRU enable/disable"; }
+  std::string Title() override { return panel::title::PRU; }
 
  private:
   void BuildUI() {
-    if (!std::filesystem::exists("/sys/class/remoteproc/"))
+    const std::string remoteproc = hw::Rooted("/sys/class/remoteproc/");
+    if (!std::filesystem::exists(remoteproc))
       return;
     Component vertical_list = Container::Vertical({});
-    for (const auto& it :
-         std::filesystem::directory_iterator("/sys/class/remoteproc/")) {
+    for (const auto& it : std::filesystem::directory_iterator(remoteproc)) {
       auto pru = std::make_shared<Pru>(it.path());
       children_.push_back(pru);
       vertical_list->Add(pru);
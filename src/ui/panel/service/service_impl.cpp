@@ -1,4 +1,5 @@
 #include "ftxui/component/component.hpp"
+#include "trace.hpp"
 #include "ui/panel/panel.hpp"
 #include "utils.hpp"
 
@@ -52,7 +53,7 @@ class ServiceImpl : public PanelBase {
       thread_.join();
   }
 
-  std::string Title() override { return "Services"; }
+  std::string Title() override { return panel::title::service; }
 
  private:
   /*
@@ -60,6 +61,7 @@ class ServiceImpl : public PanelBase {
    * in the systemd. Services will store inside list_services_
    */
   void get_services() {
+    TRACE_SCOPE("ServiceImpl::get_services");
     list_services_.clear();
 
     /* Initialize all the variable */
@@ -227,6 +229,7 @@ class ServiceImpl : public PanelBase {
       get_services();
       build_ui();
       tab_selected_ = 0;
+      MarkDirty();
       screen_->PostEvent(Event::Custom);
     });
   }
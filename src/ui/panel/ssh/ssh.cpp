@@ -41,7 +41,7 @@ class sshImpl : public PanelBase {
     Add(page);
   }
   ~sshImpl() = default;
-  std::string Title() override { return "SSH"; }
+  std::string Title() override { return panel::title::ssh; }
 
  private:
   void get_ssh_status() {
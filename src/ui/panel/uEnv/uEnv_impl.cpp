@@ -1,13 +1,17 @@
 #include "ftxui/component/component.hpp"
 #include "ftxui/dom/elements.hpp"
+#include "hw/root.hpp"
+#include "uenv/uenv.hpp"
 #include "ui/panel/panel.hpp"
 
 #include <fstream>
-#include <regex>
 #include <sstream>
 #include <vector>
 
-const std::string File_uEnv = "/boot/uEnv.txt";
+std::string File_uEnv() {
+  return hw::Rooted("/boot/uEnv.txt");
+}
+
 const std::string File_Backup = "./uEnv_bkp.txt";
 
 using namespace ftxui;
@@ -56,11 +60,7 @@ class MenuConfigs : public ComponentBase {
 class uEnvImpl : public PanelBase {
  public:
   uEnvImpl() {
-    get_menuConfigs();
-
-    for (auto name : menuNames_) {
-      get_menuOptions(name);
-    }
+    load_menus();
 
     Add(Container::Tab({Container::Vertical({
                             radiobox_,
@@ -73,14 +73,13 @@ class uEnvImpl : public PanelBase {
                        &tab_selected_));
   }
 
-  std::string Title() override { return "uEnv"; }
+  std::string Title() override { return panel::title::uEnv; }
 
  private:
   int selected = 0;
   int tab_selected_ = 0;
   std::vector<std::string> menuNames_;
   std::vector<std::shared_ptr<MenuConfigs>> menuConfig_;
-  std::vector<Enviroment>* env_ptr;
   Component env_individual;
   Component radiobox_ = Radiobox(&menuNames_, &selected);
   Component env_tab_ = Container::Tab({}, &selected);
@@ -107,102 +106,25 @@ class uEnvImpl : public PanelBase {
     return (tab_selected_ == 0) ? page : error;
   }
 
-  // Read Menu Class
-  void get_menuConfigs() {
-    menuNames_.clear();
-
-    std::ifstream inFile;
-    inFile.open(File_uEnv);
+  // Read the menus and their options
+  void load_menus() {
+    std::ifstream inFile(File_uEnv());
 
     if (!inFile) {
       tab_selected_ = 1;
       return;
     }
 
-    std::string file_line;
-    bool s_flags = false;
-
-    while (getline(inFile, file_line)) {
-      if (!file_line.compare("###U-Boot Overlays###") && !s_flags) {
-        s_flags = true;
-      } else if (!file_line.compare("###U-Boot Overlays###") && s_flags) {
-        break;
-      }
-
-      if (std::regex_match(file_line, std::regex("(###[A-Z])(.*)"))) {
-        if (std::regex_match(file_line, std::regex("(###Documentation)(.*)")))
-          continue;
-        else if (std::regex_match(file_line,
-                                  std::regex("(###U-Boot Overlays###)")))
-          continue;
-
-        std::string temp = file_line;
-        temp.erase(remove(temp.begin(), temp.end(), '#'), temp.end());
+    for (auto& section : uenv::Parse(inFile)) {
+      auto* env = new std::vector<Enviroment>;
+      for (auto& option : section.options)
+        env->push_back({std::move(option.name), option.commented});
 
-        menuNames_.push_back(temp);
-      }
+      auto menu = std::make_shared<MenuConfigs>(section.name, env);
+      menuNames_.push_back(section.name);
+      menuConfig_.push_back(menu);
+      env_tab_->Add(menu);
     }
-
-    inFile.close();
-  }
-
-  // Read each configs from the class
-  void get_menuOptions(const std::string& config) {
-    env_ptr = new std::vector<Enviroment>;
-
-    std::ifstream inFile;
-    inFile.open(File_uEnv);
-
-    if (!inFile) {
-      tab_selected_ = 1;
-      return;
-    }
-
-    std::string file_line;
-    bool s_flags = false;
-    Enviroment tempEnv;
-
-    while (getline(inFile, file_line)) {
-      if (s_flags) {
-        if (!file_line.compare("###U-Boot Overlays###")) {
-          auto menu = std::make_shared<MenuConfigs>(config, env_ptr);
-          menuConfig_.push_back(menu);
-          env_tab_->Add(menu);
-          break;
-        }
-        if (file_line.compare("###") == 0) {
-          auto menu = std::make_shared<MenuConfigs>(config, env_ptr);
-          menuConfig_.push_back(menu);
-          env_tab_->Add(menu);
-          break;
-        }
-        if (std::regex_match(file_line, std::regex("(###[a-z])(.*)")))
-          continue;
-
-        std::string temp = file_line;
-        temp.erase(remove(temp.begin(), temp.end(), '#'), temp.end());
-
-        if (file_line[0] == '#')
-          tempEnv.status = true;
-        else
-          tempEnv.status = false;
-
-        tempEnv.name = temp;
-
-        env_ptr->push_back(tempEnv);
-      }
-
-      if (std::regex_match(file_line, std::regex("(###[A-Z])(.*)"))) {
-        std::string temp = file_line;
-        temp.erase(remove(temp.begin(), temp.end(), '#'), temp.end());
-
-        if (!config.compare(temp)) {
-          s_flags = true;
-        }
-      }
-    }
-
-    inFile.close();
   }
 
   // Refresh list
@@ -210,10 +132,7 @@ class uEnvImpl : public PanelBase {
     menuNames_.clear();
     menuConfig_.clear();
 
-    get_menuConfigs();
-    for (auto name : menuNames_) {
-      get_menuOptions(name);
-    }
+    load_menus();
     selected = 0;
   }
 
@@ -222,7 +141,7 @@ class uEnvImpl : public PanelBase {
     std::ifstream infile;
     std::ofstream outfile;
 
-    infile.open(File_uEnv);
+    infile.open(File_uEnv());
     outfile.open(File_Backup);
 
     std::string file_line;
@@ -232,19 +151,17 @@ class uEnvImpl : public PanelBase {
 
     while (getline(infile, file_line)) {
       if (s_flags) {
-        if (std::regex_match(file_line, std::regex("(###[a-z])(.*)")))
+        if (uenv::IsComment(file_line))
           outfile << file_line << std::endl;
 
         if (file_line.compare("###") == 0)
           outfile << file_line << std::endl;
 
-        if (std::regex_match(file_line, std::regex("(###[A-Z])(.*)"))) {
-          if (std::regex_match(file_line,
-                               std::regex("(###Documentation)(.*)"))) {
+        if (uenv::IsSectionHeader(file_line)) {
+          if (!file_line.compare(0, 16, "###Documentation")) {
             outfile << file_line << std::endl;
             continue;
-          } else if (std::regex_match(file_line,
-                                      std::regex("(###U-Boot Overlays###)"))) {
+          } else if (!file_line.compare("###U-Boot Overlays###")) {
             outfile << file_line << std::endl;
             s_flags = false;
             continue;
@@ -254,7 +171,7 @@ class uEnvImpl : public PanelBase {
           tempEnv = menuConfig_.at(track++)->get_Env();
           for (auto env : *tempEnv) {
             getline(infile, file_line);
-            if (std::regex_match(file_line, std::regex("(###[a-z])(.*)"))) {
+            if (uenv::IsComment(file_line)) {
               outfile << file_line << std::endl;
               getline(infile, file_line);
             }
@@ -286,7 +203,7 @@ class uEnvImpl : public PanelBase {
     std::fstream outfile;
 
     infile.open(File_Backup);
-    outfile.open(File_uEnv, std::ios::in | std::ios::out);
+    outfile.open(File_uEnv(), std::ios::in | std::ios::out);
 
     outfile.seekg(0, std::ios_base::beg);
 
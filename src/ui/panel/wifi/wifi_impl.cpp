@@ -16,8 +16,11 @@
 #include <thread>
 #include <unordered_map>
 #include <vector>
+#include "connman/connman.hpp"
 #include "ftxui/component/component.hpp"
 #include "ftxui/dom/elements.hpp"
+#include "hw/root.hpp"
+#include "trace.hpp"
 #include "ui/panel/panel.hpp"
 #include "utils.hpp"
 
@@ -47,7 +50,7 @@ class WiFiImpl : public PanelBase {
  public:
   WiFiImpl(ScreenInteractive* screen) : screen_(screen) {
     // TODO:Is there a better method than this?
-    if (!std::filesystem::exists("/sys/class/net/wlan0")) {
+    if (!std::filesystem::exists(hw::Rooted("/sys/class/net/wlan0"))) {
       wifiCompatiblity = false;
     }
     if (wifiCompatiblity) {
@@ -90,7 +93,7 @@ class WiFiImpl : public PanelBase {
         wifi_scan_.join();
       }
   }
-  std::string Title() override { return "WiFi"; }
+  std::string Title() override { return panel::title::WiFi; }
 
   Element Render() override {
     if (wifiCompatiblity) {
@@ -151,8 +154,10 @@ class WiFiImpl : public PanelBase {
 
     scanning_ = true;
     wifi_scan_ = std::thread([=] {
+      trace::SetThreadName("wifi scan");
       ListWifiNames(wifi_list_receiver_->MakeSender(), [=] {
         scanning_ = false;
+        MarkDirty();
         screen_->PostEvent(Event::Custom);
       });
     });
@@ -292,46 +297,8 @@ class WiFiImpl : public PanelBase {
     /* Get connman services */
     shell_helper("connmanctl services | sed -e 's/[ \t]*//'", &result);
 
-    /* Temporary string to store wifi_macaddress*/
-    auto temp_start = "wifi_" + mac_address;
-
-    while (true) {
-      if (result.length() == 0) {
-        break;
-      }
-
-      /* Position of newline character */
-      size_t newline_pos = 1;
-      if (result.find("\n") != std::string::npos) {
-        newline_pos = result.find("\n");
-
-        /* Get current line from trimmed sub sequence */
-        auto current_line = reduce(result.substr(0, newline_pos));
-
-        /* Position of wifi_<macaddress> */
-        auto pos = current_line.find(temp_start);
-
-        /* Default check for std::string::npos */
-        if (pos != std::string::npos) {
-          /* pos==0 means that it is hidden and has no name*/
-          if (pos != 0) {
-            auto name = reduce(current_line.substr(0, pos));
-            auto act_pos = name.find("*A");
-            if (act_pos != std::string::npos) {
-              name.erase(act_pos, act_pos + name.find_first_of(" ") + 1);
-              active_name = name;
-            }
-            auto unique_name = current_line.substr(pos);
-            service_names[name] = unique_name;
-          } else {
-            service_names["hidden - " + current_line.substr(0, 10)] =
-                current_line;
-          }
-        } else {
-        }
-      }
-      result.erase(0, newline_pos + 1);
-    }
+    connman::ParseServices(result, "wifi_" + mac_address, &service_names,
+                           &active_name);
   }
 
   std::string ActiveWifiName() {
@@ -0,0 +1,95 @@
+#include "ui/render_stats.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+using namespace ftxui;
+
+namespace ui {
+
+namespace {
+
+std::string FormatMs(RenderStats::Duration duration) {
+  std::stringstream ss;
+  ss << std::fixed << std::setprecision(2)
+     << std::chrono::duration<float, std::milli>(duration).count() << "ms";
+  return ss.str();
+}
+
+// Above this, a panel is likely doing I/O on the render path.
+constexpr auto kSlowRender = std::chrono::milliseconds(10);
+
+}  // namespace
+
+void RenderStats::Add(Duration duration) {
+  samples_[renders_ % kSamples] = duration;
+  renders_++;
+}
+
+RenderStats::Duration RenderStats::Percentile(int percent) const {
+  size_t size = std::min(renders_, kSamples);
+  if (size == 0)
+    return Duration(0);
+
+  std::array<Duration, kSamples> sorted = samples_;
+  auto nth = sorted.begin() + (size - 1) * percent / 100;
+  std::nth_element(sorted.begin(), nth, sorted.begin() + size);
+  return *nth;
+}
+
+void FrameCounter::Tick() {
+  auto now = std::chrono::steady_clock::now();
+  frames_++;
+  if (now - window_start_ >= std::chrono::seconds(1)) {
+    fps_ = frames_;
+    frames_ = 0;
+    window_start_ = now;
+  }
+}
+
+Element ProfilerOverlay(const std::vector<PanelStats>& panels,
+                        const FrameCounter& frames) {
+  Elements title_list = {text("Panel"), separator()};
+  Elements p50_list = {text("p50"), separator()};
+  Elements p99_list = {text("p99"), separator()};
+  Elements cached_list = {text("Cached"), separator()};
+  Elements renders_list = {text("Renders"), separator()};
+
+  for (const auto& panel : panels) {
+    if (panel.stats->renders() == 0)
+      continue;
+
+    auto p99 = panel.stats->Percentile(99);
+    auto style = p99 > kSlowRender ? color(Color::Red) : nothing;
+    title_list.push_back(text(panel.title) | style);
+    p50_list.push_back(text(FormatMs(panel.stats->Percentile(50))) |
+                       align_right);
+    p99_list.push_back(text(FormatMs(p99)) | align_right | style);
+    cached_list.push_back(text(std::to_string(panel.stats->cached())) |
+                          align_right);
+    renders_list.push_back(text(std::to_string(panel.stats->renders())) |
+                           align_right);
+  }
+
+  auto table = hbox({
+      vbox(std::move(title_list)),
+      separator(),
+      vbox(std::move(p50_list)),
+      separator(),
+      vbox(std::move(p99_list)),
+      separator(),
+      vbox(std::move(cached_list)),
+      separator(),
+      vbox(std::move(renders_list)),
+  });
+
+  return window(text(" Render profiler (F12) "),
+                vbox({
+                    table,
+                    separator(),
+                    text("Frames per second: " + std::to_string(frames.fps())),
+                })) |
+         bgcolor(Color::Black) | clear_under;
+}
+
+}  // namespace ui
@@ -0,0 +1,58 @@
+#ifndef BEAGLE_CONFIG_UI_RENDER_STATS_HPP
+#define BEAGLE_CONFIG_UI_RENDER_STATS_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "ftxui/dom/elements.hpp"
+
+namespace ui {
+
+// Keep track of the latency of the most recent Render() calls of a component.
+class RenderStats {
+ public:
+  using Duration = std::chrono::steady_clock::duration;
+
+  void Add(Duration duration);
+  // A frame reusing the element of the last Render() call.
+  void AddCached() { cached_++; }
+
+  // Returns the |percent| percentile of the recorded latencies.
+  Duration Percentile(int percent) const;
+
+  size_t renders() const { return renders_; }
+  size_t cached() const { return cached_; }
+
+ private:
+  static constexpr size_t kSamples = 128;
+  std::array<Duration, kSamples> samples_;
+  size_t renders_ = 0;
+  size_t cached_ = 0;
+};
+
+// Measure the number of frames displayed during the last second.
+class FrameCounter {
+ public:
+  void Tick();
+  int fps() const { return fps_; }
+
+ private:
+  std::chrono::steady_clock::time_point window_start_;
+  int frames_ = 0;
+  int fps_ = 0;
+};
+
+struct PanelStats {
+  std::string title;
+  const RenderStats* stats;
+};
+
+// Display a table with the render latency of each panel.
+ftxui::Element ProfilerOverlay(const std::vector<PanelStats>& panels,
+                               const FrameCounter& frames);
+
+}  // namespace ui
+
+#endif /* end of include guard: BEAGLE_CONFIG_UI_RENDER_STATS_HPP */
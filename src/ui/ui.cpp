@@ -1,11 +1,16 @@
 #include "ui.hpp"
+#include <chrono>
 #include <iostream>
 #include <thread>
 #include <vector>
 #include "ftxui/component/screen_interactive.hpp"
 #include "ftxui/screen/string.hpp"
+#include "scheduler.hpp"
+#include "thread_pool.hpp"
+#include "trace.hpp"
 //#include "ui/focusable.hpp"
 #include "ui/panel/panel.hpp"
+#include "ui/render_stats.hpp"
 
 using namespace ftxui;
 
@@ -13,9 +18,21 @@ namespace ui {
 namespace {
 
 // Display a panel with a focusable title on top.
+//
+// The element rendered by the panel is reused across frames, unless:
+// - the panel received an event or an animation frame,
+// - the panel marked itself dirty,
+// - the panel gained or lost focus,
+// - the panel was not displayed in the previous frame.
+// |frame| is the number of the frame being rendered.
 class PanelAdapter : public ComponentBase {
  public:
-  PanelAdapter(Panel panel) : panel_(panel) {
+  PanelAdapter(Panel panel, const int* frame)
+      : panel_(panel),
+        frame_(frame),
+        trace_name_(trace::Enabled() ? trace::Intern("Render " +
+                                                     panel_->Title())
+                                     : nullptr) {
     title_ = Renderer([&](bool focused) {
       auto style = focused ? inverted : nothing;
       return text(panel_->Title()) | style;
@@ -28,17 +45,60 @@ class PanelAdapter : public ComponentBase {
   }
 
   Element Render() final {
+    TRACE_SCOPE(trace_name_);
+    panel_->OnDisplay();
+    bool focused = panel_->Focused();
+    bool displayed_last_frame = last_frame_ == *frame_ - 1;
+    bool dirty = panel_->TakeDirty();
+    if (!content_ || dirty || received_event_ || !displayed_last_frame ||
+        focused != focused_) {
+      auto start = std::chrono::steady_clock::now();
+      content_ = panel_->Render();
+      auto duration = std::chrono::steady_clock::now() - start;
+      render_stats_.Add(duration);
+    } else {
+      render_stats_.AddCached();
+    }
+    received_event_ = false;
+    focused_ = focused;
+    last_frame_ = *frame_;
+
     return vbox({
                title_->Render(),
                separator(),
-               panel_->Render() | flex,
+               content_ | flex,
            }) |
            flex;
   }
 
+  bool OnEvent(Event event) final {
+    // The custom events only wake the screen up, the panels updated from
+    // elsewhere are marked dirty.
+    if (event != Event::Custom)
+      received_event_ = true;
+    return ComponentBase::OnEvent(event);
+  }
+
+  void OnAnimation(animation::Params& params) final {
+    received_event_ = true;
+    ComponentBase::OnAnimation(params);
+  }
+
+  std::string Title() const { return panel_->Title(); }
+  const RenderStats& render_stats() const { return render_stats_; }
+
  private:
   Component title_;
   Panel panel_;
+  const int* frame_;
+  const char* trace_name_;
+
+  Element content_;
+  int last_frame_ = -1;
+  bool received_event_ = false;
+  bool focused_ = false;
+
+  RenderStats render_stats_;
 };
 
 // Add a line with a give |title| on top of a component.
@@ -64,7 +124,10 @@ struct Group {
 
 class MainMenu : public ComponentBase {
  public:
-  MainMenu(std::vector<Group> menu_group, ScreenInteractive* screen) {
+  MainMenu(std::vector<Group> menu_group,
+           ScreenInteractive* screen,
+           std::chrono::steady_clock::time_point start)
+      : start_(start) {
     // The sub menu:
     index_.resize(menu_group.size());
     menu_entries_.resize(menu_group.size());
@@ -93,7 +156,9 @@ class MainMenu : public ComponentBase {
       index_[i] = 0;
       for (auto it : menu_group[i].groups) {
         menu_entries_[i].push_back(it->Title());
-        tab_[i]->Add(Make<PanelAdapter>(std::move(it)));
+        auto adapter = Make<PanelAdapter>(std::move(it), &iteration_);
+        adapters_.push_back(adapter);
+        tab_[i]->Add(adapter);
       }
 
       menu_[i] = Header(menu_group[i].title, menu_[i]);
@@ -141,17 +206,50 @@ class MainMenu : public ComponentBase {
   }
 
   Element Render() override {
+    TRACE_SCOPE("MainMenu::Render");
     iteration_++;
     auto title = text(" bb-config ") | bold | color(Color::Cyan1) | hcenter;
-    return window(title, resizeable_split_->Render()) | bgcolor(Color::Black);
+    auto document =
+        window(title, resizeable_split_->Render()) | bgcolor(Color::Black);
+    frames_.Tick();
+    if (show_profiler_) {
+      std::vector<PanelStats> stats;
+      for (const auto& adapter : adapters_)
+        stats.push_back({adapter->Title(), &adapter->render_stats()});
+      document = dbox({
+          document,
+          vbox({
+              hbox({filler(), ProfilerOverlay(stats, frames_)}),
+              filler(),
+          }),
+      });
+    }
+    if (iteration_ == 1) {
+      first_frame_ = std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::steady_clock::now() - start_);
+    }
+    return document;
   }
 
+  bool OnEvent(Event event) override {
+    // Toggle the render profiler.
+    if (event == Event::F12) {
+      show_profiler_ = !show_profiler_;
+      return true;
+    }
+    return ComponentBase::OnEvent(event);
+  }
+
+  // Time between the start of ui::Loop() and the first frame being built.
+  std::chrono::milliseconds first_frame() const { return first_frame_; }
+
  private:
   // The nested menu.
   std::vector<int> index_;
   std::vector<std::vector<std::string>> menu_entries_;
   std::vector<Component> menu_;
   std::vector<Component> tab_;
+  std::vector<std::shared_ptr<PanelAdapter>> adapters_;
 
   // The global menu.
   int group_index_ = 0;
@@ -164,41 +262,85 @@ class MainMenu : public ComponentBase {
 
   // Allow visualizing when the UI is updated.
   int iteration_ = 0;
+
+  FrameCounter frames_;
+  bool show_profiler_ = false;
+
+  std::chrono::steady_clock::time_point start_;
+  std::chrono::milliseconds first_frame_{0};
 };
 
 }  // namespace
 
-void Loop() {
+// Target: the first frame should be displayed within 200ms on a BeagleBone
+// Black. By default, panels are built concurrently in the background while the
+// menu is already displayed, so startup costs as much as the slowest of them
+// instead of their sum. Use --startup-time to measure it.
+void Loop(const LoopOptions& options) {
+  auto start = std::chrono::steady_clock::now();
+  // Panels may outlive the main menu in the screen task queue, so the
+  // scheduler they use is declared first.
+  Scheduler scheduler;
   auto screen = ScreenInteractive::Fullscreen();
+  ThreadPool pool;
+
+  using Startup = LoopOptions::Startup;
+  auto make = [&](const std::string& title, std::function<Panel()> factory) {
+    switch (options.startup) {
+      case Startup::Background:
+        return panel::Background(title, std::move(factory), &screen, &pool);
+      case Startup::Lazy:
+        return panel::Lazy(title, std::move(factory));
+      case Startup::Eager:
+        break;
+    }
+    // Filled by the pool before the menu is built, see below.
+    auto panel = std::make_shared<Panel>();
+    pool.Post([panel, factory] { *panel = factory(); });
+    return panel::Lazy(title, [panel] { return *panel; });
+  };
+
+  namespace title = panel::title;
   std::vector<Group> groups = {
       {"System",
        {
-           panel::PRU(),
-           panel::GPIO(),
-           panel::DAC(),
-           panel::EMMC(),
-           panel::Led(),
-           panel::uEnv(),
-           panel::passwd(),
-           panel::ssh(),
-           panel::PinMux(),
-           panel::service(&screen),
-           panel::ADC(&screen),
+           make(title::PRU, panel::PRU),
+           make(title::GPIO, [&] { return panel::GPIO(&screen, &scheduler); }),
+           make(title::DAC, panel::DAC),
+           make(title::EMMC, panel::EMMC),
+           make(title::Led, panel::Led),
+           make(title::uEnv, panel::uEnv),
+           make(title::passwd, panel::passwd),
+           make(title::ssh, panel::ssh),
+           make(title::PinMux, panel::PinMux),
+           make(title::service, [&] { return panel::service(&screen); }),
+           make(title::ADC, [&] { return panel::ADC(&screen, &scheduler); }),
        }},
       {"Network",
        {
-           panel::WiFi(&screen),
-           panel::ICS(),
+           make(title::WiFi, [&] { return panel::WiFi(&screen); }),
+           make(title::ICS, panel::ICS),
        }},
       {"Info",
        {
            // TODO: panel::PlaceHolder("Update"),
-           panel::About(),
+           make(title::Log, [&] { return panel::Log(&screen, &scheduler); }),
+           make(title::About, panel::About),
        }},
   };
 
-  Component main_menu = Make<MainMenu>(std::move(groups), &screen);
+  if (options.startup == Startup::Eager)
+    pool.Wait();
+
+  auto main_menu = Make<MainMenu>(std::move(groups), &screen, start);
   screen.Loop(main_menu);
+  // Cancel the polling jobs without waiting for their next deadline.
+  scheduler.Stop();
+
+  if (options.report_startup_time) {
+    std::cout << "bb-config: first frame after "
+              << main_menu->first_frame().count() << "ms" << std::endl;
+  }
 }
 
 }  // namespace ui
@@ -2,7 +2,23 @@
 #define BEAGLE_CONFIG_UI_HPP
 
 namespace ui {
-void Loop();
-}
+
+struct LoopOptions {
+  enum class Startup {
+    // Build the panels concurrently in the background, and display a loading
+    // indicator for the ones not ready yet.
+    Background,
+    // Build each panel the first time it is displayed.
+    Lazy,
+    // Build every panel concurrently before the first frame.
+    Eager,
+  };
+  Startup startup = Startup::Background;
+  // Print the time it took to display the first frame after exiting.
+  bool report_startup_time = false;
+};
+
+void Loop(const LoopOptions& options = {});
+}  // namespace ui
 
 #endif /* end of include guard: BEAGLE_CONFIG_UI_HPP */
@@ -1,7 +1,15 @@
 #include "utils.hpp"
 #include "process.hpp"
+#include "trace.hpp"
+
+namespace {
+const char* TraceDetail(const char* cmd) {
+  return trace::Enabled() ? trace::Intern(cmd) : nullptr;
+}
+}  // namespace
 
 void shell_helper(const char* cmd, std::string* result) {
+  TRACE_SCOPE("shell_helper", TraceDetail(cmd));
   *result = "";
 
   procxx::process shell{"sh"};
@@ -20,6 +28,7 @@ void shell_helper(const char* cmd, std::string* result) {
 }
 
 void shell_helper(const char* cmd) {
+  TRACE_SCOPE("shell_helper", TraceDetail(cmd));
   procxx::process shell{"sh"};
   procxx::process::limits_t limits;
   limits.cpu_time(2);
@@ -32,6 +41,7 @@ void shell_helper(const char* cmd) {
 }
 
 void shell_helper_no_limit(const char* cmd) {
+  TRACE_SCOPE("shell_helper_no_limit", TraceDetail(cmd));
   procxx::process shell{"sh"};
   procxx::process::limits_t limits;
 
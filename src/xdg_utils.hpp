@@ -2,6 +2,7 @@
 #define XDG_UTILS_HPP
 
 #include <cstdlib>
+#include <iterator>
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -12,6 +13,7 @@ static constexpr const char HOME[]{"HOME"};
 static constexpr const char XDG_DATA_HOME_SUFFIX[]{"/.local/share"};
 static constexpr const char XDG_CONFIG_HOME_SUFFIX[]{"/.config"};
 static constexpr const char XDG_CACHE_HOME_SUFFIX[]{"/.cache"};
+static constexpr const char XDG_STATE_HOME_SUFFIX[]{"/.local/state"};
 static constexpr const char XDG_DATA_DIRS_DEFAULT[]{
     "/usr/local/share/:/usr/share/"};
 static constexpr const char XDG_CONFIG_DIRS_DEFAULT[]{"/etc/xdg"};
@@ -21,19 +23,18 @@ static const std::string XDG_DATA_DIRS{"XDG_DATA_DIRS"};
 static const std::string XDG_CONFIG_HOME{"XDG_CONFIG_HOME"};
 static const std::string XDG_CONFIG_DIRS{"XDG_CONFIG_DIRS"};
 static const std::string XDG_CACHE_HOME{"XDG_CACHE_HOME"};
+static const std::string XDG_STATE_HOME{"XDG_STATE_HOME"};
 static const std::string XDG_RUNTIME_DIR{"XDG_RUNTIME_DIR"};
 
 namespace env {
-static std::string get(const std::string& name,
+inline std::string get(const std::string& name,
                        const std::string& default_value);
-static std::string get(const std::string& name);
+inline std::string get(const std::string& name);
 }  // namespace env
 
 namespace string_utils {
 template <typename Out>
-static void split(const std::string& s,
-                  const std::string& delimiter,
-                  Out result) {
+void split(const std::string& s, const std::string& delimiter, Out result) {
   size_t start = 0;
   size_t end = s.find(delimiter);
 
@@ -46,7 +47,7 @@ static void split(const std::string& s,
   *(result++) = s.substr(start, end);
 }
 
-static std::vector<std::string> split(const std::string& s,
+inline std::vector<std::string> split(const std::string& s,
                                       const std::string& delimiter) {
   std::vector<std::string> tokens;
   split(s, delimiter, std::back_inserter(tokens));
@@ -55,15 +56,15 @@ static std::vector<std::string> split(const std::string& s,
 }
 }  // namespace string_utils
 
-static bool is_absolute_path(const std::string& path);
-static std::vector<std::string> remove_relative_paths(
+inline bool is_absolute_path(const std::string& path);
+inline std::vector<std::string> remove_relative_paths(
     const std::vector<std::string>& paths);
 
-bool is_absolute_path(const std::string& path) {
+inline bool is_absolute_path(const std::string& path) {
   return (!path.empty() && path[0] == '/');
 }
 
-std::vector<std::string> remove_relative_paths(
+inline std::vector<std::string> remove_relative_paths(
     const std::vector<std::string>& paths) {
   std::vector<std::string> absolute_paths;
 
@@ -74,15 +75,15 @@ std::vector<std::string> remove_relative_paths(
   return absolute_paths;
 }
 
-std::string env::get(const std::string& name) {
+inline std::string env::get(const std::string& name) {
   if (auto value = std::getenv(name.c_str()))
     return value;
 
   throw std::runtime_error(name + (": cannot be found"));
 }
 
-std::string env::get(const std::string& name,
-                     const std::string& default_value) {
+inline std::string env::get(const std::string& name,
+                            const std::string& default_value) {
   if (auto value = std::getenv(name.c_str()))
     return value;
   return default_value;
@@ -90,7 +91,7 @@ std::string env::get(const std::string& name,
 
 namespace data {
 
-std::string home() {
+inline std::string home() {
   auto path = env::get(XDG_DATA_HOME, "");
 
   if (!is_absolute_path(path)) {
@@ -103,7 +104,7 @@ std::string home() {
   return path;
 }
 
-std::vector<std::string> dirs() {
+inline std::vector<std::string> dirs() {
   auto paths = env::get(XDG_DATA_DIRS, "");
 
   if (paths.empty()) {
@@ -116,7 +117,7 @@ std::vector<std::string> dirs() {
 
 namespace config {
 
-std::string home() {
+inline std::string home() {
   auto path = env::get(XDG_CONFIG_HOME, "");
 
   if (!is_absolute_path(path)) {
@@ -128,7 +129,7 @@ std::string home() {
 
   return path;
 }
-std::vector<std::string> dirs() {
+inline std::vector<std::string> dirs() {
   auto paths = env::get(XDG_CONFIG_DIRS, "");
 
   if (paths.empty()) {
@@ -142,7 +143,7 @@ std::vector<std::string> dirs() {
 
 namespace cache {
 
-std::string home() {
+inline std::string home() {
   auto path = env::get(XDG_CACHE_HOME, "");
 
   if (!is_absolute_path(path)) {
@@ -156,9 +157,25 @@ std::string home() {
 }
 }  // namespace cache
 
+namespace state {
+
+inline std::string home() {
+  auto path = env::get(XDG_STATE_HOME, "");
+
+  if (!is_absolute_path(path)) {
+    path = env::get(HOME) + XDG_STATE_HOME_SUFFIX;
+  }
+
+  if (!is_absolute_path(path))
+    path = {};
+
+  return path;
+}
+}  // namespace state
+
 namespace runtime {
 
-std::string dir() {
+inline std::string dir() {
   auto path = env::get(XDG_RUNTIME_DIR, "");
 
   if (!is_absolute_path(path))
@@ -0,0 +1,184 @@
+// Unit tests of the signal processing of the ADC views: the vector kernels of
+// the statistics against scalar sums, and the FFT against a direct DFT.
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "dsp/fft.hpp"
+#include "dsp/stats.hpp"
+
+namespace {
+
+const double Pi = 3.14159265358979323846;
+
+std::vector<int32_t> RandomSamples(size_t count, int32_t low, int32_t high) {
+  std::mt19937 generator(count);
+  std::uniform_int_distribution<int32_t> distribution(low, high);
+  std::vector<int32_t> samples(count);
+  for (auto& sample : samples)
+    sample = distribution(generator);
+  return samples;
+}
+
+void ExpectReduce(const std::vector<int32_t>& samples) {
+  dsp::Moments expected = {samples[0], samples[0], 0, 0};
+  for (int32_t sample : samples) {
+    expected.min = std::min(expected.min, sample);
+    expected.max = std::max(expected.max, sample);
+    expected.sum += sample;
+    expected.sum_squares += int64_t(sample) * sample;
+  }
+  dsp::Moments moments = dsp::Reduce(samples.data(), samples.size());
+  EXPECT_EQ(moments.min, expected.min) << samples.size();
+  EXPECT_EQ(moments.max, expected.max) << samples.size();
+  EXPECT_EQ(moments.sum, expected.sum) << samples.size();
+  EXPECT_EQ(moments.sum_squares, expected.sum_squares) << samples.size();
+}
+
+// Every size up to a few vectors, for the tails, then blocks of the UI.
+TEST(Reduce, EverySize) {
+  SCOPED_TRACE(dsp::ReduceKernel());
+  for (size_t size = 1; size <= 100; ++size) {
+    ExpectReduce(RandomSamples(size, 0, 4095));
+    ExpectReduce(RandomSamples(size, -32768, 32767));
+    ExpectReduce(RandomSamples(size, 0, 65535));
+  }
+  for (size_t size : {1023, 1024, 1025, 16384, 100003})
+    ExpectReduce(RandomSamples(size, 0, 65535));
+}
+
+// The extremes at the first and last lanes, and past the vectors.
+TEST(Reduce, Extremes) {
+  for (size_t size = 1; size <= 40; ++size) {
+    for (size_t at = 0; at < size; ++at) {
+      std::vector<int32_t> samples(size, 100);
+      samples[at] = -32768;
+      samples[size - 1 - at] = 65535;
+      ExpectReduce(samples);
+    }
+  }
+}
+
+TEST(Stats, Blocks) {
+  auto samples = RandomSamples(10000, 0, 4095);
+  dsp::Stats stats(4095, 64);
+  // Blocks of uneven sizes, as the batches of a stream.
+  size_t offset = 0;
+  for (size_t size = 1; offset < samples.size(); ++size) {
+    size = std::min(size, samples.size() - offset);
+    stats.Add(samples.data() + offset, size);
+    offset += size;
+  }
+
+  double sum = 0, sum_squares = 0;
+  std::vector<uint64_t> histogram(64);
+  for (int32_t sample : samples) {
+    sum += sample;
+    sum_squares += double(sample) * sample;
+    histogram[sample / 64]++;
+  }
+  double mean = sum / samples.size();
+  EXPECT_EQ(stats.count(), samples.size());
+  EXPECT_EQ(stats.min(), *std::min_element(samples.begin(), samples.end()));
+  EXPECT_EQ(stats.max(), *std::max_element(samples.begin(), samples.end()));
+  EXPECT_DOUBLE_EQ(stats.mean(), mean);
+  EXPECT_DOUBLE_EQ(stats.rms(), std::sqrt(sum_squares / samples.size()));
+  EXPECT_NEAR(stats.stddev(),
+              std::sqrt(sum_squares / samples.size() - mean * mean), 1e-9);
+  EXPECT_EQ(stats.bin_width(), 64);
+  EXPECT_EQ(stats.histogram(), histogram);
+
+  stats.Reset();
+  EXPECT_EQ(stats.count(), 0u);
+  EXPECT_EQ(stats.mean(), 0);
+}
+
+TEST(Stats, OutOfRange) {
+  dsp::Stats stats(4095, 16);
+  std::vector<int32_t> samples = {-5, 0, 4095, 5000};
+  stats.Add(samples.data(), samples.size());
+  EXPECT_EQ(stats.min(), -5);
+  EXPECT_EQ(stats.max(), 5000);
+  EXPECT_EQ(stats.histogram().front(), 2u);
+  EXPECT_EQ(stats.histogram().back(), 2u);
+}
+
+// The FFT of |samples| against the DFT of the bins at a stride, the largest
+// error relative to the largest bin.
+double FftError(const std::vector<float>& samples, size_t stride) {
+  size_t n = samples.size();
+  dsp::Fft fft(n);
+  std::vector<float> real(n / 2 + 1), imaginary(n / 2 + 1), work;
+  fft.Forward(samples.data(), real.data(), imaginary.data(), &work);
+
+  double largest = 0, error = 0;
+  for (size_t k = 0; k <= n / 2; k += stride) {
+    double expected_real = 0, expected_imaginary = 0;
+    for (size_t i = 0; i < n; ++i) {
+      // The angle modulo 2 pi, exact for the large sizes.
+      double angle = -2 * Pi * double((k * i) % n) / n;
+      expected_real += samples[i] * std::cos(angle);
+      expected_imaginary += samples[i] * std::sin(angle);
+    }
+    largest = std::max(largest, std::hypot(expected_real, expected_imaginary));
+    error = std::max(error, std::hypot(real[k] - expected_real,
+                                       imaginary[k] - expected_imaginary));
+  }
+  return error / largest;
+}
+
+TEST(Fft, Dft) {
+  SCOPED_TRACE(dsp::FftKernel());
+  std::mt19937 generator(1);
+  std::uniform_real_distribution<float> distribution(-1, 1);
+  for (size_t n = 4; n <= 16384; n *= 2) {
+    std::vector<float> samples(n);
+    for (auto& sample : samples)
+      sample = distribution(generator);
+    // Every bin up to 1024, then about 200 of them.
+    size_t stride = n <= 1024 ? 1 : n / 2 / 200;
+    EXPECT_LT(FftError(samples, stride), 1e-4) << n;
+  }
+}
+
+std::vector<float> Sine(size_t n,
+                        double bin,
+                        double amplitude,
+                        double harmonic = 0) {
+  std::vector<float> samples(n);
+  for (size_t i = 0; i < n; ++i) {
+    double phase = 2 * Pi * bin * i / n;
+    samples[i] = 2048 + amplitude * std::sin(phase) +
+                 harmonic * amplitude * std::sin(2 * phase);
+  }
+  return samples;
+}
+
+TEST(Spectrum, Sine) {
+  for (dsp::Window window : {dsp::Window::Hann, dsp::Window::Blackman}) {
+    dsp::Spectrum spectrum(4096, window);
+    spectrum.Compute(Sine(4096, 100, 1000).data());
+    // The mean is removed.
+    EXPECT_LT(spectrum.amplitudes()[0], 1e-2);
+    EXPECT_NEAR(spectrum.amplitudes()[100], 1000, 1);
+    EXPECT_NEAR(spectrum.Peak(), 100, 1e-3);
+    EXPECT_LT(spectrum.Thd(spectrum.Peak()), 1e-4);
+  }
+}
+
+TEST(Spectrum, Interpolated) {
+  dsp::Spectrum spectrum(16384, dsp::Window::Hann);
+  spectrum.Compute(Sine(16384, 1000.3, 1000).data());
+  EXPECT_NEAR(spectrum.Peak(), 1000.3, 0.05);
+}
+
+TEST(Spectrum, Thd) {
+  dsp::Spectrum spectrum(16384, dsp::Window::Blackman);
+  spectrum.Compute(Sine(16384, 500, 1000, 0.01).data());
+  EXPECT_NEAR(spectrum.Thd(spectrum.Peak()), 0.01, 1e-4);
+}
+
+}  // namespace
@@ -0,0 +1,293 @@
+// Unit tests of the parsers of the kernel interfaces, the patterns and the
+// board profiles:
+//
+//   cmake -DBEAGLE_CONFIG_TESTS=ON .. && make bb-config-tests && ctest
+
+#include <gtest/gtest.h>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "hw/gpio.hpp"
+#include "hw/gpio_pattern.hpp"
+#include "hw/iio.hpp"
+#include "hw/pwm.hpp"
+#include "profile/value.hpp"
+
+namespace {
+
+std::string ReadFile(const std::string& path) {
+  std::ifstream file(std::string(BEAGLE_CONFIG_SOURCE_DIR) + "/" + path);
+  std::stringstream content;
+  content << file.rdbuf();
+  return content.str();
+}
+
+const std::map<int, int> ChipToBase = {{0, 0}, {1, 32}, {2, 64}, {3, 96}};
+
+TEST(ParseGpioinfo, Recorded) {
+  auto pins = hw::gpio::ParseGpioinfo(ReadFile("bench/data/gpioinfo.txt"),
+                                      ChipToBase);
+  ASSERT_EQ(pins.size(), 67u);
+  EXPECT_EQ(pins.front().number, 2);
+  EXPECT_EQ(pins.front().label, "P9_22 [gpio0_2]");
+  for (size_t i = 1; i < pins.size(); ++i)
+    EXPECT_LT(pins[i - 1].number, pins[i].number);
+
+  auto p8_12 = std::find_if(pins.begin(), pins.end(),
+                            [](const auto& pin) { return pin.number == 44; });
+  ASSERT_NE(p8_12, pins.end());
+  EXPECT_EQ(p8_12->label, "P8_12 [gpio1_12]");
+}
+
+TEST(ParseGpioinfo, Lines) {
+  std::string output =
+      "gpiochip1 - 32 lines:\n"
+      "\tline   3: \"P8_6\" unused input active-high\n"
+      "\tline   1: \"NC\" unused input active-high\n"
+      "\tline   2: unnamed \"P9_15\" input active-high\n"
+      "gpiochip5 - 32 lines:\n"
+      "\tline   0: \"P9_11\" unused input active-high\n"
+      "\tline   0: \"P9_11\" unused input active-high\n";
+  auto pins = hw::gpio::ParseGpioinfo(output, ChipToBase);
+  ASSERT_EQ(pins.size(), 3u);
+  EXPECT_EQ(pins[0].number, 34);
+  EXPECT_EQ(pins[0].label, "P9_15");
+  EXPECT_EQ(pins[1].number, 35);
+  EXPECT_EQ(pins[1].label, "P8_6");
+  // Chips missing from the map have 32 lines each.
+  EXPECT_EQ(pins[2].number, 160);
+  EXPECT_EQ(pins[2].label, "P9_11");
+}
+
+TEST(ParseGpioinfo, Empty) {
+  EXPECT_TRUE(hw::gpio::ParseGpioinfo("", ChipToBase).empty());
+  EXPECT_TRUE(
+      hw::gpio::ParseGpioinfo("\tline 1: \"P8_6\"\n", ChipToBase).empty());
+}
+
+TEST(ParseScanType, Valid) {
+  hw::iio::ScanType type;
+  ASSERT_TRUE(hw::iio::ParseScanType("le:u12/16>>0", &type));
+  EXPECT_FALSE(type.big_endian);
+  EXPECT_FALSE(type.is_signed);
+  EXPECT_EQ(type.bits, 12);
+  EXPECT_EQ(type.storage_bits, 16);
+  EXPECT_EQ(type.shift, 0);
+
+  ASSERT_TRUE(hw::iio::ParseScanType("be:s24/32>>8", &type));
+  EXPECT_TRUE(type.big_endian);
+  EXPECT_TRUE(type.is_signed);
+  EXPECT_EQ(type.bits, 24);
+  EXPECT_EQ(type.storage_bits, 32);
+  EXPECT_EQ(type.shift, 8);
+}
+
+TEST(ParseScanType, Invalid) {
+  hw::iio::ScanType type;
+  EXPECT_FALSE(hw::iio::ParseScanType("", &type));
+  EXPECT_FALSE(hw::iio::ParseScanType("le:u12/16", &type));
+  EXPECT_FALSE(hw::iio::ParseScanType("me:u12/16>>0", &type));
+  EXPECT_FALSE(hw::iio::ParseScanType("le:x12/16>>0", &type));
+  EXPECT_FALSE(hw::iio::ParseScanType("le:u12/12>>0", &type));
+  EXPECT_FALSE(hw::iio::ParseScanType("le:u0/16>>0", &type));
+  EXPECT_FALSE(hw::iio::ParseScanType("le:u12/16>>8", &type));
+}
+
+TEST(ParseTime, Units) {
+  long long ns = 0;
+  ASSERT_TRUE(hw::pwm::ParseTime("20000", &ns));
+  EXPECT_EQ(ns, 20000);
+  ASSERT_TRUE(hw::pwm::ParseTime("2.5us", &ns));
+  EXPECT_EQ(ns, 2500);
+  ASSERT_TRUE(hw::pwm::ParseTime("20ms", &ns));
+  EXPECT_EQ(ns, 20000000);
+  ASSERT_TRUE(hw::pwm::ParseTime("1s", &ns));
+  EXPECT_EQ(ns, 1000000000);
+  EXPECT_FALSE(hw::pwm::ParseTime("", &ns));
+  EXPECT_FALSE(hw::pwm::ParseTime("-1ms", &ns));
+  EXPECT_FALSE(hw::pwm::ParseTime("1min", &ns));
+}
+
+TEST(ParseDuty, Percentage) {
+  long long ns = 0;
+  ASSERT_TRUE(hw::pwm::ParseDuty("50%", 20000000, &ns));
+  EXPECT_EQ(ns, 10000000);
+  ASSERT_TRUE(hw::pwm::ParseDuty("0%", 20000000, &ns));
+  EXPECT_EQ(ns, 0);
+  ASSERT_TRUE(hw::pwm::ParseDuty("100%", 20000000, &ns));
+  EXPECT_EQ(ns, 20000000);
+  ASSERT_TRUE(hw::pwm::ParseDuty("12.5%", 1000, &ns));
+  EXPECT_EQ(ns, 125);
+}
+
+TEST(ParseDuty, Duration) {
+  long long ns = 0;
+  ASSERT_TRUE(hw::pwm::ParseDuty("250us", 1000000, &ns));
+  EXPECT_EQ(ns, 250000);
+}
+
+TEST(ParseDuty, Invalid) {
+  long long ns = 0;
+  for (const char* input : {"", "%", "abc%", "-10%", "100.5%", "nan%",
+                            "10 %", "10%%", "25ms%", "abc"}) {
+    EXPECT_FALSE(hw::pwm::ParseDuty(input, 1000000, &ns)) << input;
+  }
+}
+
+TEST(ParsePattern, Steps) {
+  std::vector<int> numbers;
+  std::vector<hw::gpio::Step> steps;
+  std::string error;
+  ASSERT_TRUE(hw::gpio::ParsePattern("60=1 48=0 10ms; 60=0 500us\n48=1 1s",
+                                     &numbers, &steps, &error))
+      << error;
+  EXPECT_EQ(numbers, (std::vector<int>{60, 48}));
+  ASSERT_EQ(steps.size(), 3u);
+  EXPECT_EQ(steps[0].mask, 0b11u);
+  EXPECT_EQ(steps[0].values, 0b01u);
+  EXPECT_EQ(steps[0].delay, std::chrono::milliseconds(10));
+  EXPECT_EQ(steps[1].mask, 0b01u);
+  EXPECT_EQ(steps[1].values, 0b00u);
+  EXPECT_EQ(steps[1].delay, std::chrono::microseconds(500));
+  EXPECT_EQ(steps[2].mask, 0b10u);
+  EXPECT_EQ(steps[2].values, 0b10u);
+  EXPECT_EQ(steps[2].delay, std::chrono::seconds(1));
+}
+
+TEST(ParsePattern, Errors) {
+  std::vector<int> numbers;
+  std::vector<hw::gpio::Step> steps;
+  std::string error;
+  EXPECT_FALSE(hw::gpio::ParsePattern("", &numbers, &steps, &error));
+  EXPECT_EQ(error, "Empty pattern");
+  EXPECT_FALSE(hw::gpio::ParsePattern("60=1", &numbers, &steps, &error));
+  EXPECT_EQ(error, "Missing delay: 60=1");
+  EXPECT_FALSE(hw::gpio::ParsePattern("60=2 1ms", &numbers, &steps, &error));
+  EXPECT_EQ(error, "Invalid value: 60=2");
+  EXPECT_FALSE(
+      hw::gpio::ParsePattern("60=1 1ms 2ms", &numbers, &steps, &error));
+  EXPECT_EQ(error, "Invalid delay: 2ms");
+  EXPECT_FALSE(hw::gpio::ParsePattern("60=1 1min", &numbers, &steps, &error));
+  EXPECT_EQ(error, "Invalid delay: 1min");
+}
+
+TEST(ParsePattern, TooManyLines) {
+  std::string pattern;
+  for (int i = 0; i < 65; ++i)
+    pattern += std::to_string(i) + "=1 ";
+  std::vector<int> numbers;
+  std::vector<hw::gpio::Step> steps;
+  std::string error;
+  EXPECT_FALSE(
+      hw::gpio::ParsePattern(pattern + "1ms", &numbers, &steps, &error));
+  EXPECT_EQ(error, "More than 64 lines");
+}
+
+TEST(ParseToml, Profile) {
+  std::string input =
+      "[pinmux]\n"
+      "P9_12 = \"gpio\"\n"
+      "\n"
+      "[gpio.P9_12]\n"
+      "direction = \"out\"   # A comment\n"
+      "value = 1\n"
+      "\n"
+      "[pwm.\"pwm-4:0\"]\n"
+      "period = \"1ms\"\n"
+      "duty = \"25%\"\n"
+      "enable = true\n"
+      "\n"
+      "[led]\n"
+      "usr0 = { trigger = \"timer\", delay_on = 100 }\n"
+      "usr1.brightness = 0.5\n"
+      "names = [\"usr2\", \"usr3\"]\n";
+  profile::Value root;
+  std::string error;
+  ASSERT_TRUE(profile::ParseToml(input, &root, &error)) << error;
+  ASSERT_TRUE(root.is_object());
+  ASSERT_EQ(root.object.size(), 4u);
+  EXPECT_EQ(root.object[0].first, "pinmux");
+  EXPECT_EQ(root.object[3].first, "led");
+
+  EXPECT_EQ(root["pinmux"]["P9_12"].ToString(), "gpio");
+  EXPECT_EQ(root["gpio"]["P9_12"]["direction"].ToString(), "out");
+  EXPECT_EQ(root["gpio"]["P9_12"]["value"].ToString(), "1");
+  const profile::Value& pwm = root["pwm"]["pwm-4:0"];
+  EXPECT_EQ(pwm.Find("period")->ToString(), "1ms");
+  EXPECT_EQ(pwm.Find("duty")->ToString(), "25%");
+  EXPECT_EQ(pwm.Find("enable")->type, profile::Value::Type::Bool);
+  EXPECT_EQ(pwm.Find("enable")->ToString(), "true");
+  EXPECT_EQ(pwm.Find("polarity"), nullptr);
+
+  profile::Value& led = root["led"];
+  EXPECT_EQ(led["usr0"]["trigger"].ToString(), "timer");
+  EXPECT_EQ(led["usr0"]["delay_on"].ToString(), "100");
+  EXPECT_EQ(led["usr1"]["brightness"].ToString(), "0.5");
+  ASSERT_EQ(led["names"].array.size(), 2u);
+  EXPECT_EQ(led["names"].array[1].ToString(), "usr3");
+}
+
+TEST(ParseToml, Errors) {
+  profile::Value root;
+  std::string error;
+  EXPECT_FALSE(profile::ParseToml("[gpio]\nvalue 1\n", &root, &error));
+  EXPECT_EQ(error, "line 2: expected '='");
+
+  error.clear();
+  EXPECT_FALSE(profile::ParseToml("a = 1\na = 2\n", &root, &error));
+  EXPECT_EQ(error, "line 2: duplicate key 'a'");
+
+  error.clear();
+  EXPECT_FALSE(profile::ParseToml("a = \"open\n", &root, &error));
+  EXPECT_EQ(error.rfind("line 1: ", 0), 0u) << error;
+}
+
+TEST(ParseJson, Profile) {
+  std::string input = R"({
+    "pinmux": {"P9_14": "pwm"},
+    "pwm": {
+      "pwm-4:0": {"period": "1ms", "duty": 25.5, "enable": false}
+    },
+    "list": [1, "two", null, {"three": 3}]
+  })";
+  profile::Value root;
+  std::string error;
+  ASSERT_TRUE(profile::ParseJson(input, &root, &error)) << error;
+  ASSERT_EQ(root.object.size(), 3u);
+  EXPECT_EQ(root["pinmux"]["P9_14"].ToString(), "pwm");
+  const profile::Value& pwm = root["pwm"]["pwm-4:0"];
+  EXPECT_EQ(pwm.Find("period")->ToString(), "1ms");
+  EXPECT_EQ(pwm.Find("duty")->number, 25.5);
+  EXPECT_EQ(pwm.Find("enable")->ToString(), "false");
+
+  const profile::Value& list = root["list"];
+  ASSERT_EQ(list.type, profile::Value::Type::Array);
+  ASSERT_EQ(list.array.size(), 4u);
+  EXPECT_EQ(list.array[1].ToString(), "two");
+  EXPECT_EQ(list.array[2].type, profile::Value::Type::Null);
+  EXPECT_EQ(list.array[3].Find("three")->ToString(), "3");
+}
+
+TEST(ParseJson, Errors) {
+  profile::Value root;
+  std::string error;
+  EXPECT_FALSE(profile::ParseJson("{\n  \"a\" 1\n}", &root, &error));
+  EXPECT_EQ(error, "line 2: expected ':'");
+
+  error.clear();
+  EXPECT_FALSE(profile::ParseJson("{\"a\": 1, \"a\": 2}", &root, &error));
+  EXPECT_EQ(error, "line 1: duplicate key 'a'");
+
+  error.clear();
+  EXPECT_FALSE(profile::ParseJson("[1, 2", &root, &error));
+  EXPECT_EQ(error, "line 1: expected ',' or ']'");
+
+  error.clear();
+  std::string deep(1000, '[');
+  EXPECT_FALSE(profile::ParseJson(deep, &root, &error));
+  EXPECT_EQ(error, "line 1: too deeply nested");
+}
+
+}  // namespace
@@ -0,0 +1,41 @@
+#!/bin/bash
+# Create a simulated GPIO chip with gpio-sim (CONFIG_GPIO_SIM), to run the GPIO
+# benchmark or the GPIO panel without any hardware:
+#
+#   sudo tools/gpio_sim.sh [lines]
+#   sudo bb-config gpio bench 1000 1000 --method=chardev
+#   sudo tools/gpio_sim.sh --remove
+#
+# The chip is labelled gpio-1000-<last line>, for bb-config to number its lines
+# from 1000 with the character devices. With sysfs, the kernel numbers them
+# from the base printed. An output reads back the value written, hence the
+# output is given as the input too.
+set -e
+
+configfs=/sys/kernel/config/gpio-sim
+device=$configfs/bb-config
+
+if [ "$1" = "--remove" ]; then
+  echo 0 > $device/live
+  rmdir $device/bank0 $device
+  exit 0
+fi
+
+lines="${1:-8}"
+label="gpio-1000-$((1000 + lines - 1))"
+
+modprobe gpio-sim
+mountpoint -q /sys/kernel/config || mount -t configfs none /sys/kernel/config
+mkdir -p $device/bank0
+echo "$lines" > $device/bank0/num_lines
+echo "$label" > $device/bank0/label
+echo 1 > $device/live
+
+echo "Character device: /dev/$(cat $device/bank0/chip_name), lines 1000 to" \
+  "$((1000 + lines - 1))"
+for chip in /sys/class/gpio/gpiochip*; do
+  if [ "$(cat "$chip/label" 2>/dev/null)" = "$label" ]; then
+    echo "sysfs: lines $(cat "$chip/base") to" \
+      "$(($(cat "$chip/base") + lines - 1))"
+  fi
+done
@@ -0,0 +1,150 @@
+#!/bin/bash
+# Generate a synthetic BeagleBone Black shaped sysfs/procfs tree, to run and
+# profile bb-config off-target:
+#
+#   tools/make_fixture.sh /tmp/bbb [gpio chips] [iio devices]
+#   bb-config --root=/tmp/bbb
+#
+# The defaults give 4 chips of 32 lines and 2 IIO devices; pass more to stress
+# the panels.
+#
+# The attributes are plain files: reading one returns what was last written.
+# Hence every GPIO line is already exported, and LED triggers lose the brackets
+# around the active one once written: the trigger then reads as the only one
+# listed.
+set -e
+
+if [ -z "$1" ]; then
+  echo "Usage: $0 <directory> [gpio chips] [iio devices]"
+  exit 1
+fi
+
+cd "$(dirname "$0")"
+pin_info="$(pwd)/../src/ui/panel/pinmux/pin_info"
+
+root="$1"
+chips="${2:-4}"
+iio_devices="${3:-2}"
+
+mkdir -p "$root"
+cd "$root"
+
+# Write the remaining arguments into the file $1.
+put() {
+  mkdir -p "$(dirname "$1")"
+  local file="$1"
+  shift
+  echo "$@" > "$file"
+}
+
+# Board model, NUL terminated as in the device tree.
+mkdir -p proc/device-tree
+printf 'TI AM335x BeagleBone Black\0' > proc/device-tree/model
+
+# GPIO chips and lines.
+put sys/class/gpio/export
+put sys/class/gpio/unexport
+for ((chip = 0; chip < chips; chip++)); do
+  base=$((chip * 32))
+  put sys/class/gpio/gpiochip$base/base $base
+  put sys/class/gpio/gpiochip$base/ngpio 32
+  put sys/class/gpio/gpiochip$base/label "gpio-$base-$((base + 31))"
+  for ((line = 0; line < 32; line++)); do
+    gpio=sys/class/gpio/gpio$((base + line))
+    put $gpio/direction in
+    put $gpio/value $((line % 2))
+    put $gpio/edge none
+    put $gpio/active_low 0
+  done
+done
+
+# Pinmux helpers, for every pin supporting modes in pin_info.
+grep '_PINMUX=' "$pin_info" | cut -d_ -f1,2 | while read -r pin; do
+  put "sys/devices/platform/ocp/ocp:${pin}_pinmux/state" default
+done
+
+# Analog inputs.
+for ((device = 0; device < iio_devices; device++)); do
+  iio="sys/bus/iio/devices/iio:device$device"
+  put $iio/name "TI-am335x-adc.0.auto"
+  for ((channel = 0; channel < 8; channel++)); do
+    put $iio/in_voltage${channel}_raw $(((channel * 509 + device * 97) % 4096))
+  done
+done
+
+# PWM chips with two channels each, also reachable as pwm-<chip>:<channel>.
+for chip in 0 2 4 6; do
+  put sys/class/pwm/pwmchip$chip/npwm 2
+  put sys/class/pwm/pwmchip$chip/export
+  put sys/class/pwm/pwmchip$chip/unexport
+  for channel in 0 1; do
+    pwm=sys/class/pwm/pwmchip$chip/pwm$channel
+    put $pwm/period 0
+    put $pwm/duty_cycle 0
+    put $pwm/polarity normal
+    put $pwm/enable 0
+    ln -sfn pwmchip$chip/pwm$channel sys/class/pwm/pwm-$chip:$channel
+  done
+done
+
+# User LEDs.
+triggers="none rc-feedback kbd-scrolllock kbd-numlock kbd-capslock timer"
+triggers="$triggers oneshot disk-activity ide-disk mtd nand-disk heartbeat"
+triggers="$triggers backlight gpio cpu cpu0 default-on panic mmc0 mmc1"
+for led in 0 1 2 3; do
+  dir="sys/class/leds/beaglebone:green:usr$led"
+  put $dir/brightness 0
+  put $dir/max_brightness 255
+  put $dir/delay_on 500
+  put $dir/delay_off 500
+  put $dir/trigger "${triggers/heartbeat/[heartbeat]}"
+done
+
+# PRUs.
+for ((pru = 0; pru < 3; pru++)); do
+  dir=sys/class/remoteproc/remoteproc$pru
+  put $dir/name "4a3$((pru + 3))4000.pru"
+  put $dir/firmware "am335x-pru$pru-fw"
+  put $dir/state offline
+done
+
+# Block devices.
+mkdir -p sys/block/mmcblk0 sys/block/mmcblk1 sys/block/loop0
+
+put etc/resolv.conf "nameserver 127.0.0.1"
+
+mkdir -p boot
+cat > boot/uEnv.txt << 'EOF'
+#Docs: http://elinux.org/Beagleboard:U-boot_partitioning_layout_2.0
+
+uname_r=5.10.168-ti-r71
+#uuid=
+#dtb=
+
+###U-Boot Overlays###
+###Documentation: http://elinux.org/Beagleboard:BeagleBoneBlack_Debian#U-Boot_Overlays
+###Master Enable
+enable_uboot_overlays=1
+###
+###Overide capes with eeprom
+#uboot_overlay_addr0=<file0>.dtbo
+#uboot_overlay_addr1=<file1>.dtbo
+###
+###Disable auto loading of virtual capes (emmc/video/wireless/adc)
+#disable_uboot_overlay_emmc=1
+#disable_uboot_overlay_video=1
+#disable_uboot_overlay_audio=1
+#disable_uboot_overlay_wireless=1
+#disable_uboot_overlay_adc=1
+###
+###PRUSS OPTIONS
+uboot_overlay_pru=AM335X-PRU-UIO-00A0.dtbo
+###
+###Cape Universal Enable
+enable_uboot_cape_universal=1
+###U-Boot Overlays###
+
+cmdline=coherent_pool=1M net.ifnames=0 lpj=1990656 rng_core.default_quality=100 quiet
+EOF
+
+echo "Generated $(find . -type f | wc -l) files in $root"